@@ -18,7 +18,9 @@
 
 #define TOTAL_MEMORY 10240  // Total memory in KB
 #define MAX_BLOCKS 100      // Maximum number of memory blocks
-#define MAX_PROCESS_ID 10   // Max characters in process ID
+
+#include "event_log.h"
+#include "process_table.h"
 
 // ============================================================================
 // MEMORY BLOCK STRUCTURE
@@ -26,7 +28,7 @@
 typedef struct {
     int size;                      // Size of block in KB
     int isFree;                    // 1 = free, 0 = allocated
-    char processId[MAX_PROCESS_ID]; // Process ID (empty if free)
+    ProcessHandle owner;           // Owner (NO_PROCESS if free)
 } MemoryBlock;
 
 // Global memory blocks array
@@ -44,16 +46,18 @@ void initializeMemory() {
     blockCount = 0;
     memory[blockCount].size = TOTAL_MEMORY;
     memory[blockCount].isFree = 1;
-    strcpy(memory[blockCount].processId, "");
+    memory[blockCount].owner = NO_PROCESS;
     blockCount++;
     
-    printf("✓ Memory initialized: %d KB free\n\n", TOTAL_MEMORY);
+    LOG_SUMMARY("✓ Memory initialized: %d KB free\n\n", TOTAL_MEMORY);
 }
 
 /**
  * Display the entire memory layout
  */
 void displayMemoryLayout() {
+    if (logLevel < LOG_SUMMARY) return;
+
     printf("\n========== MEMORY LAYOUT (BEST FIT) ==========\n");
     printf("%-8s %-15s %-12s %-15s\n", "Block#", "Size (KB)", "Status", "Process ID");
     printf("--------------------------------------------\n");
@@ -63,7 +67,7 @@ void displayMemoryLayout() {
                i + 1,
                memory[i].size,
                memory[i].isFree ? "FREE" : "ALLOCATED",
-               memory[i].isFree ? "---" : memory[i].processId);
+               processName(memory[i].owner));
     }
     printf("==========================================\n");
 }
@@ -72,6 +76,8 @@ void displayMemoryLayout() {
  * Display memory statistics
  */
 void displayStatistics() {
+    if (logLevel < LOG_SUMMARY) return;
+
     int usedMemory = 0;
     int freeMemory = 0;
     int activeProcesses = 0;
@@ -128,27 +134,38 @@ void displayStatistics() {
  * - Leaves larger blocks available for future allocations
  * - More memory-efficient than First Fit
  *
- * @return: 1 if successful, 0 if failed
+ * @return: handle of the process, or NO_PROCESS if failed
  */
-int allocateBestFit(char *processId, int requiredSize) {
+ProcessHandle allocateBestFit(const char *processId, int requiredSize) {
     // Validation: size must be positive and within total memory
     if (requiredSize <= 0 || requiredSize > TOTAL_MEMORY) {
-        printf("✗ Invalid size: %d KB\n", requiredSize);
-        return 0;
+        LOG_OP("✗ Invalid size: %d KB\n", requiredSize);
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_BEST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
+    }
+
+    // Name → handle once; everything below compares integers
+    ProcessHandle process = internProcess(processId);
+    if (process == NO_PROCESS) {
+        LOG_OP("✗ Process table full\n");
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_BEST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
     }
 
     // Check if process already exists
     for (int i = 0; i < blockCount; i++) {
-        if (!memory[i].isFree && strcmp(memory[i].processId, processId) == 0) {
-            printf("✗ Process %s already allocated\n", processId);
-            return 0;
+        if (!memory[i].isFree && memory[i].owner == process) {
+            LOG_OP("✗ Process %s already allocated\n", processId);
+            logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_BEST_FIT, processId, requiredSize, -1);
+            return NO_PROCESS;
         }
     }
 
     // Check array bounds
     if (blockCount >= MAX_BLOCKS - 1) {
-        printf("✗ Memory block limit reached\n");
-        return 0;
+        LOG_OP("✗ Memory block limit reached\n");
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_BEST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
     }
 
     // BEST FIT: Scan ALL blocks to find the SMALLEST suitable block
@@ -168,14 +185,15 @@ int allocateBestFit(char *processId, int requiredSize) {
 
     // Check if suitable block was found
     if (bestIndex == -1) {
-        printf("✗ [Best Fit] Cannot allocate %d KB to %s (no suitable block found)\n\n",
+        LOG_OP("✗ [Best Fit] Cannot allocate %d KB to %s (no suitable block found)\n\n",
                requiredSize, processId);
-        return 0;
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_BEST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
     }
 
-    printf("  [Best Fit] Found best-fit block %d (size %d KB) at position %d\n",
+    LOG_OP("  [Best Fit] Found best-fit block %d (size %d KB) at position %d\n",
            bestIndex + 1, memory[bestIndex].size, bestIndex);
-    printf("  This is the SMALLEST block that can fit the process\n");
+    LOG_OP("  This is the SMALLEST block that can fit the process\n");
 
     // Allocate to best fit block
     if (memory[bestIndex].size > requiredSize) {
@@ -190,39 +208,44 @@ int allocateBestFit(char *processId, int requiredSize) {
         // Set allocated block
         memory[bestIndex].size = requiredSize;
         memory[bestIndex].isFree = 0;
-        strcpy(memory[bestIndex].processId, processId);
+        memory[bestIndex].owner = process;
 
         // Set leftover free block
         memory[bestIndex + 1].size = leftoverSize;
         memory[bestIndex + 1].isFree = 1;
-        strcpy(memory[bestIndex + 1].processId, "");
+        memory[bestIndex + 1].owner = NO_PROCESS;
 
         blockCount++;
     } 
     // Exact fit: no split needed
     else {
         memory[bestIndex].isFree = 0;
-        strcpy(memory[bestIndex].processId, processId);
+        memory[bestIndex].owner = process;
     }
 
-    printf("✓ [Best Fit] Allocated %d KB to %s\n\n", requiredSize, processId);
-    return 1;
+    LOG_OP("✓ [Best Fit] Allocated %d KB to %s\n\n", requiredSize, processId);
+
+    logEvent(EVENT_ALLOCATE, STRATEGY_BEST_FIT, processId, requiredSize, bestIndex);
+    return process;
 }
 
 /**
- * Deallocate memory from a process
+ * Deallocate memory from a process (handle returned by the allocate call)
+ * @return: 1 if successful, 0 if failed
  */
-int deallocateMemory(char *processId) {
+int deallocateMemory(ProcessHandle process) {
     for (int i = 0; i < blockCount; i++) {
-        if (!memory[i].isFree && strcmp(memory[i].processId, processId) == 0) {
+        if (!memory[i].isFree && memory[i].owner == process) {
             memory[i].isFree = 1;
-            strcpy(memory[i].processId, "");
-            printf("✓ Deallocated process %s\n", processId);
+            memory[i].owner = NO_PROCESS;
+            LOG_OP("✓ Deallocated process %s\n", processName(process));
+            logEvent(EVENT_DEALLOCATE, STRATEGY_NONE, processName(process), memory[i].size, i);
             return 1;
         }
     }
 
-    printf("✗ Process %s not found\n", processId);
+    LOG_OP("✗ Process %s not found\n", processName(process));
+    logEvent(EVENT_DEALLOCATE_FAILED, STRATEGY_NONE, processName(process), 0, -1);
     return 0;
 }
 
@@ -231,6 +254,7 @@ int deallocateMemory(char *processId) {
  */
 void coalesceMemory() {
     int i = 0;
+    int merges = 0;
     while (i < blockCount - 1) {
         if (memory[i].isFree && memory[i + 1].isFree) {
             // Merge adjacent free blocks
@@ -241,28 +265,35 @@ void coalesceMemory() {
                 memory[j] = memory[j + 1];
             }
             blockCount--;
+            merges++;
             // Don't increment i, continue checking for more merges
         } else {
             i++;
         }
     }
+
+    logEvent(EVENT_COALESCE, STRATEGY_NONE, "", merges, blockCount);
 }
 
 // ============================================================================
 // MAIN - DEMONSTRATION OF BEST FIT
 // ============================================================================
 
-int main() {
-    printf("\n");
-    printf("╔═══════════════════════════════════════════════════════════╗\n");
-    printf("║   BEST FIT MEMORY ALLOCATION - C Implementation           ║\n");
-    printf("║              Total Memory: 10240 KB                       ║\n");
-    printf("╚═══════════════════════════════════════════════════════════╝\n\n");
+int main(int argc, char *argv[]) {
+    if (!parseLogOptions(argc, argv)) {
+        return 1;
+    }
+
+    LOG_SUMMARY("\n");
+    LOG_SUMMARY("╔═══════════════════════════════════════════════════════════╗\n");
+    LOG_SUMMARY("║   BEST FIT MEMORY ALLOCATION - C Implementation           ║\n");
+    LOG_SUMMARY("║              Total Memory: 10240 KB                       ║\n");
+    LOG_SUMMARY("╚═══════════════════════════════════════════════════════════╝\n\n");
 
     initializeMemory();
 
     // ========== SCENARIO 1: Basic Allocation ==========
-    printf("--- SCENARIO 1: Basic Allocation with Best Fit ---\n");
+    LOG_SUMMARY("--- SCENARIO 1: Basic Allocation with Best Fit ---\n");
     allocateBestFit("P1", 200);
     allocateBestFit("P2", 150);
     allocateBestFit("P3", 100);
@@ -270,52 +301,54 @@ int main() {
     displayStatistics();
 
     // ========== SCENARIO 2: Show Best Fit advantage ==========
-    printf("\n--- SCENARIO 2: Best Fit vs First Fit Comparison ---\n");
+    LOG_SUMMARY("\n--- SCENARIO 2: Best Fit vs First Fit Comparison ---\n");
     initializeMemory();
-    printf("Allocating with specific sizes to show Best Fit advantage:\n");
-    allocateBestFit("Q1", 500);  // [500] [9740]
-    allocateBestFit("Q2", 400);  // [500] [400] [9340]
-    allocateBestFit("Q3", 300);  // [500] [400] [300] [9040]
-    printf("\nNow deallocate Q2 (400 KB free block):\n");
-    deallocateMemory("Q2");
+    LOG_SUMMARY("Allocating with specific sizes to show Best Fit advantage:\n");
+    ProcessHandle q1 = allocateBestFit("Q1", 500);  // [500] [9740]
+    ProcessHandle q2 = allocateBestFit("Q2", 400);  // [500] [400] [9340]
+    ProcessHandle q3 = allocateBestFit("Q3", 300);  // [500] [400] [300] [9040]
+    LOG_SUMMARY("\nNow deallocate Q2 (400 KB free block):\n");
+    deallocateMemory(q2);
     displayMemoryLayout();
-    printf("\nTrying to allocate Q4 (350 KB):\n");
-    printf("Best Fit chooses the 400 KB block (smallest that fits)\n");
+    LOG_SUMMARY("\nTrying to allocate Q4 (350 KB):\n");
+    LOG_SUMMARY("Best Fit chooses the 400 KB block (smallest that fits)\n");
     allocateBestFit("Q4", 350);
     displayMemoryLayout();
     displayStatistics();
 
     // ========== SCENARIO 3: Deallocation ==========
-    printf("\n--- SCENARIO 3: Deallocation Pattern ---\n");
-    deallocateMemory("Q1");
-    deallocateMemory("Q3");
+    LOG_SUMMARY("\n--- SCENARIO 3: Deallocation Pattern ---\n");
+    deallocateMemory(q1);
+    deallocateMemory(q3);
     coalesceMemory();
-    printf("(After deallocating Q1, Q3 and coalescing)\n");
+    LOG_SUMMARY("(After deallocating Q1, Q3 and coalescing)\n");
     displayMemoryLayout();
     displayStatistics();
 
     // ========== SCENARIO 4: Complex fragmentation ==========
-    printf("\n--- SCENARIO 4: Complex Memory Scenario ---\n");
+    LOG_SUMMARY("\n--- SCENARIO 4: Complex Memory Scenario ---\n");
     initializeMemory();
-    printf("Allocating multiple processes:\n");
+    LOG_SUMMARY("Allocating multiple processes:\n");
     allocateBestFit("R1", 1000);
-    allocateBestFit("R2", 800);
-    allocateBestFit("R3", 1200);
+    ProcessHandle r2 = allocateBestFit("R2", 800);
+    ProcessHandle r3 = allocateBestFit("R3", 1200);
     allocateBestFit("R4", 600);
     allocateBestFit("R5", 1500);
     displayMemoryLayout();
     displayStatistics();
 
-    printf("\nDeallocating R3 and R2:\n");
-    deallocateMemory("R3");
-    deallocateMemory("R2");
+    LOG_SUMMARY("\nDeallocating R3 and R2:\n");
+    deallocateMemory(r3);
+    deallocateMemory(r2);
     coalesceMemory();
     displayMemoryLayout();
     displayStatistics();
 
-    printf("\n╔═══════════════════════════════════════════════════════════╗\n");
-    printf("║               Best Fit Simulation Complete                ║\n");
-    printf("╚═══════════════════════════════════════════════════════════╝\n\n");
+    LOG_SUMMARY("\n╔═══════════════════════════════════════════════════════════╗\n");
+    LOG_SUMMARY("║               Best Fit Simulation Complete                ║\n");
+    LOG_SUMMARY("╚═══════════════════════════════════════════════════════════╝\n\n");
 
+    displayEventSummary();
+    eventLogClose();
     return 0;
 }
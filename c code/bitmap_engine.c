@@ -0,0 +1,384 @@
+// ============================================================================
+// BITMAP ENGINE - Fixed-Granularity Page Allocator (see bitmap_engine.h)
+// ============================================================================
+// Level 0: bits[]       one bit per unit, 1 = allocated, bit i of word w is
+//                       unit w * 64 + i (low bits = low addresses)
+// Level 1: fullWords[]  one bit per bits[] word, 1 = all 64 units allocated
+// Level 2: fullTop[]    one bit per fullWords[] word, 1 = all 4096 units
+//                       behind it allocated
+// Units past the end of the heap are permanently allocated padding.
+//
+// No libc calls: this file must build with -nostdlib for WebAssembly.
+// ============================================================================
+
+#include <stdint.h>
+#include "bitmap_engine.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#define BITMAP_WORDS (BITMAP_MAX_UNITS / 64)
+#define SUMMARY_WORDS (BITMAP_WORDS / 64)
+#define TOP_WORDS ((SUMMARY_WORDS + 63) / 64)
+#define ALL_ONES (~(uint64_t)0)
+
+static uint64_t bits[BITMAP_WORDS] __attribute__((aligned(32)));
+static uint64_t fullWords[SUMMARY_WORDS];
+static uint64_t fullTop[TOP_WORDS];
+
+static uint64_t unitSize = 0;   // Bytes per unit
+static int unitCount = 0;
+static int wordCount = 0;
+static int allocatedUnits = 0;  // Excluding padding
+
+#if ENGINE_COUNTERS
+static BitmapCounters counters;
+#define COUNT(field, n) (counters.field += (uint64_t)(n))
+#else
+#define COUNT(field, n) ((void)0)
+#endif
+
+// ============================================================================
+// SUMMARY MAINTENANCE
+// ============================================================================
+
+/**
+ * Refresh the level 1 and level 2 bits of word w after it changed
+ */
+static void updateSummary(int w) {
+    int s = w >> 6;
+    uint64_t bit = (uint64_t)1 << (w & 63);
+    uint64_t before = fullWords[s];
+    fullWords[s] = bits[w] == ALL_ONES ? (fullWords[s] | bit) : (fullWords[s] & ~bit);
+    if (fullWords[s] == before) {
+        return;  // Level 2 depends only on fullWords[s]
+    }
+    COUNT(summaryUpdates, 1);
+
+    uint64_t topBit = (uint64_t)1 << (s & 63);
+    fullTop[s >> 6] = fullWords[s] == ALL_ONES ? (fullTop[s >> 6] | topBit)
+                                               : (fullTop[s >> 6] & ~topBit);
+}
+
+/**
+ * First word at or after w that has at least one free unit
+ * @return: word index, or wordCount if none
+ */
+static int nextOpenWord(int w) {
+    while (w < wordCount) {
+        int s = w >> 6;
+        uint64_t open = ~fullWords[s] & (ALL_ONES << (w & 63));
+        if (open) {
+            w = (s << 6) + __builtin_ctzll(open);
+            return w < wordCount ? w : wordCount;
+        }
+
+        // Rest of this summary word is full: find the next one that isn't
+        for (s++;;) {
+            int t = s >> 6;
+            if (t >= TOP_WORDS) {
+                return wordCount;
+            }
+            uint64_t openTop = ~fullTop[t] & (ALL_ONES << (s & 63));
+            if (openTop) {
+                s = (t << 6) + __builtin_ctzll(openTop);
+                break;
+            }
+            s = (t + 1) << 6;
+        }
+        w = s << 6;
+    }
+    return wordCount;
+}
+
+// ============================================================================
+// WORD KERNELS
+// ============================================================================
+
+/**
+ * Number of consecutive all-free words starting at w (stops at limit)
+ */
+static int countEmptyWords(int w, int limit) {
+    int start = w;
+
+#if defined(__AVX2__)
+    // Scalar up to a 32-byte boundary, then four words per test
+    while (w < limit && (w & 3) != 0 && bits[w] == 0) {
+        w++;
+    }
+    if ((w & 3) == 0) {
+        for (; w + 4 <= limit; w += 4) {
+            __m256i v = _mm256_load_si256((const __m256i *)&bits[w]);
+            if (!_mm256_testz_si256(v, v)) {
+                break;
+            }
+        }
+    }
+#endif
+
+    while (w < limit && bits[w] == 0) {
+        w++;
+    }
+    return w - start;
+}
+
+/**
+ * Lowest bit position where `units` free units (1..63) start inside word
+ * (runs that would cross into the next word are not considered)
+ * @return: bit position, or -1 if none
+ */
+static int findRunInWord(uint64_t word, int units) {
+    uint64_t run = ~word;  // bit i set: unit i is free
+    for (int length = 1; length < units && run; ) {
+        int shift = length < units - length ? length : units - length;
+        run &= run >> shift;  // bit i set: units i .. i+length+shift-1 free
+        length += shift;
+    }
+    return run ? __builtin_ctzll(run) : -1;
+}
+
+/**
+ * Set (value = 1) or clear (value = 0) units [start, start + count)
+ */
+static void setRange(int start, int count, int value) {
+    int end = start + count;
+
+    while (start < end) {
+        int w = start >> 6;
+        int from = start & 63;
+        int to = (end - (w << 6)) < 64 ? end - (w << 6) : 64;
+        uint64_t mask = (to - from == 64) ? ALL_ONES
+                                          : (((uint64_t)1 << (to - from)) - 1) << from;
+
+        bits[w] = value ? (bits[w] | mask) : (bits[w] & ~mask);
+        updateSummary(w);
+        start = (w << 6) + to;
+    }
+
+    allocatedUnits += value ? count : -count;
+}
+
+/**
+ * Whether every unit in [start, start + count) is allocated
+ */
+static int rangeAllocated(int start, int count) {
+    int end = start + count;
+
+    while (start < end) {
+        int w = start >> 6;
+        int from = start & 63;
+        int to = (end - (w << 6)) < 64 ? end - (w << 6) : 64;
+        uint64_t mask = (to - from == 64) ? ALL_ONES
+                                          : (((uint64_t)1 << (to - from)) - 1) << from;
+
+        if ((bits[w] & mask) != mask) {
+            return 0;
+        }
+        start = (w << 6) + to;
+    }
+    return 1;
+}
+
+// ============================================================================
+// SETUP
+// ============================================================================
+
+/**
+ * Initialize an all-free heap of totalMemory bytes in units of unitSize
+ * bytes (a remainder smaller than one unit is not used)
+ * @return: 1 if successful, 0 if the sizes are invalid or too many units
+ */
+int bitmapInit(uint64_t totalMemory, uint64_t size) {
+    if (size == 0 || totalMemory < size || totalMemory / size > BITMAP_MAX_UNITS) {
+        return 0;
+    }
+
+    unitSize = size;
+    unitCount = (int)(totalMemory / size);
+    wordCount = (unitCount + 63) / 64;
+    allocatedUnits = 0;
+
+    for (int w = 0; w < BITMAP_WORDS; w++) {
+        bits[w] = w < wordCount ? 0 : ALL_ONES;
+    }
+    if (unitCount % 64 != 0) {
+        bits[wordCount - 1] = ALL_ONES << (unitCount % 64);  // Padding
+    }
+
+    for (int s = 0; s < SUMMARY_WORDS; s++) {
+        fullWords[s] = 0;
+    }
+    for (int t = 0; t < TOP_WORDS; t++) {
+        fullTop[t] = 0;
+    }
+    for (int w = 0; w < BITMAP_WORDS; w++) {
+        updateSummary(w);
+    }
+    bitmapResetCounters();
+    return 1;
+}
+
+uint64_t bitmapUnitSize(void) { return unitSize; }
+int bitmapUnitCount(void) { return unitCount; }
+uint64_t bitmapUnitStart(int unit) { return (uint64_t)unit * unitSize; }
+
+// ============================================================================
+// ALLOCATION / DEALLOCATION
+// ============================================================================
+
+/**
+ * Units needed for size bytes (internal fragmentation is the rounding)
+ * @return: unit count, or 0 if size is 0 or larger than the heap
+ */
+int bitmapUnitsFor(uint64_t size) {
+    if (size == 0 || unitSize == 0) {
+        return 0;
+    }
+    uint64_t units = (size - 1) / unitSize + 1;
+    return units > (uint64_t)unitCount ? 0 : (int)units;
+}
+
+/**
+ * Find the lowest run of `units` free units, without allocating it
+ * @return: first unit of the run, or -1 if no run is long enough
+ */
+int bitmapFindRun(int units) {
+    COUNT(searches, 1);
+    if (units <= 0 || units > unitCount - allocatedUnits) {
+        return -1;
+    }
+
+    int runStart = 0;
+    int runLength = 0;  // Free units ending at the current word boundary
+    int w = nextOpenWord(0);
+
+    while (w < wordCount) {
+        uint64_t word = bits[w];
+        int base = w << 6;
+
+        if (word == 0) {
+            if (runLength == 0) {
+                runStart = base;
+            }
+            int needed = (units - runLength + 63) / 64;
+            int limit = w + needed < wordCount ? w + needed : wordCount;
+            int empty = countEmptyWords(w, limit);
+            COUNT(wordsInspected, empty);
+            runLength += empty * 64;
+            if (runLength >= units) {
+                return runStart;
+            }
+            w += empty;
+            continue;
+        }
+
+        // Free units at the bottom of the word extend the current run
+        COUNT(wordsInspected, 1);
+        int low = __builtin_ctzll(word);
+        if (runLength + low >= units) {
+            return runLength > 0 ? runStart : base;
+        }
+
+        if (units < 64) {
+            int at = findRunInWord(word, units);
+            if (at >= 0) {
+                return base + at;
+            }
+        }
+
+        // Free units at the top of the word start a new run
+        int high = __builtin_clzll(word);
+        runLength = high;
+        runStart = base + 64 - high;
+        w = high > 0 ? w + 1 : nextOpenWord(w + 1);
+    }
+    return -1;
+}
+
+/**
+ * Allocate size bytes (rounded up to whole units) at the lowest fitting run
+ * @return: first unit of the allocation, or -1 if failed
+ */
+int bitmapAllocate(uint64_t size) {
+    int units = bitmapUnitsFor(size);
+    int start = bitmapFindRun(units);
+    if (start == -1) {
+        COUNT(failedAllocations, 1);
+        return -1;
+    }
+    setRange(start, units, 1);
+    COUNT(allocations, 1);
+    return start;
+}
+
+/**
+ * Free an allocation made by bitmapAllocate(size)
+ * @return: 1 if successful, 0 if the range is invalid or not fully allocated
+ */
+int bitmapFree(int startUnit, uint64_t size) {
+    int units = bitmapUnitsFor(size);
+    if (startUnit < 0 || units <= 0 || startUnit > unitCount - units ||
+        !rangeAllocated(startUnit, units)) {
+        return 0;
+    }
+    setRange(startUnit, units, 0);
+    COUNT(frees, 1);
+    return 1;
+}
+
+int bitmapIsAllocated(int unit) {
+    return unit >= 0 && unit < unitCount && ((bits[unit >> 6] >> (unit & 63)) & 1);
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+int bitmapFreeUnits(void) { return unitCount - allocatedUnits; }
+
+/**
+ * Copy the hot-path counters (all zero when built with ENGINE_COUNTERS=0)
+ */
+void bitmapReadCounters(BitmapCounters *out) {
+#if ENGINE_COUNTERS
+    *out = counters;
+#else
+    *out = (BitmapCounters){ 0 };
+#endif
+}
+
+void bitmapResetCounters(void) {
+#if ENGINE_COUNTERS
+    counters = (BitmapCounters){ 0 };
+#endif
+}
+
+/**
+ * Longest run of free units (external fragmentation = free - largest)
+ */
+int bitmapLargestFreeRun(void) {
+    int largest = 0;
+    int run = 0;
+
+    for (int w = 0; w < wordCount; w++) {
+        uint64_t word = bits[w];
+        if (word == 0) {
+            run += 64;
+            continue;
+        }
+
+        int edge = run + __builtin_ctzll(word);
+        if (edge > largest) largest = edge;
+
+        // Longest run inside the word: AND with itself shifted until empty
+        int inner = 0;
+        for (uint64_t free = ~word; free; free &= free >> 1) {
+            inner++;
+        }
+        if (inner > largest) largest = inner;
+
+        run = __builtin_clzll(word);
+    }
+    return run > largest ? run : largest;
+}
@@ -0,0 +1,76 @@
+// ============================================================================
+// BITMAP ENGINE - Fixed-Granularity Page Allocator
+// ============================================================================
+// Memory is a bitmap of fixed-size units (e.g. 4 KB pages), one bit per
+// unit (1 = allocated), instead of a list of variable-size blocks. This is
+// how page and slab allocators track memory. A request takes the lowest run
+// of free units that is long enough (first fit by address).
+//
+// Searches work a 64-bit word at a time:
+//   - runs inside a word are found with shift-and + ctz, runs across words
+//     with ctz/clz of the boundary words;
+//   - a two-level summary bitmap (one bit per full word, one bit per full
+//     summary word) skips allocated stretches 4096 units at a time;
+//   - long runs advance over empty words four at a time with AVX2 when the
+//     compiler targets it (-mavx2, -march=native).
+// Search cost depends on where the first fitting run is, not on how many
+// holes the heap has.
+//
+// Like mm_engine.c there is no I/O and no libc dependency:
+//   gcc -O2 -march=native tool.c bitmap_engine.c
+// ============================================================================
+
+#ifndef BITMAP_ENGINE_H
+#define BITMAP_ENGINE_H
+
+#include <stdint.h>
+
+#ifndef BITMAP_MAX_UNITS
+#define BITMAP_MAX_UNITS (1 << 20)  // 1M units: 4 GB of 4 KB pages, 1 TB of 1 MB units
+                                    // (-D to override; a multiple of 4096)
+#endif
+#ifndef ENGINE_COUNTERS
+#define ENGINE_COUNTERS 1           // Hot-path counters (-DENGINE_COUNTERS=0 compiles them out)
+#endif
+
+// ============================================================================
+// SETUP
+// ============================================================================
+int bitmapInit(uint64_t totalMemory, uint64_t unitSize);  // sizes in bytes
+uint64_t bitmapUnitSize(void);
+int bitmapUnitCount(void);
+uint64_t bitmapUnitStart(int unit);                       // byte address
+
+// ============================================================================
+// ALLOCATION / DEALLOCATION
+// ============================================================================
+int bitmapUnitsFor(uint64_t size);              // bytes → units (rounded up)
+int bitmapFindRun(int units);
+int bitmapAllocate(uint64_t size);
+int bitmapFree(int startUnit, uint64_t size);
+int bitmapIsAllocated(int unit);
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+int bitmapFreeUnits(void);
+int bitmapLargestFreeRun(void);
+
+// ============================================================================
+// COUNTERS
+// ============================================================================
+// Same rules as EngineCounters in mm_engine.h: since bitmapInit() or
+// bitmapResetCounters(), zeros when built with ENGINE_COUNTERS=0.
+typedef struct {
+    uint64_t allocations;
+    uint64_t failedAllocations;
+    uint64_t searches;          // bitmapFindRun calls
+    uint64_t wordsInspected;    // Bitmap words the searches read
+    uint64_t frees;
+    uint64_t summaryUpdates;    // Summary bits flipped (the index upkeep)
+} BitmapCounters;
+
+void bitmapReadCounters(BitmapCounters *counters);
+void bitmapResetCounters(void);
+
+#endif // BITMAP_ENGINE_H
@@ -0,0 +1,338 @@
+// ============================================================================
+// ENGINE BENCHMARK - Block List vs Bitmap Search Cost Under Fragmentation
+// ============================================================================
+// For a growing number of free holes, times an allocate/free pair whose
+// request is too large for every hole, so each search has to get past all
+// of them:
+//   - mm_engine.c     First Fit over the block array (SoA + SIMD scans)
+//   - bitmap_engine.c lowest free run in a 1 MB-unit bitmap
+//
+// Then packs one batch of mixed-size requests into a fragmented heap, one
+// request at a time in arrival order versus engineAllocateBatch (largest
+// first, one rebuild of the block arrays), and reports how much of the
+// batch each places and the time per request.
+//
+// Finally runs a churny workload (frees and reallocations of a few common
+// sizes) under each coalescing policy, then with fast bins, and reports
+// the merge work done and bin hit rate against the fragmentation left
+// behind. Binned bytes read as used to the engine's statistics, so the
+// fast-bin table also shows fragmentation with them counted as free but
+// unmerged (Frag+bins%).
+//
+// Compile with: gcc -O2 -march=native engine_bench.c mm_engine.c bitmap_engine.c
+// ============================================================================
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "mm_engine.h"
+#include "bitmap_engine.h"
+
+#define MB ((uint64_t)1 << 20)
+#define HEAP_BYTES (MB << 20)  // 1 TB heap
+#define UNIT_BYTES MB          // Bitmap unit (1M units)
+#define HOLE_BYTES (4 * MB)    // Size of each hole (and each block between)
+#define REQUEST_BYTES (8 * MB) // Fits in no hole
+#define ROUNDS 20000           // Timed allocate/free pairs per level
+
+#define BATCH_HOLES 1000       // Holes in the batch packing layout
+#define BATCH_REQUESTS 1500    // Requests per batch (more than the holes hold)
+#define BATCH_ROUNDS 50        // Timed repetitions of each packing method
+
+#define CHURN_HEAP (3072 * MB) // Heap for the coalescing workload
+#define CHURN_OPS 200000       // Allocate/free operations per policy
+#define CHURN_LIVE 400         // Target number of live allocations
+
+static double nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * Leave `holes` free HOLE_BYTES gaps at the start of the block engine
+ * @return: nanoseconds per allocate/free pair
+ */
+static double benchBlockEngine(int holes) {
+    engineInit(HEAP_BYTES);
+    for (int i = 0; i < 2 * holes; i++) {
+        engineAllocate(FIT_FIRST, i + 1, HOLE_BYTES);
+    }
+    for (int i = 0; i < 2 * holes; i += 2) {
+        engineDeallocate(i + 1);
+    }
+    engineCoalesce();
+
+    int owner = 2 * holes + 1;
+    double start = nowNs();
+    for (int r = 0; r < ROUNDS; r++) {
+        if (engineAllocate(FIT_FIRST, owner, REQUEST_BYTES) == -1 ||
+            engineDeallocate(owner) == -1) {
+            return -1;
+        }
+        engineCoalesce();
+    }
+    return (nowNs() - start) / ROUNDS;
+}
+
+/**
+ * Same layout in the bitmap engine
+ * @return: nanoseconds per allocate/free pair
+ */
+static double benchBitmapEngine(int holes) {
+    bitmapInit(HEAP_BYTES, UNIT_BYTES);
+    int holeUnits = bitmapUnitsFor(HOLE_BYTES);
+    for (int i = 0; i < 2 * holes; i++) {
+        bitmapAllocate(HOLE_BYTES);
+    }
+    for (int i = 0; i < 2 * holes; i += 2) {
+        bitmapFree(i * holeUnits, HOLE_BYTES);
+    }
+
+    double start = nowNs();
+    for (int r = 0; r < ROUNDS; r++) {
+        int unit = bitmapAllocate(REQUEST_BYTES);
+        if (unit == -1 || !bitmapFree(unit, REQUEST_BYTES)) {
+            return -1;
+        }
+    }
+    return (nowNs() - start) / ROUNDS;
+}
+
+static uint64_t batchHoles[BATCH_HOLES];
+static int batchOwners[BATCH_REQUESTS];
+static EngineSize batchSizes[BATCH_REQUESTS];
+static int batchIndexes[BATCH_REQUESTS];
+
+/**
+ * Holes of 1-64 MB separated by 1 MB allocated blocks, no free tail
+ */
+static void loadBatchLayout(void) {
+    EngineSize total = 0;
+    for (int i = 0; i < BATCH_HOLES; i++) {
+        total += batchHoles[i] + MB;
+    }
+    engineClear(total);
+    for (int i = 0; i < BATCH_HOLES; i++) {
+        engineAppendBlock(batchHoles[i], 1, ENGINE_NO_OWNER, FIT_NONE);
+        engineAppendBlock(MB, 0, BATCH_REQUESTS + 1 + i, FIT_FIRST);
+    }
+}
+
+/**
+ * Pack the batch with the given strategy, one by one or as a batch
+ * @return: nanoseconds per request; *placed / *placedBytes describe the result
+ */
+static double benchBatchPacking(int strategy, int batched, int *placed, EngineSize *placedBytes) {
+    double total = 0;
+    for (int round = 0; round < BATCH_ROUNDS; round++) {
+        loadBatchLayout();
+        double start = nowNs();
+        if (batched) {
+            engineAllocateBatch(strategy, BATCH_REQUESTS, batchOwners, batchSizes, batchIndexes);
+        } else {
+            for (int r = 0; r < BATCH_REQUESTS; r++) {
+                batchIndexes[r] = engineAllocate(strategy, batchOwners[r], batchSizes[r]);
+            }
+        }
+        total += nowNs() - start;
+    }
+
+    *placed = 0;
+    *placedBytes = 0;
+    for (int r = 0; r < BATCH_REQUESTS; r++) {
+        if (batchIndexes[r] != -1) {
+            (*placed)++;
+            *placedBytes += batchSizes[r];
+        }
+    }
+    return total / BATCH_ROUNDS / BATCH_REQUESTS;
+}
+
+static void benchBatch(void) {
+    srand(1);
+    EngineSize holeBytes = 0, requestBytes = 0;
+    for (int i = 0; i < BATCH_HOLES; i++) {
+        batchHoles[i] = (uint64_t)(1 + rand() % 64) * MB;
+        holeBytes += batchHoles[i];
+    }
+    for (int r = 0; r < BATCH_REQUESTS; r++) {
+        batchOwners[r] = r + 1;
+        batchSizes[r] = (EngineSize)(1 + rand() % 48) * MB;
+        requestBytes += batchSizes[r];
+    }
+
+    printf("\nBATCH PACKING: %d requests (%llu MB) into %d holes (%llu MB)\n\n",
+           BATCH_REQUESTS, (unsigned long long)(requestBytes / MB),
+           BATCH_HOLES, (unsigned long long)(holeBytes / MB));
+    printf("%-26s %-10s %-16s %-14s\n", "Method", "Placed", "Placed MB (%)", "ns/request");
+    printf("------------------------------------------------------------------\n");
+
+    static const struct { const char *name; int strategy; int batched; } methods[] = {
+        { "First Fit, one by one", FIT_FIRST, 0 },
+        { "Best Fit, one by one", FIT_BEST, 0 },
+        { "First Fit Decreasing", FIT_FIRST, 1 },
+        { "Best Fit Decreasing", FIT_BEST, 1 },
+    };
+    for (int m = 0; m < (int)(sizeof(methods) / sizeof(methods[0])); m++) {
+        int placed;
+        EngineSize placedBytes;
+        double ns = benchBatchPacking(methods[m].strategy, methods[m].batched,
+                                      &placed, &placedBytes);
+        printf("%-26s %-10d %-7llu (%5.1f%%)  %-14.0f\n", methods[m].name, placed,
+               (unsigned long long)(placedBytes / MB), placedBytes * 100.0 / holeBytes, ns);
+    }
+}
+
+typedef struct {
+    int failed;           // Allocations that found no block
+    double freeBlocks;    // Average free blocks
+    double fragmentation; // Average external fragmentation, % of the heap
+    double fragBinned;    // Same, with binned bytes counted as unmerged free space
+    double binnedMB;      // Average memory parked in fast bins
+    double ns;            // Per operation
+} ChurnResult;
+
+/**
+ * Frees and reallocations of a few common sizes around CHURN_LIVE live
+ * blocks, under whatever coalescing policy / fast bins are set
+ */
+static void runChurn(ChurnResult *result) {
+    static const int sizesMB[] = { 1, 2, 4, 8, 16 };
+    static int live[2 * CHURN_LIVE];
+    int liveCount = 0;
+    int owner = 1;
+    double freeBlocks = 0, fragmentation = 0, fragBinned = 0, binned = 0;
+    int samples = 0;
+
+    srand(7);
+    engineInit(CHURN_HEAP);
+    engineResetCoalesceCounters();
+    result->failed = 0;
+
+    double start = nowNs();
+    for (int op = 0; op < CHURN_OPS; op++) {
+        int allocate = liveCount == 0 ||
+            (liveCount < 2 * CHURN_LIVE && rand() % (2 * CHURN_LIVE) >= liveCount);
+        if (allocate) {
+            EngineSize size = (EngineSize)sizesMB[rand() % 5] * MB;
+            if (engineAllocate(FIT_FIRST, owner, size) != -1) {
+                live[liveCount++] = owner;
+            } else {
+                result->failed++;
+            }
+            owner++;
+        } else {
+            int k = rand() % liveCount;
+            engineDeallocate(live[k]);
+            live[k] = live[--liveCount];
+        }
+
+        freeBlocks += engineFreeBlockCount();
+        if (op % 64 == 0) {
+            engineUpdateStats();
+            fragmentation += (double)(engineFreeMemory() - engineLargestFreeBlock()) / CHURN_HEAP;
+            // Binned blocks read as used above; they are free, just never merged
+            fragBinned += (double)(engineFreeMemory() + engineFastBinBytes() -
+                                            engineLargestFreeBlock()) / CHURN_HEAP;
+            binned += (double)engineFastBinBytes() / MB;
+            samples++;
+        }
+    }
+
+    result->ns = (nowNs() - start) / CHURN_OPS;
+    result->freeBlocks = freeBlocks / CHURN_OPS;
+    result->fragmentation = fragmentation * 100.0 / samples;
+    result->fragBinned = fragBinned * 100.0 / samples;
+    result->binnedMB = binned / samples;
+}
+
+static void benchCoalescePolicy(const char *name, int policy, int threshold) {
+    ChurnResult r;
+    engineSetCoalescePolicy(policy, threshold);
+    runChurn(&r);
+    printf("%-16s %-8d %-8d %-12llu %-8d %-8d %-11.1f %-9.1f %-8.0f\n",
+           name, engineCoalescePasses(), engineCoalesceMerges(),
+           (unsigned long long)engineCoalesceScanned(), engineCoalesceRescues(), r.failed,
+           r.freeBlocks, r.fragmentation, r.ns);
+    engineSetCoalescePolicy(COALESCE_MANUAL, 0);
+}
+
+static void benchCoalescing(void) {
+    printf("\nCOALESCING POLICY: %d ops, ~%d live blocks of 1-16 MB, %llu MB heap\n\n",
+           CHURN_OPS, CHURN_LIVE, (unsigned long long)(CHURN_HEAP / MB));
+    printf("%-16s %-8s %-8s %-12s %-8s %-8s %-11s %-9s %-8s\n", "Policy", "Passes",
+           "Merges", "Scanned", "Rescues", "Failed", "Free blks", "Ext frag%", "ns/op");
+    printf("----------------------------------------------------------------------------------------\n");
+
+    benchCoalescePolicy("Never", COALESCE_MANUAL, 0);
+    benchCoalescePolicy("Eager", COALESCE_EAGER, 0);
+    benchCoalescePolicy("Deferred (8)", COALESCE_DEFERRED, 8);
+    benchCoalescePolicy("Deferred (64)", COALESCE_DEFERRED, 64);
+    benchCoalescePolicy("Deferred (256)", COALESCE_DEFERRED, 256);
+}
+
+/**
+ * Same churn with 1 MB-granule fast bins (every churn size has a bin)
+ */
+static void benchFastBin(const char *name, int policy, int bins, int interval) {
+    ChurnResult r;
+    engineSetCoalescePolicy(policy, 8);
+    engineSetFastBins(MB, bins, interval);
+    runChurn(&r);
+
+    int hits = engineFastBinHits();
+    int lookups = hits + engineFastBinMisses();
+    printf("%-26s %-8.1f %-9d %-8d %-10.0f %-9.1f %-12.1f %-8d %-8.0f\n", name,
+           lookups > 0 ? hits * 100.0 / lookups : 0.0, engineFastBinConsolidations(),
+           engineCoalescePasses(), r.binnedMB, r.fragmentation, r.fragBinned,
+           r.failed, r.ns);
+
+    engineSetFastBins(0, 0, 0);
+    engineSetCoalescePolicy(COALESCE_MANUAL, 0);
+}
+
+static void benchFastBins(void) {
+    printf("\nFAST BINS: same workload, bins for 1..16 MB\n\n");
+    printf("%-26s %-8s %-9s %-8s %-10s %-9s %-12s %-8s %-8s\n", "Setup", "Hit %",
+           "Consol.", "Passes", "Binned MB", "Ext frag%", "Frag+bins%", "Failed", "ns/op");
+    printf("-------------------------------------------------------------------------------------------------\n");
+
+    benchFastBin("Eager, no bins", COALESCE_EAGER, 0, 0);
+    benchFastBin("Eager + bins", COALESCE_EAGER, 16, 0);
+    benchFastBin("Eager + bins (every 256)", COALESCE_EAGER, 16, 256);
+    benchFastBin("Deferred (8), no bins", COALESCE_DEFERRED, 0, 0);
+    benchFastBin("Deferred (8) + bins", COALESCE_DEFERRED, 16, 0);
+}
+
+int main(void) {
+    static const int levels[] = { 0, 16, 128, 512, 1024, 2000 };
+    int levelCount = sizeof(levels) / sizeof(levels[0]);
+
+    printf("\n========================================\n");
+    printf("ENGINE BENCHMARK (scan kernel: %s)\n", engineScanKernel());
+    printf("========================================\n");
+    printf("Heap: %llu GB, holes of %llu MB, request %llu MB\n\n",
+           (unsigned long long)(HEAP_BYTES >> 30),
+           (unsigned long long)(HOLE_BYTES / MB),
+           (unsigned long long)(REQUEST_BYTES / MB));
+    printf("%-8s %-18s %-18s\n", "Holes", "Block list (ns)", "Bitmap (ns)");
+    printf("----------------------------------------------\n");
+
+    for (int i = 0; i < levelCount; i++) {
+        double list = benchBlockEngine(levels[i]);
+        double bitmap = benchBitmapEngine(levels[i]);
+        printf("%-8d %-18.0f %-18.0f\n", levels[i], list, bitmap);
+    }
+
+    printf("\n(Block list is limited to %d blocks, so at most %d holes.)\n",
+           ENGINE_MAX_BLOCKS, ENGINE_MAX_BLOCKS / 2 - 1);
+
+    benchBatch();
+    benchCoalescing();
+    benchFastBins();
+    return 0;
+}
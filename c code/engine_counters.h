@@ -0,0 +1,200 @@
+// ============================================================================
+// ENGINE COUNTERS - Hot-Path Counters as JSON
+// ============================================================================
+// Writes the counters of every engine whose header was included before this
+// one (mm_engine.h, bitmap_engine.h, wait_queue.h) as one JSON object:
+//
+//   {"counters_enabled": true,
+//    "mm_engine": {"allocations": 1200, "failed_allocations": 3, ...},
+//    "bitmap_engine": {...}, "wait_queue": {...}}
+//
+// Header-only, like event_log.h. Formatting uses no stdio and no malloc and
+// output goes through write(), so a dump is safe from a signal handler and
+// from malloc_shim.c:
+//   countersDumpAtExit(path)             at normal exit
+//   countersDumpOnSignal(path, SIGUSR1)  whenever the signal arrives
+//   kill -USR1 <pid>                     to take a snapshot mid-run
+// A path of "-" means stderr. Programs use one or both of the two (the
+// others are marked unused so -Wall stays quiet).
+// ============================================================================
+
+#ifndef ENGINE_COUNTERS_H
+#define ENGINE_COUNTERS_H
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef ENGINE_COUNTERS
+#define ENGINE_COUNTERS 1
+#endif
+
+#define COUNTERS_JSON_BYTES 4096
+#define COUNTERS_PATH_BYTES 1024
+
+static char countersPath[COUNTERS_PATH_BYTES];
+
+typedef struct {
+    char text[COUNTERS_JSON_BYTES];
+    size_t length;
+} CountersJson;
+
+static void countersAppend(CountersJson *json, const char *text) {
+    while (*text && json->length < COUNTERS_JSON_BYTES - 1) {
+        json->text[json->length++] = *text++;
+    }
+}
+
+/**
+ * Append ", "name": value" (no comma before the first field of an object)
+ */
+static void countersField(CountersJson *json, const char *name, uint64_t value, int first) {
+    char digits[24];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    countersAppend(json, first ? "\"" : ", \"");
+    countersAppend(json, name);
+    countersAppend(json, "\": ");
+    while (n > 0 && json->length < COUNTERS_JSON_BYTES - 1) {
+        json->text[json->length++] = digits[--n];
+    }
+}
+
+/**
+ * Write the counters as JSON followed by a newline
+ * @return: 1 if the whole object was written
+ */
+static int countersWrite(int fd) {
+    CountersJson json;
+    json.length = 0;
+    countersAppend(&json, ENGINE_COUNTERS ? "{\"counters_enabled\": true"
+                                          : "{\"counters_enabled\": false");
+
+#ifdef MM_ENGINE_H
+    EngineCounters e;
+    engineReadCounters(&e);
+    countersAppend(&json, ",\n \"mm_engine\": {");
+    countersField(&json, "allocations", e.allocations, 1);
+    countersField(&json, "failed_allocations", e.failedAllocations, 0);
+    countersField(&json, "searches", e.searches, 0);
+    countersField(&json, "blocks_inspected", e.blocksInspected, 0);
+    countersField(&json, "splits", e.splits, 0);
+    countersField(&json, "blocks_shifted", e.blocksShifted, 0);
+    countersField(&json, "frees", e.frees, 0);
+    countersField(&json, "coalesce_passes", e.coalescePasses, 0);
+    countersField(&json, "merges", e.merges, 0);
+    countersField(&json, "compactions", e.compactions, 0);
+    countersField(&json, "compaction_bytes_moved", e.compactionBytesMoved, 0);
+    countersField(&json, "fast_bin_hits", e.fastBinHits, 0);
+    countersAppend(&json, "}");
+#endif
+
+#ifdef BITMAP_ENGINE_H
+    BitmapCounters b;
+    bitmapReadCounters(&b);
+    countersAppend(&json, ",\n \"bitmap_engine\": {");
+    countersField(&json, "allocations", b.allocations, 1);
+    countersField(&json, "failed_allocations", b.failedAllocations, 0);
+    countersField(&json, "searches", b.searches, 0);
+    countersField(&json, "words_inspected", b.wordsInspected, 0);
+    countersField(&json, "frees", b.frees, 0);
+    countersField(&json, "summary_updates", b.summaryUpdates, 0);
+    countersAppend(&json, "}");
+#endif
+
+#ifdef WAIT_QUEUE_H
+    countersAppend(&json, ",\n \"wait_queue\": {");
+    countersField(&json, "releases", waitQueueReleases(), 1);
+    countersField(&json, "examined", waitQueueExamined(), 0);
+    countersField(&json, "served", waitQueueServed(), 0);
+    countersField(&json, "waiting", (uint64_t)waitQueueLength(), 0);
+    countersAppend(&json, "}");
+#endif
+
+    countersAppend(&json, "}\n");
+
+    const char *p = json.text;
+    size_t left = json.length;
+    while (left > 0) {
+        ssize_t written = write(fd, p, left);
+        if (written <= 0) {
+            return 0;
+        }
+        p += written;
+        left -= (size_t)written;
+    }
+    return 1;
+}
+
+/**
+ * Write the counters to path ("-" = stderr), replacing the file
+ * @return: 1 if successful
+ */
+static int countersDump(const char *path) {
+    if (strcmp(path, "-") == 0) {
+        return countersWrite(STDERR_FILENO);
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return 0;
+    }
+    int ok = countersWrite(fd);
+    close(fd);
+    return ok;
+}
+
+/**
+ * Remember where dumps go (the handlers cannot take arguments)
+ * @return: 1 if the path fits
+ */
+static int countersSetPath(const char *path) {
+    size_t length = strlen(path);
+    if (length == 0 || length >= COUNTERS_PATH_BYTES) {
+        return 0;
+    }
+    memcpy(countersPath, path, length + 1);
+    return 1;
+}
+
+static void countersExitHandler(void) {
+    countersDump(countersPath);
+}
+
+static void countersSignalHandler(int signalNumber) {
+    (void)signalNumber;
+    countersDump(countersPath);
+}
+
+/**
+ * Dump to path when the program exits normally
+ * @return: 1 if registered
+ */
+__attribute__((unused))
+static int countersDumpAtExit(const char *path) {
+    return countersSetPath(path) && atexit(countersExitHandler) == 0;
+}
+
+/**
+ * Dump to path every time signalNumber arrives (the program keeps running)
+ * @return: 1 if installed
+ */
+__attribute__((unused))
+static int countersDumpOnSignal(const char *path, int signalNumber) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = countersSignalHandler;
+#ifdef SA_RESTART
+    action.sa_flags = SA_RESTART;  // Not under a strict _POSIX_C_SOURCE
+#endif
+    sigemptyset(&action.sa_mask);
+    return countersSetPath(path) && sigaction(signalNumber, &action, NULL) == 0;
+}
+
+#endif // ENGINE_COUNTERS_H
@@ -0,0 +1,350 @@
+// ============================================================================
+// EVENT LOG - Leveled Console Output and Buffered Event Sink
+// ============================================================================
+// Shared by the simulator programs in this directory (header-only, so each
+// program still compiles as a single translation unit).
+//
+// Log levels:
+//   LOG_SILENT   - print nothing
+//   LOG_SUMMARY  - scenario headers, memory layouts, statistics, and op
+//                  totals in place of the per-operation lines
+//   LOG_PER_OP   - the classic output: headers, layouts and statistics plus
+//                  one or more lines per operation (the default)
+//
+// Event sink:
+//   Every allocate/free/coalesce/compact appends a fixed-size binary record
+//   to an in-memory buffer. No formatting happens on that path. When a
+//   buffer fills up it is handed to a background writer thread, which
+//   formats it as CSV (or dumps it raw) while the simulator keeps running
+//   on the second buffer (double buffering).
+//
+// Command-line options (see parseLogOptions):
+//   --log=silent|summary|ops   -q (same as --log=silent)
+//   --events=FILE              write events as CSV
+//   --events-binary=FILE       write events as raw EventRecord structs
+//
+// Compile with: gcc -pthread <program>.c
+// ============================================================================
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#define EVENT_BUFFER_SIZE 4096  // Records per buffer (two buffers in flight)
+#define EVENT_PROCESS_ID 14     // Process ID bytes kept per record
+
+// ============================================================================
+// LOG LEVELS
+// ============================================================================
+typedef enum {
+    LOG_SILENT = 0,
+    LOG_SUMMARY = 1,
+    LOG_PER_OP = 2
+} LogLevel;
+
+static LogLevel logLevel = LOG_PER_OP;  // Default keeps the classic output
+
+// Per-operation messages (split details, "✓ Allocated ...", etc.)
+#define LOG_OP(...) \
+    do { if (logLevel >= LOG_PER_OP) printf(__VA_ARGS__); } while (0)
+
+// Scenario narration, layouts and statistics
+#define LOG_SUMMARY(...) \
+    do { if (logLevel >= LOG_SUMMARY) printf(__VA_ARGS__); } while (0)
+
+// ============================================================================
+// EVENT RECORD
+// ============================================================================
+typedef enum {
+    EVENT_ALLOCATE = 0,
+    EVENT_ALLOCATE_FAILED,
+    EVENT_DEALLOCATE,
+    EVENT_DEALLOCATE_FAILED,
+    EVENT_COALESCE,
+    EVENT_COMPACT,
+    EVENT_TYPE_COUNT
+} EventType;
+
+typedef enum {
+    STRATEGY_NONE = 0,
+    STRATEGY_FIRST_FIT,
+    STRATEGY_NEXT_FIT,
+    STRATEGY_BEST_FIT,
+    STRATEGY_WORST_FIT
+} EventStrategy;
+
+typedef enum {
+    EVENT_FORMAT_CSV = 0,
+    EVENT_FORMAT_BINARY
+} EventFormat;
+
+// Fixed 32-byte record; this is also the on-disk layout in binary mode.
+//   ALLOCATE / DEALLOCATE : size = request size (KB), blockIndex = block used
+//   *_FAILED              : size = request size (KB), blockIndex = -1
+//   COALESCE              : size = merges performed, blockIndex = blocks left
+//   COMPACT               : size = free KB consolidated, blockIndex = blocks left
+typedef struct {
+    uint64_t sequence;                   // Operation number (0-based)
+    int32_t size;
+    int32_t blockIndex;
+    uint8_t type;                        // EventType
+    uint8_t strategy;                    // EventStrategy
+    char processId[EVENT_PROCESS_ID];    // Not NUL-terminated if full length
+} EventRecord;
+
+static const char *eventTypeNames[EVENT_TYPE_COUNT] = {
+    "allocate", "allocate_failed", "deallocate",
+    "deallocate_failed", "coalesce", "compact"
+};
+
+static const char *eventStrategyNames[] = {
+    "-", "first_fit", "next_fit", "best_fit", "worst_fit"
+};
+
+// ============================================================================
+// EVENT SINK STATE
+// ============================================================================
+static struct {
+    FILE *file;                      // NULL = sink disabled
+    EventFormat format;
+
+    EventRecord buffers[2][EVENT_BUFFER_SIZE];
+    EventRecord *active;             // Filled by the simulator
+    int activeCount;
+    EventRecord *pending;            // Owned by the writer while pendingCount > 0
+    int pendingCount;
+
+    pthread_t writer;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;            // Writer: a buffer is pending
+    pthread_cond_t drained;          // Simulator: pending buffer was written
+    int stopping;
+} eventLog;
+
+static uint64_t eventSequence = 0;
+static uint64_t eventCounts[EVENT_TYPE_COUNT];
+
+// ============================================================================
+// BACKGROUND WRITER
+// ============================================================================
+
+static void writeEventBatch(const EventRecord *records, int count) {
+    if (eventLog.format == EVENT_FORMAT_BINARY) {
+        fwrite(records, sizeof(EventRecord), count, eventLog.file);
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const EventRecord *r = &records[i];
+        fprintf(eventLog.file, "%llu,%s,%s,%.*s,%d,%d\n",
+                (unsigned long long)r->sequence,
+                eventTypeNames[r->type],
+                eventStrategyNames[r->strategy],
+                EVENT_PROCESS_ID, r->processId,
+                r->size,
+                r->blockIndex);
+    }
+}
+
+static void *eventWriterThread(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&eventLog.lock);
+    for (;;) {
+        while (eventLog.pendingCount == 0 && !eventLog.stopping) {
+            pthread_cond_wait(&eventLog.ready, &eventLog.lock);
+        }
+        if (eventLog.pendingCount == 0 && eventLog.stopping) {
+            break;
+        }
+
+        // Format outside the lock so the simulator never waits on I/O
+        // unless it has already filled the other buffer as well
+        const EventRecord *batch = eventLog.pending;
+        int count = eventLog.pendingCount;
+        pthread_mutex_unlock(&eventLog.lock);
+
+        writeEventBatch(batch, count);
+
+        pthread_mutex_lock(&eventLog.lock);
+        eventLog.pendingCount = 0;
+        pthread_cond_signal(&eventLog.drained);
+    }
+    pthread_mutex_unlock(&eventLog.lock);
+
+    fflush(eventLog.file);
+    return NULL;
+}
+
+/**
+ * Hand the active buffer to the writer thread and start filling the other one
+ * Blocks only if the writer is still busy with the previous buffer.
+ */
+static void eventLogSwapBuffers(void) {
+    pthread_mutex_lock(&eventLog.lock);
+    while (eventLog.pendingCount > 0) {
+        pthread_cond_wait(&eventLog.drained, &eventLog.lock);
+    }
+
+    EventRecord *full = eventLog.active;
+    eventLog.active = eventLog.pending;
+    eventLog.pending = full;
+    eventLog.pendingCount = eventLog.activeCount;
+    eventLog.activeCount = 0;
+
+    pthread_cond_signal(&eventLog.ready);
+    pthread_mutex_unlock(&eventLog.lock);
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+/**
+ * Open the event sink and start the writer thread
+ * @return: 1 if successful, 0 if the file could not be opened
+ */
+static int eventLogOpen(const char *path, EventFormat format) {
+    if (eventLog.file != NULL) {
+        fprintf(stderr, "✗ Event log already open\n");
+        return 0;
+    }
+
+    FILE *file = fopen(path, format == EVENT_FORMAT_BINARY ? "wb" : "w");
+    if (file == NULL) {
+        fprintf(stderr, "✗ Cannot open event log %s\n", path);
+        return 0;
+    }
+
+    eventLog.file = file;
+    eventLog.format = format;
+    eventLog.active = eventLog.buffers[0];
+    eventLog.pending = eventLog.buffers[1];
+    eventLog.activeCount = 0;
+    eventLog.pendingCount = 0;
+    eventLog.stopping = 0;
+    pthread_mutex_init(&eventLog.lock, NULL);
+    pthread_cond_init(&eventLog.ready, NULL);
+    pthread_cond_init(&eventLog.drained, NULL);
+
+    if (format == EVENT_FORMAT_CSV) {
+        fprintf(file, "sequence,event,strategy,process_id,size_kb,block_index\n");
+    }
+
+    if (pthread_create(&eventLog.writer, NULL, eventWriterThread, NULL) != 0) {
+        fprintf(stderr, "✗ Cannot start event log writer thread\n");
+        fclose(file);
+        eventLog.file = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Record one operation (hot path: counter bump + struct copy, no I/O)
+ */
+static inline void logEvent(EventType type, EventStrategy strategy,
+                            const char *processId, int size, int blockIndex) {
+    eventCounts[type]++;
+    uint64_t sequence = eventSequence++;
+
+    if (eventLog.file == NULL) {
+        return;
+    }
+
+    EventRecord *r = &eventLog.active[eventLog.activeCount];
+    r->sequence = sequence;
+    r->size = size;
+    r->blockIndex = blockIndex;
+    r->type = (uint8_t)type;
+    r->strategy = (uint8_t)strategy;
+    // Not NUL-terminated when full: readers print it with %.*s
+    size_t length = strnlen(processId, EVENT_PROCESS_ID);
+    memcpy(r->processId, processId, length);
+    memset(r->processId + length, 0, EVENT_PROCESS_ID - length);
+
+    if (++eventLog.activeCount == EVENT_BUFFER_SIZE) {
+        eventLogSwapBuffers();
+    }
+}
+
+/**
+ * Flush remaining events, stop the writer thread and close the file
+ */
+static void eventLogClose(void) {
+    if (eventLog.file == NULL) {
+        return;
+    }
+
+    if (eventLog.activeCount > 0) {
+        eventLogSwapBuffers();
+    }
+
+    pthread_mutex_lock(&eventLog.lock);
+    eventLog.stopping = 1;
+    pthread_cond_signal(&eventLog.ready);
+    pthread_mutex_unlock(&eventLog.lock);
+
+    pthread_join(eventLog.writer, NULL);
+    fclose(eventLog.file);
+    eventLog.file = NULL;
+
+    pthread_cond_destroy(&eventLog.drained);
+    pthread_cond_destroy(&eventLog.ready);
+    pthread_mutex_destroy(&eventLog.lock);
+}
+
+/**
+ * Print operation totals. Only at LOG_SUMMARY, where they stand in for the
+ * per-operation lines; the default (LOG_PER_OP) output stays the classic one.
+ */
+static void displayEventSummary(void) {
+    if (logLevel != LOG_SUMMARY) {
+        return;
+    }
+    LOG_SUMMARY("\n========== OPERATION SUMMARY ==========\n");
+    LOG_SUMMARY("Allocations:               %llu succeeded, %llu failed\n",
+                (unsigned long long)eventCounts[EVENT_ALLOCATE],
+                (unsigned long long)eventCounts[EVENT_ALLOCATE_FAILED]);
+    LOG_SUMMARY("Deallocations:             %llu succeeded, %llu failed\n",
+                (unsigned long long)eventCounts[EVENT_DEALLOCATE],
+                (unsigned long long)eventCounts[EVENT_DEALLOCATE_FAILED]);
+    LOG_SUMMARY("Coalesce Passes:           %llu\n",
+                (unsigned long long)eventCounts[EVENT_COALESCE]);
+    LOG_SUMMARY("Compactions:               %llu\n",
+                (unsigned long long)eventCounts[EVENT_COMPACT]);
+    LOG_SUMMARY("=======================================\n");
+}
+
+/**
+ * Parse logging options from the command line
+ * @return: 1 if all arguments were understood, 0 otherwise
+ */
+static int parseLogOptions(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+
+        if (strcmp(arg, "-q") == 0 || strcmp(arg, "--log=silent") == 0) {
+            logLevel = LOG_SILENT;
+        } else if (strcmp(arg, "--log=summary") == 0) {
+            logLevel = LOG_SUMMARY;
+        } else if (strcmp(arg, "--log=ops") == 0) {
+            logLevel = LOG_PER_OP;
+        } else if (strncmp(arg, "--events=", 9) == 0) {
+            if (!eventLogOpen(arg + 9, EVENT_FORMAT_CSV)) return 0;
+        } else if (strncmp(arg, "--events-binary=", 16) == 0) {
+            if (!eventLogOpen(arg + 16, EVENT_FORMAT_BINARY)) return 0;
+        } else {
+            fprintf(stderr, "Usage: %s [-q] [--log=silent|summary|ops] "
+                            "[--events=FILE.csv | --events-binary=FILE]\n", argv[0]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+#endif // EVENT_LOG_H
@@ -0,0 +1,419 @@
+// ============================================================================
+// EVENT SIMULATOR - Steady-State Fragmentation Under Arrivals and Departures
+// ============================================================================
+// A discrete-event simulation on top of mm_engine.c. Processes arrive at
+// random intervals, request a random amount of memory, hold it for a
+// random lifetime and then leave. Unlike the scripted scenarios in the
+// demo programs, nothing is freed by hand: departures come out of an
+// expiry queue (binary min-heap on departure time), so the heap settles
+// into the long-running steady state where fragmentation shows.
+//
+// Time is abstract (units of the distributions below). The next arrival is
+// a single pending event; every allocated process has one pending
+// departure in the heap. Each event is O(log live) for the queue plus the
+// engine's fit search.
+//
+//   gcc -O2 -march=native -o event_sim event_sim.c mm_engine.c wait_queue.c -lm
+//   ./event_sim                                   # all four strategies
+//   ./event_sim --strategy=best --lifetime=pareto:1.5:100 --size=exp:32
+//
+// Distributions (sim_common.h; --arrival = time between arrivals,
+// --lifetime, --size in KB):
+//   fixed:V   uniform:LO:HI   exp:MEAN   pareto:ALPHA:MIN
+//
+// By default an arrival that finds no fit fails. With --queue it waits in
+// wait_queue.c instead and is served by a later departure whose free run
+// fits it; its lifetime starts when it is served. Queueing delay is
+// reported as percentiles (--queue=priority draws priorities 0-3):
+//   ./event_sim --heap-mb=140 --queue=sjf --queue-limit=2048
+//
+// --counters=PATH writes the engine's hot-path counters (engine_counters.h)
+// as JSON at exit and on SIGUSR1, for the last strategy run.
+// ============================================================================
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mm_engine.h"
+#include "wait_queue.h"
+#include "engine_counters.h"
+#include "sim_common.h"
+
+#define QUEUE_OFF (-1)
+#define PRIORITIES 4
+#define RELEASE_BATCH 64        // Requests served per waitQueueRelease() call
+
+static const char *strategyNames[] = { "all", "first", "next", "best", "worst" };
+static const char *strategyTitles[] = { "-", "First Fit", "Next Fit", "Best Fit", "Worst Fit" };
+static const char *coalesceNames[] = { "manual", "eager", "deferred" };
+static const char *queueNames[] = { "fifo", "sjf", "priority" };
+
+// ============================================================================
+// SIMULATION
+// ============================================================================
+typedef struct {
+    Distribution arrival;
+    Distribution lifetime;
+    Distribution size;      // KB
+    EngineSize heapBytes;
+    uint64_t arrivals;      // Run length
+    int coalesce;
+    uint64_t seed;
+    int queue;              // WaitPolicy, or QUEUE_OFF
+    int queueLimit;         // Requests waiting at once
+} SimConfig;
+
+typedef struct {
+    double time;
+    double utilization;     // Used / heap, %
+    double fragmentation;   // 1 - largest free / free, %
+    int freeBlocks;
+    int live;
+} Sample;
+
+typedef struct {
+    uint64_t arrivals;
+    uint64_t departures;
+    uint64_t failed;        // Rejected: no fit and no room to wait
+    uint64_t queued;
+    uint64_t served;        // Queued requests that got memory
+    int leftWaiting;        // Still queued at the end of the run
+    double waitPercentiles[5];  // p50, p90, p99, p99.9, max of the served
+    double examinedPerFree; // Waiting requests compared per departure
+    double seconds;
+    Sample samples[SAMPLES];
+    int sampleCount;
+} SimResult;
+
+static int freeOwners[ENGINE_MAX_BLOCKS];  // Stack of unused owner IDs
+static int freeOwnerCount;
+static double ownerLifetime[ENGINE_MAX_BLOCKS + 1];  // Of queued owners, from when served
+
+static double *waits = NULL;  // Waiting time of every served request
+static uint64_t waitCount = 0;
+static uint64_t waitCapacity = 0;
+
+/**
+ * Record how long a served request waited
+ */
+static void recordWait(double wait) {
+    if (waitCount == waitCapacity) {
+        waitCapacity = waitCapacity ? waitCapacity * 2 : 65536;
+        waits = realloc(waits, waitCapacity * sizeof(double));
+        if (!waits) {
+            fprintf(stderr, "✗ Out of memory for waiting times\n");
+            exit(1);
+        }
+    }
+    waits[waitCount++] = wait;
+}
+
+/**
+ * Serve waiting requests that fit where a departure freed memory; their
+ * departures are scheduled from now
+ */
+static void serveWaiting(double now, EngineSize address, SimResult *result) {
+    WaitRequest served[RELEASE_BATCH];
+    int count;
+
+    do {
+        count = waitQueueRelease(address, served, RELEASE_BATCH);
+        for (int i = 0; i < count; i++) {
+            Departure d = { .time = now + ownerLifetime[served[i].owner],
+                            .address = engineBlockStart(served[i].index),
+                            .owner = served[i].owner };
+            pushDeparture(d);
+            recordWait(now - served[i].enqueued);
+        }
+        result->served += count;
+    } while (count == RELEASE_BATCH);
+}
+
+static void takeSample(double now, SimResult *result) {
+    engineUpdateStats();
+    EngineSize freeBytes = engineFreeMemory();
+    int holes;
+    EngineSize largest = engineLargestFreeRun(&holes);
+
+    Sample *s = &result->samples[result->sampleCount++];
+    s->time = now;
+    s->utilization = 100.0 * engineUsedMemory() / engineTotalMemory();
+    s->fragmentation = freeBytes > 0 ? 100.0 * (1.0 - (double)largest / freeBytes) : 0;
+    s->freeBlocks = holes;
+    s->live = departureCount;
+}
+
+static int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Waiting-time percentiles (nearest rank) and queue work of a finished run
+ */
+static void summarizeWaits(SimResult *result) {
+    static const double points[] = { 50, 90, 99, 99.9, 100 };
+
+    if (waitCount > 0) {
+        qsort(waits, waitCount, sizeof(double), compareDoubles);
+        for (int p = 0; p < 5; p++) {
+            uint64_t rank = (uint64_t)ceil(points[p] / 100 * waitCount);
+            result->waitPercentiles[p] = waits[rank > 0 ? rank - 1 : 0];
+        }
+    }
+    result->leftWaiting = waitQueueLength();
+    result->examinedPerFree = result->departures > 0
+                            ? (double)waitQueueExamined() / result->departures : 0;
+}
+
+/**
+ * Run one simulation with the given strategy from an empty heap
+ */
+static void simulate(const SimConfig *config, int strategy, SimResult *result) {
+    engineInit(config->heapBytes);
+    engineSetCoalescePolicy(config->coalesce, DEFERRED_THRESHOLD);
+    rngState = config->seed;
+    departureCount = 0;
+    for (freeOwnerCount = 0; freeOwnerCount < ENGINE_MAX_BLOCKS; freeOwnerCount++) {
+        freeOwners[freeOwnerCount] = ENGINE_MAX_BLOCKS - freeOwnerCount;
+    }
+    memset(result, 0, sizeof(*result));
+    waitQueueInit(config->queue == QUEUE_OFF ? WAIT_FIFO : config->queue);
+    waitCount = 0;
+
+    uint64_t sampleEvery = config->arrivals / SAMPLES > 0 ? config->arrivals / SAMPLES : 1;
+    double nextArrival = sample(&config->arrival);
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    while (result->arrivals < config->arrivals) {
+        // Departures due before the next arrival go first
+        if (departureCount > 0 && departures[0].time <= nextArrival) {
+            Departure d = popDeparture();
+            int index = engineBlockAt(d.address);
+            if (index != -1 && engineBlockOwner(index) == d.owner) {
+                engineDeallocateAt(index);
+            } else {
+                engineDeallocate(d.owner);
+            }
+            freeOwners[freeOwnerCount++] = d.owner;
+            result->departures++;
+            if (waitQueueLength() > 0) {
+                serveWaiting(d.time, d.address, result);
+            }
+            continue;
+        }
+
+        double now = nextArrival;
+        nextArrival = now + sample(&config->arrival);
+        result->arrivals++;
+
+        EngineSize size = (EngineSize)(sample(&config->size) * KB);
+        double lifetime = sample(&config->lifetime);
+        int index = freeOwnerCount > 0 && size > 0
+                  ? engineAllocate(strategy, freeOwners[freeOwnerCount - 1], size) : -1;
+        if (index == -1 && config->queue != QUEUE_OFF && size > 0 && freeOwnerCount > 0 &&
+            waitQueueLength() < config->queueLimit) {
+            int owner = freeOwners[--freeOwnerCount];
+            WaitRequest request = { owner, strategy, size,
+                                    (int)(randomUnit() * PRIORITIES), now, -1 };
+            ownerLifetime[owner] = lifetime;
+            waitQueueAdd(&request);
+            result->queued++;
+        } else if (index == -1) {
+            result->failed++;
+        } else {
+            Departure d = { .time = now + lifetime, .address = engineBlockStart(index),
+                            .owner = freeOwners[--freeOwnerCount] };
+            pushDeparture(d);
+        }
+
+        if (result->arrivals % sampleEvery == 0 && result->sampleCount < SAMPLES) {
+            takeSample(now, result);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    summarizeWaits(result);
+    result->seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+/**
+ * Averages over the samples after warm-up
+ */
+static void steadyState(const SimResult *r, double *utilization, double *fragmentation,
+                        double *freeBlocks, double *live) {
+    int from = r->sampleCount > WARMUP_SAMPLES ? WARMUP_SAMPLES : 0;
+    int n = r->sampleCount - from;
+    *utilization = *fragmentation = *freeBlocks = *live = 0;
+    for (int i = from; i < r->sampleCount; i++) {
+        *utilization += r->samples[i].utilization / n;
+        *fragmentation += r->samples[i].fragmentation / n;
+        *freeBlocks += (double)r->samples[i].freeBlocks / n;
+        *live += (double)r->samples[i].live / n;
+    }
+}
+
+static void printQueueing(int strategy, const SimResult *r) {
+    printf("%-11s %-10.3f %-9d", strategyTitles[strategy],
+           100.0 * r->queued / r->arrivals, r->leftWaiting);
+    for (int p = 0; p < 5; p++) {
+        if (r->served > 0) {
+            printf(" %-9.1f", r->waitPercentiles[p]);
+        } else {
+            printf(" %-9s", "-");
+        }
+    }
+    printf(" %-10.2f\n", r->examinedPerFree);
+}
+
+static void printTimeline(const SimResult *r) {
+    printf("\n%-12s %-8s %-12s %-14s %-12s\n",
+           "Time", "Live", "Used %", "Ext. Frag %", "Free Blocks");
+    printf("------------------------------------------------------------\n");
+    for (int i = SAMPLES / 10 - 1; i < r->sampleCount; i += SAMPLES / 10) {
+        const Sample *s = &r->samples[i];
+        printf("%-12.0f %-8d %-12.1f %-14.1f %-12d\n",
+               s->time, s->live, s->utilization, s->fragmentation, s->freeBlocks);
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char *argv[]) {
+    SimConfig config = {
+        .arrival = { DIST_EXPONENTIAL, 1, 0 },
+        .lifetime = { DIST_EXPONENTIAL, 1000, 0 },
+        .size = { DIST_UNIFORM, 1, 256 },
+        .heapBytes = 256 * MB,
+        .arrivals = 2000000,
+        .coalesce = COALESCE_DEFERRED,
+        .seed = 1,
+        .queue = QUEUE_OFF,
+        .queueLimit = 1024,
+    };
+    int strategy = 0;  // All
+    const char *countersOutput = NULL;
+    int ok = 1;
+
+    for (int i = 1; i < argc && ok; i++) {
+        const char *arg = argv[i];
+        if (strncmp(arg, "--arrival=", 10) == 0) {
+            ok = parseDistribution(arg + 10, &config.arrival);
+        } else if (strncmp(arg, "--lifetime=", 11) == 0) {
+            ok = parseDistribution(arg + 11, &config.lifetime);
+        } else if (strncmp(arg, "--size=", 7) == 0) {
+            ok = parseDistribution(arg + 7, &config.size);
+        } else if (strncmp(arg, "--heap-mb=", 10) == 0) {
+            config.heapBytes = strtoull(arg + 10, NULL, 10) * MB;
+            ok = config.heapBytes > 0;
+        } else if (strncmp(arg, "--arrivals=", 11) == 0) {
+            config.arrivals = strtoull(arg + 11, NULL, 10);
+            ok = config.arrivals > 0;
+        } else if (strncmp(arg, "--seed=", 7) == 0) {
+            config.seed = strtoull(arg + 7, NULL, 10) | 1;  // xorshift needs a nonzero state
+        } else if (strncmp(arg, "--strategy=", 11) == 0) {
+            strategy = -1;
+            for (int s = 0; s <= FIT_WORST; s++) {
+                if (strcmp(arg + 11, strategyNames[s]) == 0) strategy = s;
+            }
+            ok = strategy >= 0;
+        } else if (strncmp(arg, "--coalesce=", 11) == 0) {
+            config.coalesce = -1;
+            for (int c = 0; c <= COALESCE_DEFERRED; c++) {
+                if (strcmp(arg + 11, coalesceNames[c]) == 0) config.coalesce = c;
+            }
+            ok = config.coalesce >= 0;
+        } else if (strncmp(arg, "--queue=", 8) == 0) {
+            config.queue = strcmp(arg + 8, "off") == 0 ? QUEUE_OFF : -2;
+            for (int q = WAIT_FIFO; q <= WAIT_PRIORITY; q++) {
+                if (strcmp(arg + 8, queueNames[q]) == 0) config.queue = q;
+            }
+            ok = config.queue != -2;
+        } else if (strncmp(arg, "--counters=", 11) == 0) {
+            countersOutput = arg + 11;
+        } else if (strncmp(arg, "--queue-limit=", 14) == 0) {
+            config.queueLimit = atoi(arg + 14);
+            ok = config.queueLimit > 0 && config.queueLimit <= WAIT_MAX_REQUESTS;
+        } else {
+            ok = 0;
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "Usage: %s [--strategy=all|first|next|best|worst] "
+                        "[--arrival=DIST] [--lifetime=DIST] [--size=DIST(KB)] [--heap-mb=N] "
+                        "[--arrivals=N] [--coalesce=manual|eager|deferred] [--seed=N] "
+                        "[--queue=off|fifo|sjf|priority] [--queue-limit=N] [--counters=PATH]\n"
+                        "DIST: fixed:V | uniform:LO:HI | exp:MEAN | pareto:ALPHA:MIN\n",
+                argv[0]);
+        return 1;
+    }
+
+    if (countersOutput &&
+        (!countersDumpAtExit(countersOutput) || !countersDumpOnSignal(countersOutput, SIGUSR1))) {
+        fprintf(stderr, "✗ Cannot dump counters to %s\n", countersOutput);
+        return 1;
+    }
+
+    // Little's law: expected live processes and bytes if nothing fails
+    double live = distributionMean(&config.lifetime) / distributionMean(&config.arrival);
+    double offered = live * distributionMean(&config.size) * KB;
+
+    printf("\n========== DISCRETE-EVENT SIMULATION ==========\n");
+    printf("Heap:                      %llu MB, coalescing %s\n",
+           (unsigned long long)(config.heapBytes / MB), coalesceNames[config.coalesce]);
+    printf("Arrivals:                  %llu, expected live %.0f, offered load %.1f%% of heap\n",
+           (unsigned long long)config.arrivals, live, 100.0 * offered / config.heapBytes);
+    printf("Steady state:              averages over samples %d-%d\n", WARMUP_SAMPLES + 1, SAMPLES);
+    if (config.queue != QUEUE_OFF) {
+        printf("Blocked requests:          wait (%s, up to %d)\n",
+               queueNames[config.queue], config.queueLimit);
+    }
+
+    static SimResult result;
+    int first = strategy == 0 ? FIT_FIRST : strategy;
+    int last = strategy == 0 ? FIT_WORST : strategy;
+
+    printf("\n%-11s %-11s %-9s %-9s %-12s %-12s %-10s\n", "Strategy", "Failed %", "Live",
+           "Used %", "Ext. Frag %", "Free Blocks", "M events/s");
+    printf("---------------------------------------------------------------------------------\n");
+    static SimResult results[FIT_WORST + 1];
+    for (int s = first; s <= last; s++) {
+        simulate(&config, s, &result);
+        double utilization, fragmentation, freeBlocks, liveAverage;
+        steadyState(&result, &utilization, &fragmentation, &freeBlocks, &liveAverage);
+        printf("%-11s %-11.3f %-9.0f %-9.1f %-12.1f %-12.0f %-10.2f\n", strategyTitles[s],
+               100.0 * result.failed / result.arrivals, liveAverage, utilization,
+               fragmentation, freeBlocks,
+               (result.arrivals + result.departures) / 1e6 / result.seconds);
+        results[s] = result;
+    }
+
+    if (config.queue != QUEUE_OFF) {
+        printf("\nWaiting time (served requests, time units):\n");
+        printf("%-11s %-10s %-9s %-9s %-9s %-9s %-9s %-9s %-10s\n", "Strategy", "Queued %",
+               "Left", "p50", "p90", "p99", "p99.9", "Max", "Examined/free");
+        printf("------------------------------------------------------------------------------------------\n");
+        for (int s = first; s <= last; s++) {
+            printQueueing(s, &results[s]);
+        }
+    }
+
+    if (first == last) {
+        printTimeline(&result);
+    }
+    printf("===============================================\n");
+    return 0;
+}
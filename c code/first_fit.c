@@ -17,7 +17,9 @@
 
 #define TOTAL_MEMORY 10240  // Total memory in KB
 #define MAX_BLOCKS 100      // Maximum number of memory blocks
-#define MAX_PROCESS_ID 10   // Max characters in process ID
+
+#include "event_log.h"
+#include "process_table.h"
 
 // ============================================================================
 // MEMORY BLOCK STRUCTURE
@@ -25,7 +27,7 @@
 typedef struct {
     int size;                      // Size of block in KB
     int isFree;                    // 1 = free, 0 = allocated
-    char processId[MAX_PROCESS_ID]; // Process ID (empty if free)
+    ProcessHandle owner;           // Owner (NO_PROCESS if free)
 } MemoryBlock;
 
 // Global memory blocks array
@@ -43,16 +45,18 @@ void initializeMemory() {
     blockCount = 0;
     memory[blockCount].size = TOTAL_MEMORY;
     memory[blockCount].isFree = 1;
-    strcpy(memory[blockCount].processId, "");
+    memory[blockCount].owner = NO_PROCESS;
     blockCount++;
     
-    printf("✓ Memory initialized: %d KB free\n\n", TOTAL_MEMORY);
+    LOG_SUMMARY("✓ Memory initialized: %d KB free\n\n", TOTAL_MEMORY);
 }
 
 /**
  * Display the entire memory layout
  */
 void displayMemoryLayout() {
+    if (logLevel < LOG_SUMMARY) return;
+
     printf("\n========== MEMORY LAYOUT (FIRST FIT) ==========\n");
     printf("%-8s %-15s %-12s %-15s\n", "Block#", "Size (KB)", "Status", "Process ID");
     printf("---------------------------------------------\n");
@@ -62,7 +66,7 @@ void displayMemoryLayout() {
                i + 1,
                memory[i].size,
                memory[i].isFree ? "FREE" : "ALLOCATED",
-               memory[i].isFree ? "---" : memory[i].processId);
+               processName(memory[i].owner));
     }
     printf("============================================\n");
 }
@@ -71,6 +75,8 @@ void displayMemoryLayout() {
  * Display memory statistics
  */
 void displayStatistics() {
+    if (logLevel < LOG_SUMMARY) return;
+
     int usedMemory = 0;
     int freeMemory = 0;
     int activeProcesses = 0;
@@ -118,34 +124,45 @@ void displayStatistics() {
  * 5. If found, allocate (split if necessary)
  * 6. If not found, return failure
  *
- * @return: 1 if successful, 0 if failed
+ * @return: handle of the process, or NO_PROCESS if failed
  */
-int allocateFirstFit(char *processId, int requiredSize) {
+ProcessHandle allocateFirstFit(const char *processId, int requiredSize) {
     // Validation: size must be positive and within total memory
     if (requiredSize <= 0 || requiredSize > TOTAL_MEMORY) {
-        printf("✗ Invalid size: %d KB\n", requiredSize);
-        return 0;
+        LOG_OP("✗ Invalid size: %d KB\n", requiredSize);
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_FIRST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
+    }
+
+    // Name → handle once; everything below compares integers
+    ProcessHandle process = internProcess(processId);
+    if (process == NO_PROCESS) {
+        LOG_OP("✗ Process table full\n");
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_FIRST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
     }
 
     // Check if process already exists
     for (int i = 0; i < blockCount; i++) {
-        if (!memory[i].isFree && strcmp(memory[i].processId, processId) == 0) {
-            printf("✗ Process %s already allocated\n", processId);
-            return 0;
+        if (!memory[i].isFree && memory[i].owner == process) {
+            LOG_OP("✗ Process %s already allocated\n", processId);
+            logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_FIRST_FIT, processId, requiredSize, -1);
+            return NO_PROCESS;
         }
     }
 
     // Check array bounds
     if (blockCount >= MAX_BLOCKS - 1) {
-        printf("✗ Memory block limit reached\n");
-        return 0;
+        LOG_OP("✗ Memory block limit reached\n");
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_FIRST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
     }
 
     // FIRST FIT: Scan from beginning, allocate to FIRST suitable block
     for (int i = 0; i < blockCount; i++) {
         // If block is free AND large enough, allocate here
         if (memory[i].isFree && memory[i].size >= requiredSize) {
-            printf("  [First Fit] Found free block %d (size %d KB) at position %d\n",
+            LOG_OP("  [First Fit] Found free block %d (size %d KB) at position %d\n",
                    i + 1, memory[i].size, i);
 
             // Case 1: Block is larger than required size
@@ -161,46 +178,52 @@ int allocateFirstFit(char *processId, int requiredSize) {
                 // Set allocated block
                 memory[i].size = requiredSize;
                 memory[i].isFree = 0;
-                strcpy(memory[i].processId, processId);
+                memory[i].owner = process;
 
                 // Set leftover free block
                 memory[i + 1].size = leftoverSize;
                 memory[i + 1].isFree = 1;
-                strcpy(memory[i + 1].processId, "");
+                memory[i + 1].owner = NO_PROCESS;
 
                 blockCount++;
             } 
             // Case 2: Exact fit - no split needed
             else {
                 memory[i].isFree = 0;
-                strcpy(memory[i].processId, processId);
+                memory[i].owner = process;
             }
 
-            printf("✓ [First Fit] Allocated %d KB to %s\n\n", requiredSize, processId);
-            return 1;
+            LOG_OP("✓ [First Fit] Allocated %d KB to %s\n\n", requiredSize, processId);
+
+            logEvent(EVENT_ALLOCATE, STRATEGY_FIRST_FIT, processId, requiredSize, i);
+            return process;
         }
     }
 
     // No suitable block found
-    printf("✗ [First Fit] Cannot allocate %d KB to %s (not enough contiguous memory)\n\n",
+    LOG_OP("✗ [First Fit] Cannot allocate %d KB to %s (not enough contiguous memory)\n\n",
            requiredSize, processId);
-    return 0;
+    logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_FIRST_FIT, processId, requiredSize, -1);
+    return NO_PROCESS;
 }
 
 /**
- * Deallocate memory from a process
+ * Deallocate memory from a process (handle returned by the allocate call)
+ * @return: 1 if successful, 0 if failed
  */
-int deallocateMemory(char *processId) {
+int deallocateMemory(ProcessHandle process) {
     for (int i = 0; i < blockCount; i++) {
-        if (!memory[i].isFree && strcmp(memory[i].processId, processId) == 0) {
+        if (!memory[i].isFree && memory[i].owner == process) {
             memory[i].isFree = 1;
-            strcpy(memory[i].processId, "");
-            printf("✓ Deallocated process %s\n", processId);
+            memory[i].owner = NO_PROCESS;
+            LOG_OP("✓ Deallocated process %s\n", processName(process));
+            logEvent(EVENT_DEALLOCATE, STRATEGY_NONE, processName(process), memory[i].size, i);
             return 1;
         }
     }
 
-    printf("✗ Process %s not found\n", processId);
+    LOG_OP("✗ Process %s not found\n", processName(process));
+    logEvent(EVENT_DEALLOCATE_FAILED, STRATEGY_NONE, processName(process), 0, -1);
     return 0;
 }
 
@@ -209,6 +232,7 @@ int deallocateMemory(char *processId) {
  */
 void coalesceMemory() {
     int i = 0;
+    int merges = 0;
     while (i < blockCount - 1) {
         if (memory[i].isFree && memory[i + 1].isFree) {
             // Merge blocks
@@ -219,87 +243,96 @@ void coalesceMemory() {
                 memory[j] = memory[j + 1];
             }
             blockCount--;
+            merges++;
             // Don't increment i, check if merge can continue
         } else {
             i++;
         }
     }
+
+    logEvent(EVENT_COALESCE, STRATEGY_NONE, "", merges, blockCount);
 }
 
 // ============================================================================
 // MAIN - DEMONSTRATION OF FIRST FIT
 // ============================================================================
 
-int main() {
-    printf("\n");
-    printf("╔═══════════════════════════════════════════════════════════╗\n");
-    printf("║   FIRST FIT MEMORY ALLOCATION - C Implementation          ║\n");
-    printf("║              Total Memory: 10240 KB                       ║\n");
-    printf("╚═══════════════════════════════════════════════════════════╝\n\n");
+int main(int argc, char *argv[]) {
+    if (!parseLogOptions(argc, argv)) {
+        return 1;
+    }
+
+    LOG_SUMMARY("\n");
+    LOG_SUMMARY("╔═══════════════════════════════════════════════════════════╗\n");
+    LOG_SUMMARY("║   FIRST FIT MEMORY ALLOCATION - C Implementation          ║\n");
+    LOG_SUMMARY("║              Total Memory: 10240 KB                       ║\n");
+    LOG_SUMMARY("╚═══════════════════════════════════════════════════════════╝\n\n");
 
     initializeMemory();
 
     // ========== SCENARIO 1: Basic Allocation ==========
-    printf("--- SCENARIO 1: Basic Allocation with First Fit ---\n");
+    LOG_SUMMARY("--- SCENARIO 1: Basic Allocation with First Fit ---\n");
     allocateFirstFit("P1", 200);
-    allocateFirstFit("P2", 150);
+    ProcessHandle p2 = allocateFirstFit("P2", 150);
     allocateFirstFit("P3", 100);
     displayMemoryLayout();
     displayStatistics();
 
     // ========== SCENARIO 2: Deallocation ==========
-    printf("\n--- SCENARIO 2: Deallocation ---\n");
-    deallocateMemory("P2");
+    LOG_SUMMARY("\n--- SCENARIO 2: Deallocation ---\n");
+    deallocateMemory(p2);
     coalesceMemory();
-    printf("(After deallocating P2 and coalescing)\n");
+    LOG_SUMMARY("(After deallocating P2 and coalescing)\n");
     displayMemoryLayout();
     displayStatistics();
 
     // ========== SCENARIO 3: Allocation in freed space ==========
-    printf("\n--- SCENARIO 3: Allocating in Previously Free Space ---\n");
+    LOG_SUMMARY("\n--- SCENARIO 3: Allocating in Previously Free Space ---\n");
     allocateFirstFit("P4", 100);
     displayMemoryLayout();
     displayStatistics();
 
     // ========== SCENARIO 4: Fragmentation demonstration ==========
-    printf("\n--- SCENARIO 4: Demonstrating External Fragmentation ---\n");
+    LOG_SUMMARY("\n--- SCENARIO 4: Demonstrating External Fragmentation ---\n");
     initializeMemory();
-    printf("Allocating multiple small processes:\n");
+    LOG_SUMMARY("Allocating multiple small processes:\n");
     allocateFirstFit("P5", 1000);
-    allocateFirstFit("P6", 1000);
+    ProcessHandle p6 = allocateFirstFit("P6", 1000);
     allocateFirstFit("P7", 1000);
-    allocateFirstFit("P8", 1000);
+    ProcessHandle p8 = allocateFirstFit("P8", 1000);
     allocateFirstFit("P9", 1000);
-    allocateFirstFit("P10", 1000);
+    ProcessHandle p10 = allocateFirstFit("P10", 1000);
     allocateFirstFit("P11", 1000);
-    allocateFirstFit("P12", 1000);
+    ProcessHandle p12 = allocateFirstFit("P12", 1000);
     allocateFirstFit("P13", 1000);
     allocateFirstFit("P14", 1000);
     displayMemoryLayout();
     displayStatistics();
 
-    printf("Now all memory is allocated. Try allocating P15:\n");
+    LOG_SUMMARY("Now all memory is allocated. Try allocating P15:\n");
     allocateFirstFit("P15", 500);
 
     // ========== SCENARIO 5: Deallocation pattern ==========
-    printf("\n--- SCENARIO 5: Deallocation with Gaps ---\n");
-    deallocateMemory("P6");
-    deallocateMemory("P8");
-    deallocateMemory("P10");
-    deallocateMemory("P12");
+    LOG_SUMMARY("\n--- SCENARIO 5: Deallocation with Gaps ---\n");
+    deallocateMemory(p6);
+    deallocateMemory(p8);
+    deallocateMemory(p10);
+    deallocateMemory(p12);
     coalesceMemory();
-    printf("(Deallocated P6, P8, P10, P12 and coalesced)\n");
+    LOG_SUMMARY("(Deallocated P6, P8, P10, P12 and coalesced)\n");
     displayMemoryLayout();
     displayStatistics();
 
-    printf("Now trying to allocate P15 again (First Fit finds first suitable block):\n");
+    LOG_SUMMARY("Now trying to allocate P15 again (First Fit finds first suitable block):\n");
     allocateFirstFit("P15", 500);
     displayMemoryLayout();
     displayStatistics();
 
-    printf("\n╔═══════════════════════════════════════════════════════════╗\n");
-    printf("║               First Fit Simulation Complete                ║\n");
-    printf("╚═══════════════════════════════════════════════════════════╝\n\n");
+    LOG_SUMMARY("\n╔═══════════════════════════════════════════════════════════╗\n");
+    LOG_SUMMARY("║               First Fit Simulation Complete                ║\n");
+    LOG_SUMMARY("╚═══════════════════════════════════════════════════════════╝\n\n");
 
+    displayEventSummary();
+    eventLogClose();
     return 0;
 }
@@ -0,0 +1,283 @@
+// ============================================================================
+// LATENCY HISTOGRAM - High-Dynamic-Range Operation Timings
+// ============================================================================
+// HdrHistogram-style log-linear buckets over nanoseconds: values below 128
+// have a bucket each, and above that every power of two is split into 64
+// buckets, so any recorded value is known to within 1/64 (1.6%) from 1 ns
+// up to 2^47 ns (39 hours) in 2688 counters. Recording is a clz, a shift
+// and an increment; percentiles are read off the cumulative counts, so the
+// tail (p99.99, max) is as exact as the median.
+//
+// Histograms merge by adding counts: one per thread, summed at the end
+// (latencyMerge), or one per run, saved as text and loaded back into a
+// later report (latencySave / latencyLoad):
+//
+//   # latency histogram: operation bucket-ns count | operation max ns
+//   allocate 1024 17
+//   allocate max 183211
+//
+// The clock is the TSC on x86 (rdtsc, calibrated against CLOCK_MONOTONIC
+// by latencyClockInit) and clock_gettime elsewhere. Header-only, like
+// event_log.h; helpers a program may not need are marked unused.
+// ============================================================================
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define LATENCY_TSC 1
+#endif
+
+#define LATENCY_LINEAR 128          // Values with a bucket each
+#define LATENCY_HALF 64             // Buckets per power of two above that
+#define LATENCY_MAX_SHIFT 40        // Shift of the top bucket: 2^47 - 1 ns
+#define LATENCY_BUCKETS (LATENCY_LINEAR + LATENCY_MAX_SHIFT * LATENCY_HALF)
+#define LATENCY_MAX_NS (((uint64_t)1 << 47) - 1)
+
+typedef struct {
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t total;
+    uint64_t max;
+} LatencyHistogram;
+
+// ============================================================================
+// CLOCK
+// ============================================================================
+
+static double latencyNsPerTick = 1.0;
+
+static inline uint64_t latencyMonotonicNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Current time in clock ticks (TSC cycles, or ns without a TSC)
+ */
+static inline uint64_t latencyNow(void) {
+#ifdef LATENCY_TSC
+    return __rdtsc();
+#else
+    return latencyMonotonicNs();
+#endif
+}
+
+/**
+ * Measure the tick rate against CLOCK_MONOTONIC (about 20 ms, once)
+ */
+static void latencyClockInit(void) {
+#ifdef LATENCY_TSC
+    uint64_t ns0 = latencyMonotonicNs();
+    uint64_t ticks0 = __rdtsc();
+    while (latencyMonotonicNs() - ns0 < 20000000) {
+    }
+    uint64_t ticks = __rdtsc() - ticks0;
+    uint64_t ns = latencyMonotonicNs() - ns0;
+    latencyNsPerTick = ticks > 0 ? (double)ns / ticks : 1.0;
+#endif
+}
+
+static inline uint64_t latencyElapsedNs(uint64_t startTicks) {
+    return (uint64_t)((latencyNow() - startTicks) * latencyNsPerTick);
+}
+
+// ============================================================================
+// BUCKETS
+// ============================================================================
+
+static inline int latencyBucket(uint64_t ns) {
+    if (ns < LATENCY_LINEAR) {
+        return (int)ns;
+    }
+    if (ns > LATENCY_MAX_NS) {
+        ns = LATENCY_MAX_NS;
+    }
+    int shift = 63 - __builtin_clzll(ns) - 6;  // Keep the top 7 bits
+    return LATENCY_LINEAR + (shift - 1) * LATENCY_HALF + (int)((ns >> shift) - LATENCY_HALF);
+}
+
+/**
+ * Lowest value that lands in bucket b
+ */
+static uint64_t latencyBucketLow(int b) {
+    if (b < LATENCY_LINEAR) {
+        return (uint64_t)b;
+    }
+    int k = b - LATENCY_LINEAR;
+    return (uint64_t)(LATENCY_HALF + k % LATENCY_HALF) << (k / LATENCY_HALF + 1);
+}
+
+/**
+ * Highest value that lands in bucket b
+ */
+static uint64_t latencyBucketHigh(int b) {
+    if (b < LATENCY_LINEAR) {
+        return (uint64_t)b;
+    }
+    return latencyBucketLow(b) + ((uint64_t)1 << ((b - LATENCY_LINEAR) / LATENCY_HALF + 1)) - 1;
+}
+
+// ============================================================================
+// RECORDING AND MERGING
+// ============================================================================
+
+__attribute__((unused))
+static void latencyReset(LatencyHistogram *h) {
+    memset(h, 0, sizeof(*h));
+}
+
+static inline void latencyRecord(LatencyHistogram *h, uint64_t ns) {
+    h->counts[latencyBucket(ns)]++;
+    h->total++;
+    if (ns > h->max) {
+        h->max = ns;
+    }
+}
+
+/**
+ * Add every count of src to dst (per-thread or per-run histograms)
+ */
+__attribute__((unused))
+static void latencyMerge(LatencyHistogram *dst, const LatencyHistogram *src) {
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        dst->counts[b] += src->counts[b];
+    }
+    dst->total += src->total;
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+}
+
+/**
+ * Value at or below which p percent of the recorded values lie (the top of
+ * its bucket, but never more than the exact maximum)
+ * @return: ns, or 0 if nothing was recorded
+ */
+static uint64_t latencyPercentile(const LatencyHistogram *h, double p) {
+    if (h->total == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(p / 100.0 * h->total + 0.999999);
+    if (rank == 0) rank = 1;
+    if (rank > h->total) rank = h->total;
+
+    uint64_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += h->counts[b];
+        if (seen >= rank) {
+            uint64_t high = latencyBucketHigh(b);
+            return high < h->max ? high : h->max;
+        }
+    }
+    return h->max;
+}
+
+// ============================================================================
+// SAVE / LOAD
+// ============================================================================
+
+/**
+ * Write the histograms as text (non-empty buckets only)
+ * @return: 1 if successful
+ */
+static int latencySave(const char *path, const char **names,
+                       const LatencyHistogram *histograms, int count) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "✗ Cannot write %s\n", path);
+        return 0;
+    }
+    fprintf(f, "# latency histogram: operation bucket-ns count | operation max ns\n");
+    for (int i = 0; i < count; i++) {
+        const LatencyHistogram *h = &histograms[i];
+        for (int b = 0; b < LATENCY_BUCKETS; b++) {
+            if (h->counts[b] > 0) {
+                fprintf(f, "%s %llu %llu\n", names[i], (unsigned long long)latencyBucketLow(b),
+                        (unsigned long long)h->counts[b]);
+            }
+        }
+        if (h->total > 0) {
+            fprintf(f, "%s max %llu\n", names[i], (unsigned long long)h->max);
+        }
+    }
+    return fclose(f) == 0;
+}
+
+/**
+ * Add the histograms saved in path to the ones with the same names
+ * (unknown operations are ignored)
+ * @return: 1 if successful
+ */
+static int latencyLoad(const char *path, const char **names,
+                       LatencyHistogram *histograms, int count) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "✗ Cannot open %s\n", path);
+        return 0;
+    }
+
+    char line[128], name[32], field[32];
+    unsigned long long value;
+    int ok = 1;
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        if (sscanf(line, "%31s %31s %llu", name, field, &value) != 3) {
+            ok = 0;
+            break;
+        }
+
+        LatencyHistogram *h = NULL;
+        for (int i = 0; i < count && !h; i++) {
+            if (strcmp(name, names[i]) == 0) h = &histograms[i];
+        }
+        if (!h) {
+            continue;
+        }
+        if (strcmp(field, "max") == 0) {
+            if (value > h->max) h->max = value;
+        } else {
+            h->counts[latencyBucket(strtoull(field, NULL, 10))] += value;
+            h->total += value;
+        }
+    }
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "✗ Malformed latency histogram in %s\n", path);
+    }
+    return ok;
+}
+
+// ============================================================================
+// REPORT
+// ============================================================================
+
+static void latencyPrintTable(const char **names, const LatencyHistogram *histograms, int count) {
+    static const double points[] = { 50, 90, 99, 99.9, 99.99 };
+
+    printf("\n%-12s %-12s %-9s %-9s %-9s %-9s %-9s %-10s\n", "Latency (ns)", "Count",
+           "p50", "p90", "p99", "p99.9", "p99.99", "Max");
+    printf("---------------------------------------------------------------------------------\n");
+    for (int i = 0; i < count; i++) {
+        const LatencyHistogram *h = &histograms[i];
+        if (h->total == 0) {
+            continue;
+        }
+        printf("%-12s %-12llu", names[i], (unsigned long long)h->total);
+        for (int p = 0; p < 5; p++) {
+            printf(" %-9llu", (unsigned long long)latencyPercentile(h, points[p]));
+        }
+        printf(" %-10llu\n", (unsigned long long)h->max);
+    }
+}
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,376 @@
+// ============================================================================
+// MALLOC SHIM - Run Real Programs on the Simulator's Allocators
+// ============================================================================
+// An LD_PRELOAD library that replaces malloc/free/realloc/calloc (and the
+// aligned variants) with one of the engines managing a real mmap'd arena,
+// so unmodified programs run on First/Next/Best/Worst Fit (mm_engine.c) or
+// on the page bitmap (bitmap_engine.c) and their wall-clock time and RSS
+// can be measured:
+//
+//   gcc -O2 -march=native -shared -fPIC -pthread -o libmmshim.so malloc_shim.c
+//       mm_engine.c bitmap_engine.c
+//       -DENGINE_MAX_BLOCKS=262144 -DBITMAP_MAX_UNITS='(1 << 26)'
+//   MM_SHIM_STRATEGY=best MM_SHIM_STATS=1 LD_PRELOAD=./libmmshim.so
+//       /usr/bin/time -v ls -R /usr > /dev/null
+//
+// Environment:
+//   MM_SHIM_STRATEGY  first | next | best | worst | bitmap   (default first)
+//   MM_SHIM_ARENA_MB  arena size in MB                       (default 1024)
+//   MM_SHIM_COALESCE  eager | deferred | manual              (default deferred)
+//   MM_SHIM_FASTBINS  fast bins for blocks up to N * 16 bytes (default 0 = off)
+//   MM_SHIM_UNIT      bitmap unit in bytes                   (default 16)
+//   MM_SHIM_STATS     print counters to stderr at exit
+//   MM_SHIM_COUNTERS  write the engine counters as JSON to this path
+//                     ("-" = stderr) at exit and on SIGUSR1
+//
+// Every pointer is preceded by a 16-byte header (usable size, offset back
+// to the start of the underlying block). Requests the arena cannot hold
+// (arena full, block limit reached) fall back to a private mmap each and
+// are counted. The engines are not thread-safe; one spinlock serialises
+// them, and is held across fork() so the child never inherits it taken.
+// Nothing here calls malloc, directly or through stdio.
+// ============================================================================
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "mm_engine.h"
+#include "bitmap_engine.h"
+#include "engine_counters.h"
+
+#define SHIM_ALIGN 16            // Alignment of every pointer returned
+#define SHIM_HEADER 16           // sizeof(ShimHeader)
+#define SHIM_BITMAP 5            // Strategy code past FIT_WORST: bitmap_engine.c
+#define SHIM_DEFERRED_THRESHOLD 64
+
+typedef struct {
+    uint64_t capacity;  // Usable bytes from the user pointer on
+    uint64_t offset;    // User pointer - start of the underlying block
+} ShimHeader;
+
+static const char *strategyNames[] = { "-", "first", "next", "best", "worst", "bitmap" };
+
+static int shimReady = 0;
+static int shimLock = 0;
+static int shimStrategy = FIT_FIRST;
+static int shimStats = 0;
+static int shimCounters = 0;
+static char *arenaBase = NULL;
+static uint64_t arenaBytes = 0;
+static uint64_t pageSize = 4096;
+static int nextOwner = 1;
+
+// Counters (updated under the lock, or atomically on the mmap path)
+static uint64_t mallocCount = 0;
+static uint64_t freeCount = 0;
+static uint64_t reallocCount = 0;
+static uint64_t fallbackCount = 0;
+static uint64_t arenaInUse = 0;
+static uint64_t arenaPeak = 0;
+
+// ============================================================================
+// SETUP
+// ============================================================================
+
+static void lockShim(void) {
+    while (__atomic_test_and_set(&shimLock, __ATOMIC_ACQUIRE)) {
+        sched_yield();
+    }
+}
+
+static void unlockShim(void) {
+    __atomic_clear(&shimLock, __ATOMIC_RELEASE);
+}
+
+/**
+ * Take the lock before fork() and release it on both sides, so a child
+ * forked while another thread was inside the engine starts unlocked with
+ * a consistent engine state. Registered at load time, not under the lock:
+ * pthread_atfork() may allocate.
+ */
+__attribute__((constructor))
+static void registerForkHandlers(void) {
+    pthread_atfork(lockShim, unlockShim, unlockShim);
+}
+
+static uint64_t roundUp(uint64_t value, uint64_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+static uint64_t envNumber(const char *name, uint64_t fallback) {
+    const char *value = getenv(name);
+    return value && *value ? strtoull(value, NULL, 10) : fallback;
+}
+
+/**
+ * Read the environment, map the arena and initialize the engine
+ * (called under the lock by the first allocation)
+ */
+static void initShim(void) {
+    shimReady = 1;
+    pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+    shimStats = getenv("MM_SHIM_STATS") != NULL;
+
+    // No atexit() here: it may allocate, and the lock is held. The exit
+    // dump is done by reportShim().
+    const char *counters = getenv("MM_SHIM_COUNTERS");
+    shimCounters = counters && countersDumpOnSignal(counters, SIGUSR1);
+
+    const char *strategy = getenv("MM_SHIM_STRATEGY");
+    for (int s = FIT_FIRST; strategy && s <= SHIM_BITMAP; s++) {
+        if (strcmp(strategy, strategyNames[s]) == 0) {
+            shimStrategy = s;
+        }
+    }
+
+    arenaBytes = roundUp(envNumber("MM_SHIM_ARENA_MB", 1024) << 20, pageSize);
+    uint64_t unit = roundUp(envNumber("MM_SHIM_UNIT", SHIM_ALIGN), SHIM_ALIGN);
+    if (shimStrategy == SHIM_BITMAP && arenaBytes / unit > BITMAP_MAX_UNITS) {
+        arenaBytes = (uint64_t)BITMAP_MAX_UNITS * unit;
+    }
+
+    void *arena = mmap(NULL, arenaBytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (arena == MAP_FAILED) {
+        arenaBytes = 0;  // Everything goes to the mmap fallback
+        return;
+    }
+    arenaBase = arena;
+
+    if (shimStrategy == SHIM_BITMAP) {
+        bitmapInit(arenaBytes, unit);
+        return;
+    }
+
+    const char *coalesce = getenv("MM_SHIM_COALESCE");
+    int policy = COALESCE_DEFERRED;
+    if (coalesce && strcmp(coalesce, "eager") == 0) policy = COALESCE_EAGER;
+    if (coalesce && strcmp(coalesce, "manual") == 0) policy = COALESCE_MANUAL;
+
+    engineInit(arenaBytes);
+    engineSetCoalescePolicy(policy, SHIM_DEFERRED_THRESHOLD);
+    engineSetFastBins(SHIM_ALIGN, (int)envNumber("MM_SHIM_FASTBINS", 0), 0);
+}
+
+// ============================================================================
+// ARENA (engine-managed) AND FALLBACK (one mmap per block)
+// ============================================================================
+
+/**
+ * Take `bytes` (a multiple of SHIM_ALIGN) from the arena
+ * @return: start of the block, or NULL if the engine cannot place it
+ */
+static char *arenaAllocate(uint64_t bytes) {
+    if (arenaBytes == 0) {
+        return NULL;
+    }
+
+    if (shimStrategy == SHIM_BITMAP) {
+        int unit = bitmapAllocate(bytes);
+        return unit == -1 ? NULL : arenaBase + bitmapUnitStart(unit);
+    }
+
+    int owner = nextOwner;
+    nextOwner = nextOwner == INT_MAX ? 1 : nextOwner + 1;
+    int index = engineAllocate(shimStrategy, owner, bytes);
+    return index == -1 ? NULL : arenaBase + engineBlockStart(index);
+}
+
+static void arenaFree(char *start, uint64_t bytes) {
+    if (shimStrategy == SHIM_BITMAP) {
+        bitmapFree((int)((uint64_t)(start - arenaBase) / bitmapUnitSize()), bytes);
+    } else {
+        engineDeallocateAt(engineBlockAt((EngineSize)(start - arenaBase)));
+    }
+}
+
+static int inArena(const char *p) {
+    return arenaBase != NULL && p >= arenaBase && p < arenaBase + arenaBytes;
+}
+
+/**
+ * Allocate size usable bytes aligned to alignment (a power of two >= 16)
+ * @return: user pointer, or NULL with errno = ENOMEM
+ */
+static void *shimAllocate(size_t size, size_t alignment) {
+    if (size > SIZE_MAX / 2 || alignment > SIZE_MAX / 4) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    uint64_t padding = alignment > SHIM_ALIGN ? alignment : 0;
+    uint64_t bytes = roundUp(SHIM_HEADER + (uint64_t)size + padding, SHIM_ALIGN);
+
+    lockShim();
+    if (!shimReady) {
+        initShim();
+    }
+    char *start = arenaAllocate(bytes);
+    mallocCount++;
+    if (start != NULL) {
+        arenaInUse += bytes;
+        if (arenaInUse > arenaPeak) arenaPeak = arenaInUse;
+    }
+    unlockShim();
+
+    if (start == NULL) {
+        bytes = roundUp(bytes, pageSize);
+        void *mapped = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED) {
+            errno = ENOMEM;
+            return NULL;
+        }
+        start = mapped;
+        __atomic_fetch_add(&fallbackCount, 1, __ATOMIC_RELAXED);
+    }
+
+    uint64_t align = alignment > SHIM_ALIGN ? alignment : SHIM_ALIGN;
+    char *user = (char *)roundUp((uint64_t)(uintptr_t)(start + SHIM_HEADER), align);
+    ShimHeader *header = (ShimHeader *)(user - SHIM_HEADER);
+    header->offset = (uint64_t)(user - start);
+    header->capacity = bytes - header->offset;
+    return user;
+}
+
+static ShimHeader *headerOf(void *ptr) {
+    return (ShimHeader *)((char *)ptr - SHIM_HEADER);
+}
+
+// ============================================================================
+// MALLOC API
+// ============================================================================
+
+void *malloc(size_t size) {
+    return shimAllocate(size, SHIM_ALIGN);
+}
+
+void free(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    ShimHeader *header = headerOf(ptr);
+    char *start = (char *)ptr - header->offset;
+    uint64_t bytes = header->offset + header->capacity;
+
+    if (inArena(start)) {
+        lockShim();
+        arenaFree(start, bytes);
+        arenaInUse -= bytes;
+        freeCount++;
+        unlockShim();
+    } else {
+        munmap(start, bytes);
+        __atomic_fetch_add(&freeCount, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void *calloc(size_t count, size_t size) {
+    size_t total;
+    if (__builtin_mul_overflow(count, size, &total)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    void *ptr = shimAllocate(total, SHIM_ALIGN);
+    if (ptr != NULL) {
+        memset(ptr, 0, total);  // Arena blocks are reused
+    }
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size) {
+    if (ptr == NULL) {
+        return malloc(size);
+    }
+    if (size == 0) {
+        free(ptr);
+        return NULL;
+    }
+
+    __atomic_fetch_add(&reallocCount, 1, __ATOMIC_RELAXED);
+    ShimHeader *header = headerOf(ptr);
+    if (size <= header->capacity) {
+        return ptr;  // Shrinking, or growing into the block's slack
+    }
+
+    void *moved = shimAllocate(size, SHIM_ALIGN);
+    if (moved != NULL) {
+        memcpy(moved, ptr, header->capacity);
+        free(ptr);
+    }
+    return moved;
+}
+
+int posix_memalign(void **memptr, size_t alignment, size_t size) {
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void *ptr = shimAllocate(size, alignment);
+    if (ptr == NULL) {
+        return ENOMEM;
+    }
+    *memptr = ptr;
+    return 0;
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return shimAllocate(size, alignment);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    return aligned_alloc(alignment, size);
+}
+
+void *valloc(size_t size) {
+    return shimAllocate(size, (size_t)sysconf(_SC_PAGESIZE));
+}
+
+void *pvalloc(size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return shimAllocate(roundUp(size, page), page);
+}
+
+size_t malloc_usable_size(void *ptr) {
+    return ptr == NULL ? 0 : headerOf(ptr)->capacity;
+}
+
+// ============================================================================
+// EXIT REPORT
+// ============================================================================
+
+__attribute__((destructor))
+static void reportShim(void) {
+    if (shimCounters) {
+        countersDump(countersPath);
+    }
+    if (!shimStats) {
+        return;
+    }
+
+    char line[512];
+    int length = snprintf(line, sizeof(line),
+        "[mm shim] %s%s: %llu malloc, %llu free, %llu realloc, "
+        "%llu mmap fallbacks, arena peak %llu KB, in use at exit %llu KB\n",
+        strategyNames[shimStrategy], shimStrategy == SHIM_BITMAP ? "" : " fit",
+        (unsigned long long)mallocCount, (unsigned long long)freeCount,
+        (unsigned long long)reallocCount, (unsigned long long)fallbackCount,
+        (unsigned long long)(arenaPeak >> 10), (unsigned long long)(arenaInUse >> 10));
+    if (length > 0) {
+        write(STDERR_FILENO, line, (size_t)length < sizeof(line) ? (size_t)length : sizeof(line) - 1);
+    }
+}
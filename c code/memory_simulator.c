@@ -15,7 +15,9 @@
 // ============================================================================
 
 #define TOTAL_MEMORY 1024  // Total memory in KB
-#define MAX_PROCESS_ID 10  // Max characters in process ID
+
+#include "event_log.h"
+#include "process_table.h"
 
 // ============================================================================
 // MEMORY BLOCK STRUCTURE
@@ -25,7 +27,7 @@
 typedef struct MemoryBlock {
     int size;                          // Size of block in KB
     int isFree;                        // 1 = free, 0 = allocated
-    char processId[MAX_PROCESS_ID];   // Process ID (empty if free)
+    ProcessHandle owner;               // Owner (NO_PROCESS if free)
     struct MemoryBlock *next;          // Pointer to next block (linked list)
 } MemoryBlock;
 
@@ -53,10 +55,10 @@ void initializeMemory() {
     memoryHead = (MemoryBlock *)malloc(sizeof(MemoryBlock));
     memoryHead->size = TOTAL_MEMORY;
     memoryHead->isFree = 1;
-    strcpy(memoryHead->processId, "");
+    memoryHead->owner = NO_PROCESS;
     memoryHead->next = NULL;
 
-    printf("✓ Memory initialized: %d KB free\n\n", TOTAL_MEMORY);
+    LOG_SUMMARY("✓ Memory initialized: %d KB free\n\n", TOTAL_MEMORY);
 }
 
 /**
@@ -64,6 +66,8 @@ void initializeMemory() {
  * Shows each block with its size, status (FREE/allocated), and process ID
  */
 void displayMemoryLayout() {
+    if (logLevel < LOG_SUMMARY) return;
+
     printf("\n========== MEMORY LAYOUT ==========\n");
     printf("%-8s %-15s %-12s %-15s\n", "Block#", "Size (KB)", "Status", "Process ID");
     printf("-------------------------------------\n");
@@ -76,7 +80,7 @@ void displayMemoryLayout() {
                blockNum,
                current->size,
                current->isFree ? "FREE" : "ALLOCATED",
-               current->isFree ? "---" : current->processId);
+               processName(current->owner));
         current = current->next;
         blockNum++;
     }
@@ -88,6 +92,8 @@ void displayMemoryLayout() {
  * Includes: used memory, free memory, processes, fragmentation
  */
 void displayStatistics() {
+    if (logLevel < LOG_SUMMARY) return;
+
     int usedMemory = 0;
     int freeMemory = 0;
     int activeProcesses = 0;
@@ -142,26 +148,37 @@ void displayStatistics() {
  * 
  * @param processId: ID of process to allocate
  * @param requiredSize: Memory size needed in KB
- * @return: 1 if successful, 0 if failed
+ * @return: handle of the process, or NO_PROCESS if failed
  */
-int allocateFirstFit(char *processId, int requiredSize) {
+ProcessHandle allocateFirstFit(const char *processId, int requiredSize) {
     // Validation
     if (requiredSize <= 0 || requiredSize > TOTAL_MEMORY) {
-        printf("✗ Invalid size: %d KB\n", requiredSize);
-        return 0;
+        LOG_OP("✗ Invalid size: %d KB\n", requiredSize);
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_FIRST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
+    }
+
+    // Name → handle once; everything below compares integers
+    ProcessHandle process = internProcess(processId);
+    if (process == NO_PROCESS) {
+        LOG_OP("✗ Process table full\n");
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_FIRST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
     }
 
     // Check if process already exists
     MemoryBlock *current = memoryHead;
     while (current != NULL) {
-        if (!current->isFree && strcmp(current->processId, processId) == 0) {
-            printf("✗ Process %s already allocated\n", processId);
-            return 0;
+        if (!current->isFree && current->owner == process) {
+            LOG_OP("✗ Process %s already allocated\n", processId);
+            logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_FIRST_FIT, processId, requiredSize, -1);
+            return NO_PROCESS;
         }
         current = current->next;
     }
 
     // First Fit: Find first free block that fits
+    int blockIndex = 0;
     current = memoryHead;
     while (current != NULL) {
         if (current->isFree && current->size >= requiredSize) {
@@ -172,30 +189,33 @@ int allocateFirstFit(char *processId, int requiredSize) {
                 MemoryBlock *newBlock = (MemoryBlock *)malloc(sizeof(MemoryBlock));
                 newBlock->size = current->size - requiredSize;
                 newBlock->isFree = 1;
-                strcpy(newBlock->processId, "");
+                newBlock->owner = NO_PROCESS;
                 newBlock->next = current->next;
 
                 // Update current block (now allocated)
                 current->size = requiredSize;
                 current->isFree = 0;
-                strcpy(current->processId, processId);
+                current->owner = process;
                 current->next = newBlock;
             } else {
                 // Exact fit: just allocate
                 current->isFree = 0;
-                strcpy(current->processId, processId);
+                current->owner = process;
             }
 
-            printf("✓ [First Fit] Allocated %d KB to %s\n", requiredSize, processId);
-            return 1;
+            LOG_OP("✓ [First Fit] Allocated %d KB to %s\n", requiredSize, processId);
+            logEvent(EVENT_ALLOCATE, STRATEGY_FIRST_FIT, processId, requiredSize, blockIndex);
+            return process;
         }
         current = current->next;
+        blockIndex++;
     }
 
     // No suitable block found
-    printf("✗ [First Fit] Cannot allocate %d KB to %s (not enough contiguous memory)\n",
+    LOG_OP("✗ [First Fit] Cannot allocate %d KB to %s (not enough contiguous memory)\n",
            requiredSize, processId);
-    return 0;
+    logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_FIRST_FIT, processId, requiredSize, -1);
+    return NO_PROCESS;
 }
 
 /**
@@ -209,21 +229,31 @@ int allocateFirstFit(char *processId, int requiredSize) {
  * 
  * @param processId: ID of process to allocate
  * @param requiredSize: Memory size needed in KB
- * @return: 1 if successful, 0 if failed
+ * @return: handle of the process, or NO_PROCESS if failed
  */
-int allocateBestFit(char *processId, int requiredSize) {
+ProcessHandle allocateBestFit(const char *processId, int requiredSize) {
     // Validation
     if (requiredSize <= 0 || requiredSize > TOTAL_MEMORY) {
-        printf("✗ Invalid size: %d KB\n", requiredSize);
-        return 0;
+        LOG_OP("✗ Invalid size: %d KB\n", requiredSize);
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_BEST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
+    }
+
+    // Name → handle once; everything below compares integers
+    ProcessHandle process = internProcess(processId);
+    if (process == NO_PROCESS) {
+        LOG_OP("✗ Process table full\n");
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_BEST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
     }
 
     // Check if process already exists
     MemoryBlock *current = memoryHead;
     while (current != NULL) {
-        if (!current->isFree && strcmp(current->processId, processId) == 0) {
-            printf("✗ Process %s already allocated\n", processId);
-            return 0;
+        if (!current->isFree && current->owner == process) {
+            LOG_OP("✗ Process %s already allocated\n", processId);
+            logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_BEST_FIT, processId, requiredSize, -1);
+            return NO_PROCESS;
         }
         current = current->next;
     }
@@ -231,20 +261,25 @@ int allocateBestFit(char *processId, int requiredSize) {
     // Best Fit: Find the smallest free block that fits
     MemoryBlock *bestBlock = NULL;
     int bestSize = INT_MAX;
+    int bestIndex = -1;
+    int blockIndex = 0;
 
     current = memoryHead;
     while (current != NULL) {
         if (current->isFree && current->size >= requiredSize && current->size < bestSize) {
             bestBlock = current;
             bestSize = current->size;
+            bestIndex = blockIndex;
         }
         current = current->next;
+        blockIndex++;
     }
 
     if (bestBlock == NULL) {
-        printf("✗ [Best Fit] Cannot allocate %d KB to %s (not enough contiguous memory)\n",
+        LOG_OP("✗ [Best Fit] Cannot allocate %d KB to %s (not enough contiguous memory)\n",
                requiredSize, processId);
-        return 0;
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_BEST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
     }
 
     // Allocate to best fit block
@@ -253,21 +288,22 @@ int allocateBestFit(char *processId, int requiredSize) {
         MemoryBlock *newBlock = (MemoryBlock *)malloc(sizeof(MemoryBlock));
         newBlock->size = bestBlock->size - requiredSize;
         newBlock->isFree = 1;
-        strcpy(newBlock->processId, "");
+        newBlock->owner = NO_PROCESS;
         newBlock->next = bestBlock->next;
 
         bestBlock->size = requiredSize;
         bestBlock->isFree = 0;
-        strcpy(bestBlock->processId, processId);
+        bestBlock->owner = process;
         bestBlock->next = newBlock;
     } else {
         // Exact fit
         bestBlock->isFree = 0;
-        strcpy(bestBlock->processId, processId);
+        bestBlock->owner = process;
     }
 
-    printf("✓ [Best Fit] Allocated %d KB to %s\n", requiredSize, processId);
-    return 1;
+    LOG_OP("✓ [Best Fit] Allocated %d KB to %s\n", requiredSize, processId);
+    logEvent(EVENT_ALLOCATE, STRATEGY_BEST_FIT, processId, requiredSize, bestIndex);
+    return process;
 }
 
 // ============================================================================
@@ -278,24 +314,28 @@ int allocateBestFit(char *processId, int requiredSize) {
  * DEALLOCATE MEMORY
  * Finds the process by ID and marks its block as free
  * 
- * @param processId: ID of process to deallocate
+ * @param process: handle returned by the allocate call
  * @return: 1 if successful, 0 if process not found
  */
-int deallocateMemory(char *processId) {
+int deallocateMemory(ProcessHandle process) {
     MemoryBlock *current = memoryHead;
+    int blockIndex = 0;
 
     while (current != NULL) {
-        if (!current->isFree && strcmp(current->processId, processId) == 0) {
+        if (!current->isFree && current->owner == process) {
             // Found the process: free it
             current->isFree = 1;
-            strcpy(current->processId, "");
-            printf("✓ Deallocated process %s\n", processId);
+            current->owner = NO_PROCESS;
+            LOG_OP("✓ Deallocated process %s\n", processName(process));
+            logEvent(EVENT_DEALLOCATE, STRATEGY_NONE, processName(process), current->size, blockIndex);
             return 1;
         }
         current = current->next;
+        blockIndex++;
     }
 
-    printf("✗ Process %s not found\n", processId);
+    LOG_OP("✗ Process %s not found\n", processName(process));
+    logEvent(EVENT_DEALLOCATE_FAILED, STRATEGY_NONE, processName(process), 0, -1);
     return 0;
 }
 
@@ -309,6 +349,8 @@ int deallocateMemory(char *processId) {
  */
 void coalesceMemory() {
     MemoryBlock *current = memoryHead;
+    int merges = 0;
+    int blocksLeft = 0;
 
     while (current != NULL && current->next != NULL) {
         // If current block and next block are both free, merge them
@@ -320,13 +362,20 @@ void coalesceMemory() {
             MemoryBlock *temp = current->next;
             current->next = current->next->next;
             free(temp);
+            merges++;
 
             // Don't move to next; check if we can merge again
             // (current might now be mergeable with the new next block)
         } else {
             current = current->next;
+            blocksLeft++;
         }
     }
+    if (current != NULL) {
+        blocksLeft++;
+    }
+
+    logEvent(EVENT_COALESCE, STRATEGY_NONE, "", merges, blocksLeft);
 }
 
 // ============================================================================
@@ -352,6 +401,7 @@ void compactMemory() {
     // Step 1: Separate allocated and free blocks
     MemoryBlock *allocated = NULL;
     MemoryBlock *allocatedTail = NULL;
+    int allocatedCount = 0;
     int totalFree = 0;
 
     MemoryBlock *current = memoryHead;
@@ -361,8 +411,9 @@ void compactMemory() {
             MemoryBlock *newBlock = (MemoryBlock *)malloc(sizeof(MemoryBlock));
             newBlock->size = current->size;
             newBlock->isFree = 0;
-            strcpy(newBlock->processId, current->processId);
+            newBlock->owner = current->owner;
             newBlock->next = NULL;
+            allocatedCount++;
 
             if (allocated == NULL) {
                 allocated = newBlock;
@@ -395,7 +446,7 @@ void compactMemory() {
             MemoryBlock *freeBlock = (MemoryBlock *)malloc(sizeof(MemoryBlock));
             freeBlock->size = totalFree;
             freeBlock->isFree = 1;
-            strcpy(freeBlock->processId, "");
+            freeBlock->owner = NO_PROCESS;
             freeBlock->next = NULL;
             allocatedTail->next = freeBlock;
         }
@@ -404,103 +455,111 @@ void compactMemory() {
         memoryHead = (MemoryBlock *)malloc(sizeof(MemoryBlock));
         memoryHead->size = TOTAL_MEMORY;
         memoryHead->isFree = 1;
-        strcpy(memoryHead->processId, "");
+        memoryHead->owner = NO_PROCESS;
         memoryHead->next = NULL;
     }
 
-    printf("✓ Memory compaction complete\n");
+    LOG_OP("✓ Memory compaction complete\n");
+    logEvent(EVENT_COMPACT, STRATEGY_NONE, "", totalFree,
+             allocated != NULL ? allocatedCount + (totalFree > 0) : 1);
 }
 
 // ============================================================================
 // MAIN FUNCTION - DEMONSTRATION
 // ============================================================================
 
-int main() {
-    printf("\n");
-    printf("╔════════════════════════════════════════════════════════╗\n");
-    printf("║   MEMORY MANAGEMENT SIMULATOR - Pure C Implementation  ║\n");
-    printf("║              Total Memory: 1024 KB                     ║\n");
-    printf("╚════════════════════════════════════════════════════════╝\n");
+int main(int argc, char *argv[]) {
+    if (!parseLogOptions(argc, argv)) {
+        return 1;
+    }
+
+    LOG_SUMMARY("\n");
+    LOG_SUMMARY("╔════════════════════════════════════════════════════════╗\n");
+    LOG_SUMMARY("║   MEMORY MANAGEMENT SIMULATOR - Pure C Implementation  ║\n");
+    LOG_SUMMARY("║              Total Memory: 1024 KB                     ║\n");
+    LOG_SUMMARY("╚════════════════════════════════════════════════════════╝\n");
 
     // Initialize memory
     initializeMemory();
 
     // ========== SCENARIO 1: First Fit Allocation ==========
-    printf("\n--- SCENARIO 1: First Fit Allocation ---\n");
-    allocateFirstFit("P1", 150);
+    LOG_SUMMARY("\n--- SCENARIO 1: First Fit Allocation ---\n");
+    ProcessHandle p1 = allocateFirstFit("P1", 150);
     allocateFirstFit("P2", 200);
     allocateFirstFit("P3", 100);
     displayMemoryLayout();
     displayStatistics();
 
     // ========== SCENARIO 2: Deallocation and Coalescing ==========
-    printf("\n--- SCENARIO 2: Deallocation and Coalescing ---\n");
-    deallocateMemory("P1");
+    LOG_SUMMARY("\n--- SCENARIO 2: Deallocation and Coalescing ---\n");
+    deallocateMemory(p1);
     coalesceMemory();
-    printf("(Adjacent free blocks merged)\n");
+    LOG_SUMMARY("(Adjacent free blocks merged)\n");
     displayMemoryLayout();
     displayStatistics();
 
     // ========== SCENARIO 3: Reset and Best Fit Comparison ==========
-    printf("\n--- SCENARIO 3: Best Fit Allocation (Fresh Memory) ---\n");
+    LOG_SUMMARY("\n--- SCENARIO 3: Best Fit Allocation (Fresh Memory) ---\n");
     initializeMemory();
     allocateBestFit("P4", 150);
-    allocateBestFit("P5", 200);
+    ProcessHandle p5 = allocateBestFit("P5", 200);
     allocateBestFit("P6", 100);
     displayMemoryLayout();
     displayStatistics();
 
     // ========== SCENARIO 4: Show fragmentation ==========
-    printf("\n--- SCENARIO 4: Demonstrating External Fragmentation ---\n");
-    deallocateMemory("P5");
+    LOG_SUMMARY("\n--- SCENARIO 4: Demonstrating External Fragmentation ---\n");
+    deallocateMemory(p5);
     coalesceMemory();
-    printf("(After deallocating P5)\n");
+    LOG_SUMMARY("(After deallocating P5)\n");
     displayMemoryLayout();
     displayStatistics();
 
-    printf("\nNotice: External Fragmentation exists even though\n");
-    printf("        total free memory might seem sufficient.\n");
-    printf("        This is because free memory is split into multiple blocks.\n");
+    LOG_SUMMARY("\nNotice: External Fragmentation exists even though\n");
+    LOG_SUMMARY("        total free memory might seem sufficient.\n");
+    LOG_SUMMARY("        This is because free memory is split into multiple blocks.\n");
 
     // ========== SCENARIO 5: Memory Compaction ==========
-    printf("\n--- SCENARIO 5: Memory Compaction ---\n");
+    LOG_SUMMARY("\n--- SCENARIO 5: Memory Compaction ---\n");
     compactMemory();
-    printf("(All allocated blocks moved to front, free space consolidated at end)\n");
+    LOG_SUMMARY("(All allocated blocks moved to front, free space consolidated at end)\n");
     displayMemoryLayout();
     displayStatistics();
 
-    printf("\nNote: External Fragmentation is now ZERO because all\n");
-    printf("      free memory is in a single contiguous block.\n");
+    LOG_SUMMARY("\nNote: External Fragmentation is now ZERO because all\n");
+    LOG_SUMMARY("      free memory is in a single contiguous block.\n");
 
     // ========== SCENARIO 6: Demonstrating Allocation Failure ==========
-    printf("\n--- SCENARIO 6: Allocation Failure ---\n");
+    LOG_SUMMARY("\n--- SCENARIO 6: Allocation Failure ---\n");
     initializeMemory();
-    printf("Trying to allocate 2000 KB (larger than total memory)...\n");
+    LOG_SUMMARY("Trying to allocate 2000 KB (larger than total memory)...\n");
     allocateFirstFit("P_HUGE", 2000);
 
-    printf("\nTrying to allocate 1025 KB (larger than total memory)...\n");
+    LOG_SUMMARY("\nTrying to allocate 1025 KB (larger than total memory)...\n");
     allocateFirstFit("P_LARGE", 1025);
 
-    printf("\nTrying to allocate 100 KB (with sufficient total free memory)...\n");
+    LOG_SUMMARY("\nTrying to allocate 100 KB (with sufficient total free memory)...\n");
     allocateFirstFit("P7", 400);
-    allocateFirstFit("P8", 300);
+    ProcessHandle p8 = allocateFirstFit("P8", 300);
     allocateFirstFit("P9", 300);
-    deallocateMemory("P8");
-    printf("Now trying to allocate 350 KB (fragmentation prevents it)...\n");
+    deallocateMemory(p8);
+    LOG_SUMMARY("Now trying to allocate 350 KB (fragmentation prevents it)...\n");
     allocateFirstFit("P10", 350);
     displayMemoryLayout();
     displayStatistics();
 
-    printf("\nCompacting memory...\n");
+    LOG_SUMMARY("\nCompacting memory...\n");
     compactMemory();
-    printf("Now the same 350 KB allocation succeeds:\n");
+    LOG_SUMMARY("Now the same 350 KB allocation succeeds:\n");
     allocateFirstFit("P10", 350);
     displayMemoryLayout();
     displayStatistics();
 
-    printf("\n╔════════════════════════════════════════════════════════╗\n");
-    printf("║                    Simulation Complete                 ║\n");
-    printf("╚════════════════════════════════════════════════════════╝\n\n");
+    LOG_SUMMARY("\n╔════════════════════════════════════════════════════════╗\n");
+    LOG_SUMMARY("║                    Simulation Complete                 ║\n");
+    LOG_SUMMARY("╚════════════════════════════════════════════════════════╝\n\n");
 
+    displayEventSummary();
+    eventLogClose();
     return 0;
 }
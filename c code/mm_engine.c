@@ -0,0 +1,1096 @@
+// ============================================================================
+// MEMORY ENGINE - Shared Allocator Core (see mm_engine.h)
+// ============================================================================
+// Array-based, like first_fit.c / best_fit.c / worst_fit.c / next_fit.c:
+// blocks are stored in address order and splitting shifts the tail right
+// by one. Coalescing and compaction rewrite the arrays in a single pass.
+//
+// Layout is a structure of arrays. blockFreeSize[i] is the block's size
+// when it is free and 0 when it is allocated, so "free and large enough"
+// is a single compare and the scans below vectorize cleanly. Free blocks
+// therefore always have a size > 0.
+//
+// All mutable state lives in one EngineState per region (ENGINE_MAX_REGIONS,
+// default 1), reached through `engine`.
+//
+// No libc calls: this file must build with -nostdlib for WebAssembly.
+// ============================================================================
+
+#include "mm_engine.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#define ENGINE_NO_FIT INT64_MAX  // Larger than any block size
+
+// One engine's state. Every region (engineSelectRegion) is one of these;
+// all functions work on the current one, `engine`.
+typedef struct {
+    // Block arrays (index = position in address order). Owners are stored
+    // 64-bit wide so the same kernels can scan them. This is the order the
+    // linker gave them as separate globals; the reverse costs the
+    // coalescing pass about 20%.
+    int blockAllocatedBy[ENGINE_MAX_BLOCKS];
+    int64_t blockOwner[ENGINE_MAX_BLOCKS] __attribute__((aligned(32)));
+    int64_t blockFreeSize[ENGINE_MAX_BLOCKS] __attribute__((aligned(32)));
+    EngineSize blockSize[ENGINE_MAX_BLOCKS] __attribute__((aligned(32)));
+    EngineSize blockStart[ENGINE_MAX_BLOCKS];
+    int blockCount;
+    EngineSize totalMemory;
+    int nextFitPointer;
+    int freeBlockCount;  // Blocks with blockFreeSize > 0, kept up to date
+
+    // Coalescing policy (engineSetCoalescePolicy) and its counters
+    int coalescePolicy;
+    int coalesceThreshold;
+    int freesSinceCoalesce;
+    int freeBlocksAfterCoalesce;  // freeBlockCount at the end of the last pass
+    int coalescePasses;
+    int coalesceMerges;
+    uint64_t coalesceScanned;
+    int coalesceRescues;
+
+    // Fast bins (engineSetFastBins): bin b holds the start addresses of freed
+    // blocks of exactly (b + 1) * fastBinGranule bytes, most recent on top
+    EngineSize fastBinGranule;
+    int fastBinShift;          // log2(fastBinGranule) if a power of two, else -1
+    int fastBinCount;          // 0 = fast bins off
+    int fastBinInterval;       // Consolidate every N binned frees (0 = never)
+    EngineSize fastBin[ENGINE_FAST_BINS][ENGINE_FAST_BIN_DEPTH];
+    int fastBinTop[ENGINE_FAST_BINS];
+    int fastBinFreesSinceConsolidate;
+    EngineSize fastBinBytes;
+    int fastBinHits;
+    int fastBinMisses;
+    int fastBinConsolidations;
+
+#if ENGINE_COUNTERS
+    EngineCounters counters;  // Hot-path counters (engineReadCounters)
+#endif
+
+    // Results of the last engineUpdateStats() call
+    EngineSize statUsed;
+    EngineSize statFree;
+    int statActive;
+    EngineSize statLargestFree;
+} EngineState;
+
+// Zero is the initial state of every field (COALESCE_MANUAL, no fast bins).
+// With one region `engine` is a constant address, so the default build
+// accesses its state exactly as it would plain globals.
+static EngineState regions[ENGINE_MAX_REGIONS];
+#if ENGINE_MAX_REGIONS > 1
+static EngineState *engine = &regions[0];
+static int currentRegion = 0;
+#else
+#define engine (&regions[0])
+#endif
+
+#if ENGINE_COUNTERS
+#define COUNT(field, n) (engine->counters.field += (uint64_t)(n))
+#else
+#define COUNT(field, n) ((void)0)
+#endif
+
+// ============================================================================
+// SCAN KERNELS (over blockFreeSize / blockOwner)
+// ============================================================================
+// One set of kernels written against a few vector macros over signed 64-bit
+// lanes; the macros map to AVX2 (4 lanes), SSE4.2 (2 lanes) or nothing
+// (scalar loops only). Neither has a 64-bit min/max, so those are
+// compare + blend.
+
+#if defined(__AVX2__)
+typedef __m256i VecI64;
+#define VEC_LANES 4
+#define VEC_KERNEL "avx2"
+#define vecLoad(p) _mm256_load_si256((const __m256i *)(p))
+#define vecSet(x) _mm256_set1_epi64x(x)
+#define vecGreater(a, b) _mm256_cmpgt_epi64(a, b)
+#define vecEqual(a, b) _mm256_cmpeq_epi64(a, b)
+#define vecMask(m) _mm256_movemask_pd(_mm256_castsi256_pd(m))
+#define vecAdd(a, b) _mm256_add_epi64(a, b)
+#define vecSub(a, b) _mm256_sub_epi64(a, b)
+#define vecSelect(m, a, b) _mm256_blendv_epi8(b, a, m)
+#define vecStore(p, v) _mm256_storeu_si256((__m256i *)(p), v)
+#elif defined(__SSE4_2__)
+typedef __m128i VecI64;
+#define VEC_LANES 2
+#define VEC_KERNEL "sse4.2"
+#define vecLoad(p) _mm_load_si128((const __m128i *)(p))
+#define vecSet(x) _mm_set1_epi64x(x)
+#define vecGreater(a, b) _mm_cmpgt_epi64(a, b)
+#define vecEqual(a, b) _mm_cmpeq_epi64(a, b)
+#define vecMask(m) _mm_movemask_pd(_mm_castsi128_pd(m))
+#define vecAdd(a, b) _mm_add_epi64(a, b)
+#define vecSub(a, b) _mm_sub_epi64(a, b)
+#define vecSelect(m, a, b) _mm_blendv_epi8(b, a, m)
+#define vecStore(p, v) _mm_storeu_si128((__m128i *)(p), v)
+#else
+#define VEC_KERNEL "scalar"
+#endif
+
+#ifdef VEC_LANES
+#define vecMin(a, b) vecSelect(vecGreater(a, b), b, a)
+#define vecMax(a, b) vecSelect(vecGreater(a, b), a, b)
+#endif
+
+/**
+ * First index in [from, to) whose free size is >= value (value >= 1)
+ * @return: block index, or -1 if none
+ */
+static int scanAtLeast(int from, int to, int64_t value) {
+    int i = from;
+
+#ifdef VEC_LANES
+    // Scalar head up to an aligned vector boundary
+    for (; i < to && i % VEC_LANES != 0; i++) {
+        if (engine->blockFreeSize[i] >= value) return i;
+    }
+
+    VecI64 threshold = vecSet(value - 1);
+    for (; i + VEC_LANES <= to; i += VEC_LANES) {
+        int mask = vecMask(vecGreater(vecLoad(&engine->blockFreeSize[i]), threshold));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+#endif
+
+    for (; i < to; i++) {
+        if (engine->blockFreeSize[i] >= value) return i;
+    }
+    return -1;
+}
+
+/**
+ * First index whose entry in a block array (blockFreeSize or blockOwner)
+ * equals value exactly
+ * @return: block index, or -1 if none
+ */
+static int scanEqual(const int64_t *values, int64_t value) {
+    int i = 0;
+
+#ifdef VEC_LANES
+    VecI64 target = vecSet(value);
+    for (; i + VEC_LANES <= engine->blockCount; i += VEC_LANES) {
+        int mask = vecMask(vecEqual(vecLoad(&values[i]), target));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+#endif
+
+    for (; i < engine->blockCount; i++) {
+        if (values[i] == value) return i;
+    }
+    return -1;
+}
+
+/**
+ * Smallest free size that is >= value
+ * @return: that size, or ENGINE_NO_FIT if nothing fits
+ */
+static int64_t reduceMinAtLeast(int64_t value) {
+    int64_t best = ENGINE_NO_FIT;
+    int i = 0;
+
+#ifdef VEC_LANES
+    VecI64 threshold = vecSet(value - 1);
+    VecI64 noFit = vecSet(ENGINE_NO_FIT);
+    VecI64 minimum = noFit;
+    for (; i + VEC_LANES <= engine->blockCount; i += VEC_LANES) {
+        VecI64 sizes = vecLoad(&engine->blockFreeSize[i]);
+        VecI64 fits = vecGreater(sizes, threshold);
+        minimum = vecMin(minimum, vecSelect(fits, sizes, noFit));
+    }
+
+    int64_t lanes[VEC_LANES];
+    vecStore(lanes, minimum);
+    for (int k = 0; k < VEC_LANES; k++) {
+        if (lanes[k] < best) best = lanes[k];
+    }
+#endif
+
+    for (; i < engine->blockCount; i++) {
+        if (engine->blockFreeSize[i] >= value && engine->blockFreeSize[i] < best) {
+            best = engine->blockFreeSize[i];
+        }
+    }
+    return best;
+}
+
+/**
+ * Sum of free sizes, largest free size, free block count
+ * (used = totalMemory - free: blocks always tile the whole heap)
+ */
+static void reduceStats(int64_t *freeSum, int64_t *largestFree, int *freeCount) {
+    int64_t free = 0, largest = 0;
+    int count = 0;
+    int i = 0;
+
+#ifdef VEC_LANES
+    VecI64 zero = vecSet(0);
+    VecI64 freeAcc = zero, maxAcc = zero, countAcc = zero;
+    for (; i + VEC_LANES <= engine->blockCount; i += VEC_LANES) {
+        VecI64 freeSizes = vecLoad(&engine->blockFreeSize[i]);
+        freeAcc = vecAdd(freeAcc, freeSizes);
+        maxAcc = vecMax(maxAcc, freeSizes);
+        countAcc = vecSub(countAcc, vecGreater(freeSizes, zero));  // -1 per free lane
+    }
+
+    int64_t lanes[3][VEC_LANES];
+    vecStore(lanes[0], freeAcc);
+    vecStore(lanes[1], maxAcc);
+    vecStore(lanes[2], countAcc);
+    for (int k = 0; k < VEC_LANES; k++) {
+        free += lanes[0][k];
+        if (lanes[1][k] > largest) largest = lanes[1][k];
+        count += (int)lanes[2][k];
+    }
+#endif
+
+    for (; i < engine->blockCount; i++) {
+        free += engine->blockFreeSize[i];
+        if (engine->blockFreeSize[i] > largest) largest = engine->blockFreeSize[i];
+        if (engine->blockFreeSize[i] > 0) count++;
+    }
+
+    *freeSum = free;
+    *largestFree = largest;
+    *freeCount = count;
+}
+
+const char *engineScanKernel(void) { return VEC_KERNEL; }
+
+// ============================================================================
+// BLOCK HELPERS
+// ============================================================================
+
+static void setBlock(int index, EngineSize start, EngineSize size,
+                     int isFree, int owner, int allocatedBy) {
+    engine->blockStart[index] = start;
+    engine->blockSize[index] = size;
+    engine->blockFreeSize[index] = isFree ? (int64_t)size : 0;
+    engine->blockOwner[index] = isFree ? ENGINE_NO_OWNER : owner;
+    engine->blockAllocatedBy[index] = isFree ? FIT_NONE : allocatedBy;
+}
+
+static void copyBlock(int to, int from) {
+    engine->blockStart[to] = engine->blockStart[from];
+    engine->blockSize[to] = engine->blockSize[from];
+    engine->blockFreeSize[to] = engine->blockFreeSize[from];
+    engine->blockOwner[to] = engine->blockOwner[from];
+    engine->blockAllocatedBy[to] = engine->blockAllocatedBy[from];
+}
+
+/**
+ * Move blocks index .. blockCount-1 up by one slot. One pass per array
+ * (not copyBlock per block), so each pass is a straight vectorisable copy:
+ * this shift is the main cost of a split once the heap holds thousands of
+ * blocks.
+ */
+static void shiftBlocksUp(int index) {
+    for (int j = engine->blockCount; j > index; j--) engine->blockStart[j] = engine->blockStart[j - 1];
+    for (int j = engine->blockCount; j > index; j--) engine->blockSize[j] = engine->blockSize[j - 1];
+    for (int j = engine->blockCount; j > index; j--) engine->blockFreeSize[j] = engine->blockFreeSize[j - 1];
+    for (int j = engine->blockCount; j > index; j--) engine->blockOwner[j] = engine->blockOwner[j - 1];
+    for (int j = engine->blockCount; j > index; j--) engine->blockAllocatedBy[j] = engine->blockAllocatedBy[j - 1];
+}
+
+// ============================================================================
+// REGIONS
+// ============================================================================
+
+/**
+ * Make region the one every other function acts on
+ * @return: 1 if successful, 0 if there is no such region
+ */
+int engineSelectRegion(int region) {
+    if (region < 0 || region >= ENGINE_MAX_REGIONS) {
+        return 0;
+    }
+#if ENGINE_MAX_REGIONS > 1
+    engine = &regions[region];
+    currentRegion = region;
+#endif
+    return 1;
+}
+
+int engineCurrentRegion(void) {
+#if ENGINE_MAX_REGIONS > 1
+    return currentRegion;
+#else
+    return 0;
+#endif
+}
+
+int engineRegionCount(void) { return ENGINE_MAX_REGIONS; }
+
+// ============================================================================
+// STATE / SETUP
+// ============================================================================
+
+/**
+ * Initialize memory as one large free block
+ */
+void engineInit(EngineSize total) {
+    engineResetCounters();
+    engineClear(total);
+    engineAppendBlock(total, 1, ENGINE_NO_OWNER, FIT_NONE);
+}
+
+/**
+ * Remove all blocks (used before loading a layout with engineAppendBlock)
+ */
+void engineClear(EngineSize total) {
+    engine->totalMemory = total;
+    engine->blockCount = 0;
+    engine->nextFitPointer = 0;
+    engine->freeBlockCount = 0;
+    engine->freesSinceCoalesce = 0;
+    engine->freeBlocksAfterCoalesce = 0;
+    for (int b = 0; b < ENGINE_FAST_BINS; b++) {
+        engine->fastBinTop[b] = 0;
+    }
+    engine->fastBinBytes = 0;
+    engine->fastBinFreesSinceConsolidate = 0;
+}
+
+/**
+ * Append a block to the end of the layout (it starts where the last ends)
+ * @return: 1 if successful, 0 if the block array is full
+ */
+int engineAppendBlock(EngineSize size, int isFree, int owner, int allocatedBy) {
+    if (engine->blockCount >= ENGINE_MAX_BLOCKS) {
+        return 0;
+    }
+    EngineSize start = engine->blockCount > 0
+        ? engine->blockStart[engine->blockCount - 1] + engine->blockSize[engine->blockCount - 1] : 0;
+    setBlock(engine->blockCount, start, size, isFree, owner, allocatedBy);
+    engine->freeBlockCount += engine->blockFreeSize[engine->blockCount] > 0;
+    engine->blockCount++;
+    return 1;
+}
+
+// ============================================================================
+// FAST BINS
+// ============================================================================
+// dlmalloc-style quick lists. A freed block whose size is an exact bin size
+// keeps looking allocated to the rest of the engine (blockFreeSize 0, owner
+// ENGINE_FAST_BIN_OWNER), so it is neither merged nor found by the fit
+// scans; its address goes on the bin's LIFO stack and the next request of
+// that size takes it back in O(log n) (address lookup) with no scan or
+// split. Consolidation returns every binned block to the free list and
+// runs one coalescing pass.
+
+/**
+ * Bin for a block size
+ * @return: bin index, or -1 if the size has no bin
+ */
+static int fastBinFor(EngineSize size) {
+    if (engine->fastBinCount == 0) {
+        return -1;
+    }
+
+    // Power-of-two granules (the usual case) need no 64-bit division
+    EngineSize bin;
+    if (engine->fastBinShift >= 0) {
+        if (size & (engine->fastBinGranule - 1)) {
+            return -1;
+        }
+        bin = (size >> engine->fastBinShift) - 1;
+    } else {
+        if (size % engine->fastBinGranule != 0) {
+            return -1;
+        }
+        bin = size / engine->fastBinGranule - 1;
+    }
+    return bin < (EngineSize)engine->fastBinCount ? (int)bin : -1;
+}
+
+/**
+ * Mark every binned block free and empty the bins (no merging)
+ * @return: number of blocks released
+ */
+static int flushFastBins(void) {
+    int released = 0;
+    for (int b = 0; b < ENGINE_FAST_BINS; b++) {
+        while (engine->fastBinTop[b] > 0) {
+            int i = engineBlockAt(engine->fastBin[b][--engine->fastBinTop[b]]);
+            setBlock(i, engine->blockStart[i], engine->blockSize[i], 1, ENGINE_NO_OWNER, FIT_NONE);
+            engine->freeBlockCount++;
+            released++;
+        }
+    }
+    engine->fastBinBytes = 0;
+    engine->fastBinFreesSinceConsolidate = 0;
+    return released;
+}
+
+/**
+ * Turn fast bins on for sizes granule, 2 * granule, ... bins * granule
+ * bytes (bins = 0 turns them off). interval > 0 consolidates every
+ * `interval` binned frees; a failed allocation always consolidates.
+ * Any blocks already binned are released first.
+ */
+void engineSetFastBins(EngineSize granule, int bins, int interval) {
+    engineConsolidateFastBins();
+    engine->fastBinGranule = granule;
+    engine->fastBinShift = (granule != 0 && (granule & (granule - 1)) == 0) ? __builtin_ctzll(granule) : -1;
+    engine->fastBinCount = (granule == 0 || bins <= 0) ? 0
+                 : (bins < ENGINE_FAST_BINS ? bins : ENGINE_FAST_BINS);
+    engine->fastBinInterval = interval > 0 ? interval : 0;
+    engine->fastBinHits = 0;
+    engine->fastBinMisses = 0;
+    engine->fastBinConsolidations = 0;
+}
+
+/**
+ * Release all binned blocks and merge them with their free neighbours
+ * @return: number of blocks released
+ */
+int engineConsolidateFastBins(void) {
+    int released = flushFastBins();
+    if (released > 0) {
+        engine->fastBinConsolidations++;
+        engineCoalesce();
+    }
+    return released;
+}
+
+/**
+ * Serve a request from its fast bin
+ * @return: block index, or -1 on a miss (or if the size has no bin)
+ */
+static int fastBinAllocate(int strategy, int owner, EngineSize requiredSize) {
+    int b = fastBinFor(requiredSize);
+    if (b == -1) {
+        return -1;
+    }
+    if (engine->fastBinTop[b] == 0) {
+        engine->fastBinMisses++;
+        return -1;
+    }
+
+    int i = engineBlockAt(engine->fastBin[b][--engine->fastBinTop[b]]);
+    setBlock(i, engine->blockStart[i], engine->blockSize[i], 0, owner, strategy);
+    engine->fastBinBytes -= engine->blockSize[i];
+    engine->fastBinHits++;
+    COUNT(fastBinHits, 1);
+    COUNT(allocations, 1);
+    return i;
+}
+
+/**
+ * Put the allocated block at index into its fast bin instead of freeing it
+ * @return: 1 if binned, 0 if its size has no bin or the bin is full
+ */
+static int fastBinFree(int i) {
+    int b = fastBinFor(engine->blockSize[i]);
+    if (b == -1 || engine->fastBinTop[b] == ENGINE_FAST_BIN_DEPTH) {
+        return 0;
+    }
+
+    engine->fastBin[b][engine->fastBinTop[b]++] = engine->blockStart[i];
+    setBlock(i, engine->blockStart[i], engine->blockSize[i], 0, ENGINE_FAST_BIN_OWNER, FIT_NONE);
+    engine->fastBinBytes += engine->blockSize[i];
+
+    if (engine->fastBinInterval > 0 && ++engine->fastBinFreesSinceConsolidate >= engine->fastBinInterval) {
+        engineConsolidateFastBins();
+    }
+    return 1;
+}
+
+// ============================================================================
+// ALLOCATION ALGORITHMS
+// ============================================================================
+// The strategies differ only in how a fit is searched for. The search and
+// everything that calls it in a loop are written once as always-inline
+// bodies taking the search as a parameter; each public entry point
+// switches on the strategy once and calls the body with a literal, so
+// every strategy gets its own copy with the other cases folded away and
+// no per-search dispatch (the C form of a template on the strategy).
+
+#define ENGINE_INLINE static inline __attribute__((always_inline))
+
+// result = body(search, ...) with search a compile-time FIT_* constant
+#define WITH_SEARCH(strategy, result, body, ...)                        \
+    switch (strategy) {                                                 \
+        case FIT_NEXT:  result = body(FIT_NEXT, __VA_ARGS__); break;    \
+        case FIT_BEST:  result = body(FIT_BEST, __VA_ARGS__); break;    \
+        case FIT_WORST: result = body(FIT_WORST, __VA_ARGS__); break;   \
+        default:        result = body(FIT_FIRST, __VA_ARGS__); break;   \
+    }
+
+ENGINE_INLINE int findBlockWith(int search, EngineSize requiredSize) {
+    if (requiredSize == 0 || requiredSize > engine->totalMemory) {
+        return -1;
+    }
+    int64_t size = (int64_t)requiredSize;
+    int index;
+    COUNT(searches, 1);
+
+    // Inspected = entries up to the match (scans) or all of them (reductions)
+    switch (search) {
+        case FIT_NEXT: {
+            index = scanAtLeast(engine->nextFitPointer, engine->blockCount, size);
+            COUNT(blocksInspected, (index != -1 ? index + 1 : engine->blockCount) - engine->nextFitPointer);
+            if (index == -1) {
+                index = scanAtLeast(0, engine->nextFitPointer, size);
+                COUNT(blocksInspected, index != -1 ? index + 1 : engine->nextFitPointer);
+            }
+            return index;
+        }
+        case FIT_BEST: {
+            int64_t bestSize = reduceMinAtLeast(size);
+            index = bestSize == ENGINE_NO_FIT ? -1 : scanEqual(engine->blockFreeSize, bestSize);
+            break;
+        }
+        case FIT_WORST: {
+            int64_t freeSum, largestFree;
+            int freeCount;
+            reduceStats(&freeSum, &largestFree, &freeCount);
+            index = largestFree < size ? -1 : scanEqual(engine->blockFreeSize, largestFree);
+            break;
+        }
+        default:
+            index = scanAtLeast(0, engine->blockCount, size);
+            COUNT(blocksInspected, index != -1 ? index + 1 : engine->blockCount);
+            return index;
+    }
+    COUNT(blocksInspected, engine->blockCount + index + 1);
+    return index;
+}
+
+/**
+ * Find the block a strategy would use, without allocating it
+ *
+ * FIRST: first free block that fits, scanning from the beginning
+ * NEXT:  first free block that fits, scanning from nextFitPointer and
+ *        wrapping around to the beginning
+ * BEST:  smallest free block that fits (lowest index on ties)
+ * WORST: largest free block that fits (lowest index on ties)
+ *
+ * @return: block index, or -1 if no free block is large enough
+ */
+int engineFindBlock(int strategy, EngineSize requiredSize) {
+    int index;
+    WITH_SEARCH(strategy, index, findBlockWith, requiredSize);
+    return index;
+}
+
+/**
+ * Allocate requiredSize KB from the free block at index (split if larger)
+ * @return: 1 if successful, 0 if the block cannot hold the request or
+ *          owner is not a valid owner ID (>= 1)
+ */
+int engineAllocateAt(int index, int owner, EngineSize requiredSize, int strategy) {
+    if (owner <= ENGINE_NO_OWNER || index < 0 || index >= engine->blockCount ||
+        requiredSize == 0 || engine->blockFreeSize[index] < (int64_t)requiredSize) {
+        COUNT(failedAllocations, 1);
+        return 0;
+    }
+
+    if (engine->blockSize[index] > requiredSize) {
+        if (engine->blockCount >= ENGINE_MAX_BLOCKS) {
+            COUNT(failedAllocations, 1);
+            return 0;
+        }
+
+        // Shift blocks to make room for the leftover free block
+        shiftBlocksUp(index + 1);
+        COUNT(splits, 1);
+        COUNT(blocksShifted, engine->blockCount - (index + 1));
+        setBlock(index + 1, engine->blockStart[index] + requiredSize,
+                 engine->blockSize[index] - requiredSize, 1, ENGINE_NO_OWNER, FIT_NONE);
+        engine->blockCount++;
+    } else {
+        engine->freeBlockCount--;  // Exact fit: the hole is gone
+    }
+
+    setBlock(index, engine->blockStart[index], requiredSize, 0, owner, strategy);
+    COUNT(allocations, 1);
+
+    if (strategy == FIT_NEXT) {
+        engine->nextFitPointer = (index + 1) % engine->blockCount;
+    }
+    return 1;
+}
+
+/**
+ * engineAllocate for one search (strategy is what the block records)
+ */
+ENGINE_INLINE int allocateWith(int search, int strategy, int owner, EngineSize requiredSize) {
+    int index = fastBinAllocate(strategy, owner, requiredSize);
+    if (index != -1) {
+        return index;
+    }
+
+    index = findBlockWith(search, requiredSize);
+    if (index == -1 && engine->fastBinBytes > 0) {
+        engineConsolidateFastBins();
+        index = findBlockWith(search, requiredSize);
+    }
+    if (index == -1 && engine->coalescePolicy == COALESCE_DEFERRED &&
+        engine->freesSinceCoalesce > 0 && engineCoalesce() > 0) {
+        index = findBlockWith(search, requiredSize);
+        engine->coalesceRescues += index != -1;
+    }
+    if (index == -1) {
+        COUNT(failedAllocations, 1);
+        return -1;
+    }
+    return engineAllocateAt(index, owner, requiredSize, strategy) ? index : -1;
+}
+
+/**
+ * Find a block with the given strategy and allocate it. A matching fast
+ * bin is tried first. If nothing fits, binned blocks are consolidated
+ * (and, with COALESCE_DEFERRED, pending frees merged) before one retry.
+ * @return: index of the allocated block, or -1 if failed (or owner < 1)
+ */
+int engineAllocate(int strategy, int owner, EngineSize requiredSize) {
+    if (owner <= ENGINE_NO_OWNER) {
+        COUNT(failedAllocations, 1);
+        return -1;
+    }
+
+    int index;
+    WITH_SEARCH(strategy, index, allocateWith, strategy, owner, requiredSize);
+    return index;
+}
+
+// ============================================================================
+// BATCH ALLOCATION
+// ============================================================================
+// A batch is placed largest request first (first fit decreasing with
+// FIT_FIRST, best fit decreasing with FIT_BEST, ...). Placement only carves
+// requests off the front of the remaining space of each hole, tracked in
+// blockFreeSize, so the fit scans stay the same; the block arrays are then
+// rebuilt once, back to front, instead of shifting the tail per request.
+
+static int batchOrder[ENGINE_MAX_BLOCKS];  // Request indexes, largest first
+static int batchNext[ENGINE_MAX_BLOCKS];   // Next request carved from the same hole
+static int holeFirst[ENGINE_MAX_BLOCKS];   // First request carved from block i, or -1
+static int holeLast[ENGINE_MAX_BLOCKS];
+static int blockTarget[ENGINE_MAX_BLOCKS]; // Index of block i after the rebuild
+
+/**
+ * Whether request a is placed before request b (larger first, then in
+ * request order, so the result does not depend on the sort)
+ */
+static int batchBefore(const EngineSize *sizes, int a, int b) {
+    return sizes[a] != sizes[b] ? sizes[a] > sizes[b] : a < b;
+}
+
+static void batchSiftDown(const EngineSize *sizes, int root, int count) {
+    for (;;) {
+        int child = 2 * root + 1;
+        if (child >= count) return;
+        if (child + 1 < count &&
+            batchBefore(sizes, batchOrder[child], batchOrder[child + 1])) {
+            child++;
+        }
+        if (!batchBefore(sizes, batchOrder[root], batchOrder[child])) return;
+        int swap = batchOrder[root];
+        batchOrder[root] = batchOrder[child];
+        batchOrder[child] = swap;
+        root = child;
+    }
+}
+
+/**
+ * Heap sort of batchOrder[0..count) into placement order (no libc qsort)
+ */
+static void sortBatch(const EngineSize *sizes, int count) {
+    for (int i = 0; i < count; i++) {
+        batchOrder[i] = i;
+    }
+    for (int i = count / 2 - 1; i >= 0; i--) {
+        batchSiftDown(sizes, i, count);
+    }
+    for (int end = count - 1; end > 0; end--) {
+        int swap = batchOrder[0];
+        batchOrder[0] = batchOrder[end];
+        batchOrder[end] = swap;
+        batchSiftDown(sizes, 0, end);
+    }
+}
+
+/**
+ * Carve the sorted requests off the front of the holes the search picks
+ * (every request adds at most one block to the layout)
+ * @return: number of requests placed
+ */
+ENGINE_INLINE int placeBatchWith(int search, int count, const int *owners,
+                                 const EngineSize *sizes, int *indexes) {
+    int placed = 0;
+    for (int k = 0; k < count && engine->blockCount + placed < ENGINE_MAX_BLOCKS; k++) {
+        int r = batchOrder[k];
+        int hole = owners[r] <= ENGINE_NO_OWNER ? -1 : findBlockWith(search, sizes[r]);
+        if (hole == -1) {
+            continue;
+        }
+
+        engine->blockFreeSize[hole] -= (int64_t)sizes[r];
+        batchNext[r] = -1;
+        if (holeFirst[hole] == -1) {
+            holeFirst[hole] = r;
+        } else {
+            batchNext[holeLast[hole]] = r;
+        }
+        holeLast[hole] = r;
+        indexes[r] = hole;
+        placed++;
+    }
+    return placed;
+}
+
+/**
+ * Allocate a batch of requests together, largest first
+ *
+ * owners[r] / sizes[r] describe request r; indexes[r] receives the index of
+ * its block, or -1 if it was not placed. At most ENGINE_MAX_BLOCKS requests
+ * are considered per call; the rest are reported as not placed.
+ *
+ * @return: number of requests placed
+ */
+int engineAllocateBatch(int strategy, int count, const int *owners,
+                        const EngineSize *sizes, int *indexes) {
+    for (int r = 0; r < count; r++) {
+        indexes[r] = -1;
+    }
+    int considered = count < ENGINE_MAX_BLOCKS ? count : ENGINE_MAX_BLOCKS;
+
+    for (int i = 0; i < engine->blockCount; i++) {
+        holeFirst[i] = -1;
+    }
+
+    sortBatch(sizes, considered);
+    int placed;
+    WITH_SEARCH(strategy, placed, placeBatchWith, considered, owners, sizes, indexes);
+    COUNT(allocations, placed);
+    COUNT(failedAllocations, count - placed);
+    if (placed == 0) {
+        return 0;
+    }
+
+    // Where each old block lands once its hole's requests are inserted
+    int target = 0;
+    for (int i = 0; i < engine->blockCount; i++) {
+        blockTarget[i] = target++;
+        if (holeFirst[i] != -1) {
+            for (int r = holeFirst[i]; r != -1; r = batchNext[r]) {
+                target++;
+            }
+            if (engine->blockFreeSize[i] == 0) {
+                target--;  // Hole used up: no leftover free block
+            }
+        }
+    }
+
+    // Rebuild back to front: targets only move right, so nothing unread
+    // is overwritten
+    for (int i = engine->blockCount - 1; i >= 0; i--) {
+        int to = blockTarget[i];
+        if (holeFirst[i] == -1) {
+            if (to != i) {
+                copyBlock(to, i);
+                COUNT(blocksShifted, 1);
+            }
+            continue;
+        }
+
+        EngineSize address = engine->blockStart[i];
+        int64_t leftover = engine->blockFreeSize[i];
+        for (int r = holeFirst[i]; r != -1; r = batchNext[r]) {
+            setBlock(to, address, sizes[r], 0, owners[r], strategy);
+            indexes[r] = to++;
+            address += sizes[r];
+            COUNT(splits, batchNext[r] != -1 || leftover > 0);
+        }
+        if (leftover > 0) {
+            setBlock(to, address, (EngineSize)leftover, 1, ENGINE_NO_OWNER, FIT_NONE);
+        } else {
+            engine->freeBlockCount--;
+        }
+    }
+
+    if (engine->nextFitPointer < engine->blockCount) {
+        engine->nextFitPointer = blockTarget[engine->nextFitPointer];
+    }
+    engine->blockCount = target;
+    return placed;
+}
+
+// ============================================================================
+// DEALLOCATION, COALESCING AND COMPACTION
+// ============================================================================
+
+/**
+ * Mark the block owned by owner as free, or put it in its fast bin.
+ * Merging follows the coalescing policy: none (MANUAL), a full pass
+ * (EAGER), or a pass once frees have added more than the threshold
+ * number of free blocks (DEFERRED).
+ * @return: index of the freed block, or -1 if owner not found
+ *          (the index before any merge)
+ */
+int engineDeallocate(int owner) {
+    // Free blocks always have ENGINE_NO_OWNER, so matching the owner is enough
+    int i = owner <= ENGINE_NO_OWNER ? -1 : scanEqual(engine->blockOwner, owner);
+    return i == -1 ? -1 : engineDeallocateAt(i);
+}
+
+/**
+ * Free the allocated block at index, as engineDeallocate does (no owner
+ * scan: for callers that know where the block is, e.g. via engineBlockAt)
+ * @return: index, or -1 if that block is not allocated
+ */
+int engineDeallocateAt(int i) {
+    if (i < 0 || i >= engine->blockCount || engine->blockOwner[i] <= ENGINE_NO_OWNER) {
+        return -1;
+    }
+    COUNT(frees, 1);
+    if (fastBinFree(i)) {
+        return i;
+    }
+
+    setBlock(i, engine->blockStart[i], engine->blockSize[i], 1, ENGINE_NO_OWNER, FIT_NONE);
+    engine->freeBlockCount++;
+    engine->freesSinceCoalesce++;
+
+    if (engine->coalescePolicy == COALESCE_EAGER ||
+        (engine->coalescePolicy == COALESCE_DEFERRED &&
+         engine->freeBlockCount > engine->freeBlocksAfterCoalesce + engine->coalesceThreshold)) {
+        engineCoalesce();
+    }
+    return i;
+}
+
+/**
+ * Merge all runs of adjacent free blocks in one pass
+ * @return: number of merges performed
+ */
+int engineCoalesce(void) {
+    engine->coalescePasses++;
+    engine->coalesceScanned += (uint64_t)engine->blockCount;
+    engine->freesSinceCoalesce = 0;
+
+    int count = engine->blockCount;  // Read once: copyBlock hides that it cannot change
+    int merges = 0;
+    int write = 0;
+
+    for (int read = 0; read < count; read++) {
+        if (write > 0 && engine->blockFreeSize[read] > 0 && engine->blockFreeSize[write - 1] > 0) {
+            engine->blockSize[write - 1] += engine->blockSize[read];
+            engine->blockFreeSize[write - 1] = (int64_t)engine->blockSize[write - 1];
+            merges++;
+        } else {
+            if (write != read) {
+                copyBlock(write, read);
+            }
+            write++;
+        }
+    }
+
+    engine->blockCount = write;
+    engine->freeBlockCount -= merges;
+    engine->freeBlocksAfterCoalesce = engine->freeBlockCount;
+    engine->coalesceMerges += merges;
+    COUNT(coalescePasses, 1);
+    COUNT(merges, merges);
+    if (engine->nextFitPointer >= engine->blockCount) {
+        engine->nextFitPointer = 0;
+    }
+    return merges;
+}
+
+/**
+ * Choose when freed blocks are merged with their free neighbours
+ *
+ * COALESCE_MANUAL:   never automatically; the caller runs engineCoalesce()
+ * COALESCE_EAGER:    a full pass after every free (the demo programs' model)
+ * COALESCE_DEFERRED: a pass only when frees have added more than threshold
+ *                    free blocks since the last pass, or when an
+ *                    allocation finds no fit
+ *
+ * Deferring saves the merge-then-split work of churny workloads that free
+ * and reallocate the same sizes, at the price of more, smaller holes.
+ */
+void engineSetCoalescePolicy(int policy, int threshold) {
+    engine->coalescePolicy = policy;
+    engine->coalesceThreshold = threshold > 0 ? threshold : 0;
+}
+
+void engineResetCoalesceCounters(void) {
+    engine->coalescePasses = 0;
+    engine->coalesceMerges = 0;
+    engine->coalesceScanned = 0;
+    engine->coalesceRescues = 0;
+}
+
+/**
+ * Move allocated blocks to the front and leave one free block at the end
+ */
+void engineCompact(void) {
+    flushFastBins();  // Binned blocks are free space too
+
+    int write = 0;
+    EngineSize totalFree = 0;
+    EngineSize address = 0;
+    int count = engine->blockCount;
+
+    for (int read = 0; read < count; read++) {
+        if (engine->blockFreeSize[read] > 0) {
+            totalFree += engine->blockSize[read];
+        } else {
+            COUNT(compactionBytesMoved, engine->blockStart[read] != address ? engine->blockSize[read] : 0);
+            copyBlock(write, read);
+            engine->blockStart[write++] = address;  // Relocated
+            address += engine->blockSize[read];
+        }
+    }
+
+    engine->blockCount = write;
+    engine->freeBlockCount = 0;
+    engine->freesSinceCoalesce = 0;
+    if (totalFree > 0) {
+        engineAppendBlock(totalFree, 1, ENGINE_NO_OWNER, FIT_NONE);
+    }
+    engine->freeBlocksAfterCoalesce = engine->freeBlockCount;
+    engine->nextFitPointer = 0;
+    COUNT(compactions, 1);
+}
+
+// ============================================================================
+// INSPECTION
+// ============================================================================
+
+int engineBlockCount(void) { return engine->blockCount; }
+EngineSize engineBlockStart(int index) { return engine->blockStart[index]; }
+EngineSize engineBlockSize(int index) { return engine->blockSize[index]; }
+int engineBlockIsFree(int index) { return engine->blockFreeSize[index] > 0; }
+int engineBlockOwner(int index) { return (int)engine->blockOwner[index]; }
+int engineBlockAllocatedBy(int index) { return engine->blockAllocatedBy[index]; }
+int engineNextFitPointer(void) { return engine->nextFitPointer; }
+EngineSize engineTotalMemory(void) { return engine->totalMemory; }
+
+/**
+ * Block containing a byte address (binary search over start addresses)
+ * @return: block index, or -1 if the address is outside the heap
+ */
+int engineBlockAt(EngineSize address) {
+    int last = engine->blockCount - 1;
+    if (last < 0 || address >= engine->blockStart[last] + engine->blockSize[last]) {
+        return -1;
+    }
+
+    int low = 0;
+    int high = engine->blockCount - 1;
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (engine->blockStart[mid] <= address) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+/**
+ * Bytes in the run of adjacent free blocks around a block, merged or not
+ * (what the block would become after coalescing)
+ * @return: run size, or 0 if the block is not free
+ */
+EngineSize engineFreeRunAt(int index) {
+    if (index < 0 || index >= engine->blockCount || engine->blockFreeSize[index] == 0) {
+        return 0;
+    }
+
+    EngineSize run = engine->blockSize[index];
+    for (int i = index - 1; i >= 0 && engine->blockFreeSize[i] > 0; i--) {
+        run += engine->blockSize[i];
+    }
+    for (int i = index + 1; i < engine->blockCount && engine->blockFreeSize[i] > 0; i++) {
+        run += engine->blockSize[i];
+    }
+    return run;
+}
+
+/**
+ * Largest run of adjacent free blocks and the number of runs, i.e. the
+ * largest hole and the hole count as if everything were coalesced, so
+ * that blocks a deferred policy has not merged yet do not count as
+ * fragmentation (binned blocks are not free)
+ * @return: bytes in the largest run; *runs receives the run count
+ */
+EngineSize engineLargestFreeRun(int *runs) {
+    EngineSize largest = 0, run = 0;
+    int count = engine->blockCount;
+    *runs = 0;
+    for (int i = 0; i < count; i++) {
+        if (engine->blockFreeSize[i] > 0) {
+            *runs += run == 0;
+            run += engine->blockSize[i];
+            if (run > largest) largest = run;
+        } else {
+            run = 0;
+        }
+    }
+    return largest;
+}
+
+/**
+ * Restore the Next Fit pointer after loading a layout
+ */
+void engineSetNextFitPointer(int index) {
+    engine->nextFitPointer = (index >= 0 && index < engine->blockCount) ? index : 0;
+}
+
+/**
+ * Recompute used/free/active/largest-free in one pass
+ */
+void engineUpdateStats(void) {
+    int64_t freeSum, largestFree;
+    int freeCount;
+    reduceStats(&freeSum, &largestFree, &freeCount);
+
+    engine->statFree = (EngineSize)freeSum;
+    engine->statLargestFree = (EngineSize)largestFree;
+    engine->statUsed = engine->totalMemory - engine->statFree;
+    engine->statActive = engine->blockCount - freeCount;
+}
+
+EngineSize engineUsedMemory(void) { return engine->statUsed; }
+EngineSize engineFreeMemory(void) { return engine->statFree; }
+int engineActiveProcesses(void) { return engine->statActive; }
+EngineSize engineLargestFreeBlock(void) { return engine->statLargestFree; }
+int engineFreeBlockCount(void) { return engine->freeBlockCount; }
+
+int engineCoalescePasses(void) { return engine->coalescePasses; }
+int engineCoalesceMerges(void) { return engine->coalesceMerges; }
+uint64_t engineCoalesceScanned(void) { return engine->coalesceScanned; }
+int engineCoalesceRescues(void) { return engine->coalesceRescues; }
+
+/**
+ * Copy the hot-path counters (all zero when built with ENGINE_COUNTERS=0)
+ */
+void engineReadCounters(EngineCounters *out) {
+#if ENGINE_COUNTERS
+    *out = engine->counters;
+#else
+    *out = (EngineCounters){ 0 };
+#endif
+}
+
+void engineResetCounters(void) {
+#if ENGINE_COUNTERS
+    engine->counters = (EngineCounters){ 0 };
+#endif
+}
+
+int engineFastBinHits(void) { return engine->fastBinHits; }
+int engineFastBinMisses(void) { return engine->fastBinMisses; }
+int engineFastBinConsolidations(void) { return engine->fastBinConsolidations; }
+EngineSize engineFastBinBytes(void) { return engine->fastBinBytes; }
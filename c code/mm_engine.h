@@ -0,0 +1,187 @@
+// ============================================================================
+// MEMORY ENGINE - Shared Allocator Core (native + WebAssembly)
+// ============================================================================
+// The same First/Next/Best/Worst Fit logic as the standalone demo programs,
+// packaged as a library with no I/O and no libc dependency so it can be:
+//   - linked into native tools:   gcc -O2 -march=native tool.c mm_engine.c
+//   - compiled to WebAssembly and driven by the web UI (js/engine.js):
+//       clang --target=wasm32 -O3 -ffreestanding -nostdlib
+//             -Wl,--no-entry -Wl,--export-dynamic
+//             -o wasm/mm_engine.wasm "c code/mm_engine.c"
+//     or, with Emscripten:
+//       emcc -O3 --no-entry -s STANDALONE_WASM
+//            -o wasm/mm_engine.wasm "c code/mm_engine.c"
+//
+// Processes are identified by integer owner IDs (>= 1). The caller maps
+// its own names to owners; the engine never touches strings.
+//
+// Sizes and addresses are 64-bit byte counts (EngineSize), so heaps of
+// hundreds of GB or several TB can be simulated; the heap size is chosen
+// at runtime by engineInit(). Every block records its start address.
+// From JavaScript these parameters and results are BigInts.
+//
+// All functions return 1/0 (or an index / -1) like the demo programs; the
+// caller decides what to print.
+// ============================================================================
+
+#ifndef MM_ENGINE_H
+#define MM_ENGINE_H
+
+#include <stdint.h>
+
+#ifndef ENGINE_MAX_BLOCKS
+#define ENGINE_MAX_BLOCKS 4096      // Maximum number of memory blocks (-D to override)
+#endif
+#define ENGINE_NO_OWNER 0           // Owner ID of free blocks
+#define ENGINE_FAST_BIN_OWNER (-1)  // Owner ID of blocks parked in a fast bin
+#define ENGINE_FAST_BINS 64         // Maximum number of fast bins
+#define ENGINE_FAST_BIN_DEPTH 32    // Blocks per bin; further frees go to the free list
+#ifndef ENGINE_COUNTERS
+#define ENGINE_COUNTERS 1           // Hot-path counters (-DENGINE_COUNTERS=0 compiles them out)
+#endif
+#ifndef ENGINE_MAX_REGIONS
+#define ENGINE_MAX_REGIONS 1        // Independent engines (-D to override, see REGIONS)
+#endif
+
+// Byte count or address. Must stay below 2^63: the SIMD compares are signed.
+typedef uint64_t EngineSize;
+
+// Strategy codes (same values as EventStrategy in event_log.h)
+typedef enum {
+    FIT_NONE = 0,
+    FIT_FIRST = 1,
+    FIT_NEXT = 2,
+    FIT_BEST = 3,
+    FIT_WORST = 4
+} FitStrategy;
+
+// When freed blocks are merged (engineSetCoalescePolicy)
+typedef enum {
+    COALESCE_MANUAL = 0,    // Only when the caller runs engineCoalesce()
+    COALESCE_EAGER = 1,     // Full pass after every free
+    COALESCE_DEFERRED = 2   // Pass once frees add > threshold free blocks, or on a failed fit
+} CoalescePolicy;
+
+// ============================================================================
+// BLOCK LAYOUT
+// ============================================================================
+// Blocks are kept as a structure of arrays (see mm_engine.c): start
+// addresses, sizes, a "free size" array (size if free, 0 if allocated),
+// owners and strategy tags. Fit searches and statistics only read the
+// free-size array, 8 bytes per block, with AVX2 / SSE4.2 kernels when the
+// compiler targets them (-mavx2, -msse4.2, -march=native) and a scalar loop
+// otherwise.
+
+// ============================================================================
+// REGIONS
+// ============================================================================
+// Built with -DENGINE_MAX_REGIONS=N the library holds N independent engines
+// (memory nodes): each has its own blocks, policies, fast bins, counters
+// and statistics. Every other function acts on the current region, region
+// 0 until engineSelectRegion() picks another; each region is set up with
+// engineInit() while selected. With the default of one region there is
+// nothing to select and the engine costs exactly what it did as globals.
+int engineSelectRegion(int region);  // 1 if region exists
+int engineCurrentRegion(void);
+int engineRegionCount(void);         // ENGINE_MAX_REGIONS
+
+// ============================================================================
+// STATE / SETUP
+// ============================================================================
+void engineInit(EngineSize totalMemory);
+void engineClear(EngineSize totalMemory);
+int engineAppendBlock(EngineSize size, int isFree, int owner, int allocatedBy);
+
+// ============================================================================
+// ALLOCATION / DEALLOCATION
+// ============================================================================
+int engineFindBlock(int strategy, EngineSize requiredSize);
+int engineAllocateAt(int index, int owner, EngineSize requiredSize, int strategy);
+int engineAllocate(int strategy, int owner, EngineSize requiredSize);
+int engineAllocateBatch(int strategy, int count, const int *owners,
+                        const EngineSize *sizes, int *indexes);
+int engineDeallocate(int owner);
+int engineDeallocateAt(int index);
+int engineCoalesce(void);
+void engineCompact(void);
+
+// ============================================================================
+// COALESCING POLICY
+// ============================================================================
+// Counters cover every engineCoalesce() pass, automatic or not:
+//   passes / merges, blocks scanned by the passes (the merge work), and
+//   rescues: allocations that only succeeded after a deferred pass.
+void engineSetCoalescePolicy(int policy, int threshold);
+void engineResetCoalesceCounters(void);
+int engineCoalescePasses(void);
+int engineCoalesceMerges(void);
+uint64_t engineCoalesceScanned(void);
+int engineCoalesceRescues(void);
+
+// ============================================================================
+// FAST BINS
+// ============================================================================
+// Freed blocks of a binned size skip coalescing and are handed back to the
+// next request of the same size. Binned blocks count as used memory in the
+// statistics (they are not available to other sizes); engineFastBinBytes()
+// reports how much is parked.
+void engineSetFastBins(EngineSize granule, int bins, int interval);
+int engineConsolidateFastBins(void);
+int engineFastBinHits(void);
+int engineFastBinMisses(void);
+int engineFastBinConsolidations(void);
+EngineSize engineFastBinBytes(void);
+
+// ============================================================================
+// COUNTERS
+// ============================================================================
+// Work done on the hot paths since engineInit() or engineResetCounters().
+// Built with -DENGINE_COUNTERS=0 none of it is counted and
+// engineReadCounters() reports zeros. The engine is plain globals (one
+// set per region): callers that share it between threads already hold a
+// lock around every call, so these are plain integers, not atomics. engine_counters.h
+// writes them out as JSON.
+typedef struct {
+    uint64_t allocations;           // Blocks handed out (fit, fast bin or batch)
+    uint64_t failedAllocations;
+    uint64_t searches;              // Fit searches (engineFindBlock)
+    uint64_t blocksInspected;       // Block entries the searches read
+    uint64_t splits;                // Allocations that left a free remainder
+    uint64_t blocksShifted;         // Block entries moved to make room (the index upkeep)
+    uint64_t frees;
+    uint64_t coalescePasses;
+    uint64_t merges;
+    uint64_t compactions;
+    uint64_t compactionBytesMoved;  // Bytes of allocated blocks relocated
+    uint64_t fastBinHits;
+} EngineCounters;
+
+void engineReadCounters(EngineCounters *counters);
+void engineResetCounters(void);
+
+// ============================================================================
+// INSPECTION (read by js/engine.js after every operation)
+// ============================================================================
+int engineBlockCount(void);
+EngineSize engineBlockStart(int index);
+EngineSize engineBlockSize(int index);
+int engineBlockIsFree(int index);
+int engineBlockOwner(int index);
+int engineBlockAllocatedBy(int index);
+int engineNextFitPointer(void);
+void engineSetNextFitPointer(int index);
+EngineSize engineTotalMemory(void);
+int engineBlockAt(EngineSize address);
+EngineSize engineFreeRunAt(int index);  // Free run around a block, 0 if allocated
+EngineSize engineLargestFreeRun(int *runs);  // Largest free run, runs = their count
+
+void engineUpdateStats(void);
+EngineSize engineUsedMemory(void);
+EngineSize engineFreeMemory(void);
+int engineActiveProcesses(void);
+EngineSize engineLargestFreeBlock(void);
+int engineFreeBlockCount(void);  // Always current (no engineUpdateStats needed)
+
+const char *engineScanKernel(void);  // "avx2", "sse4.2" or "scalar"
+
+#endif // MM_ENGINE_H
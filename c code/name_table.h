@@ -0,0 +1,135 @@
+// ============================================================================
+// NAME TABLE - Growable Interning of Object Names from Traces
+// ============================================================================
+// Shared by trace_replay.c and trace_convert.c (header-only, like
+// process_table.h). process_table.h is sized for the demo programs (at most
+// MAX_PROCESSES names); a trace can name millions of objects, so this table
+// doubles whenever it is half full and only fails when memory runs out.
+//
+// Names are taken as (pointer, length), as trace_reader.h hands them out
+// of the mapped file, and copied on first use:
+//
+//   NameTable names = { 0 };
+//   uint32_t id = nameIntern(&names, e->name, e->nameLength);  // 1, 2, ...
+//   if (id == NO_NAME) { /* out of memory */ }
+//   printf("%s", names.names[id]);
+//   nameTableFree(&names);
+// ============================================================================
+
+#ifndef NAME_TABLE_H
+#define NAME_TABLE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_NAME 0                 // Empty hash slot / failed intern
+#define NAME_TABLE_MIN_SLOTS 1024 // First allocation (power of two)
+
+typedef struct {
+    uint32_t *slots;     // Name ID per hash slot, NO_NAME = empty
+    uint32_t slotMask;
+    uint32_t count;      // IDs 1..count are in use
+    char **names;        // names[id]: NUL-terminated copy (index 0 unused)
+    uint32_t *lengths;   // lengths[id]
+    uint32_t *hashes;    // hashes[id], kept for rehashing
+} NameTable;
+
+/**
+ * FNV-1a hash of a name of the given length
+ */
+static inline uint32_t hashName(const char *name, uint32_t length) {
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Double the slot array (or allocate the first one) and the per-name
+ * arrays, and rehash every name
+ * @return: 1 if successful, 0 if out of memory (the table is unchanged)
+ */
+static int growNameTable(NameTable *table) {
+    uint32_t slotCount = table->slots ? 2 * (table->slotMask + 1) : NAME_TABLE_MIN_SLOTS;
+    uint32_t *slots = calloc(slotCount, sizeof(uint32_t));
+    if (slots == NULL) {
+        return 0;
+    }
+
+    // At most half the slots are used, so slotCount / 2 + 1 entries are enough
+    size_t entries = (size_t)slotCount / 2 + 1;
+    char **names = realloc(table->names, entries * sizeof(char *));
+    if (names != NULL) table->names = names;
+    uint32_t *lengths = realloc(table->lengths, entries * sizeof(uint32_t));
+    if (lengths != NULL) table->lengths = lengths;
+    uint32_t *hashes = realloc(table->hashes, entries * sizeof(uint32_t));
+    if (hashes != NULL) table->hashes = hashes;
+    if (names == NULL || lengths == NULL || hashes == NULL) {
+        free(slots);
+        return 0;
+    }
+
+    uint32_t mask = slotCount - 1;
+    for (uint32_t id = 1; id <= table->count; id++) {
+        uint32_t slot = table->hashes[id] & mask;
+        while (slots[slot] != NO_NAME) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = id;
+    }
+
+    free(table->slots);
+    table->slots = slots;
+    table->slotMask = mask;
+    return 1;
+}
+
+/**
+ * ID of a name, interning it on first use
+ * @return: ID >= 1 (in order of first appearance), or NO_NAME if out of memory
+ */
+static uint32_t nameIntern(NameTable *table, const char *name, uint32_t length) {
+    if (table->count + 1 > (table->slots ? (table->slotMask + 1) / 2 : 0) &&
+        !growNameTable(table)) {
+        return NO_NAME;
+    }
+
+    uint32_t hash = hashName(name, length);
+    uint32_t slot = hash & table->slotMask;
+    for (uint32_t id; (id = table->slots[slot]) != NO_NAME; slot = (slot + 1) & table->slotMask) {
+        if (table->hashes[id] == hash && table->lengths[id] == length &&
+            memcmp(table->names[id], name, length) == 0) {
+            return id;
+        }
+    }
+
+    char *copy = malloc((size_t)length + 1);
+    if (copy == NULL) {
+        return NO_NAME;
+    }
+    memcpy(copy, name, length);
+    copy[length] = '\0';
+
+    uint32_t id = ++table->count;
+    table->names[id] = copy;
+    table->lengths[id] = length;
+    table->hashes[id] = hash;
+    table->slots[slot] = id;
+    return id;
+}
+
+__attribute__((unused))
+static void nameTableFree(NameTable *table) {
+    for (uint32_t id = 1; id <= table->count; id++) {
+        free(table->names[id]);
+    }
+    free(table->slots);
+    free(table->names);
+    free(table->lengths);
+    free(table->hashes);
+    memset(table, 0, sizeof(*table));
+}
+
+#endif // NAME_TABLE_H
@@ -18,7 +18,9 @@
 
 #define TOTAL_MEMORY 10240  // Total memory in KB
 #define MAX_BLOCKS 100      // Maximum number of memory blocks
-#define MAX_PROCESS_ID 10   // Max characters in process ID
+
+#include "event_log.h"
+#include "process_table.h"
 
 // ============================================================================
 // MEMORY BLOCK STRUCTURE
@@ -26,7 +28,7 @@
 typedef struct {
     int size;                      // Size of block in KB
     int isFree;                    // 1 = free, 0 = allocated
-    char processId[MAX_PROCESS_ID]; // Process ID (empty if free)
+    ProcessHandle owner;           // Owner (NO_PROCESS if free)
 } MemoryBlock;
 
 // Global memory blocks array
@@ -47,17 +49,19 @@ void initializeMemory() {
     
     memory[blockCount].size = TOTAL_MEMORY;
     memory[blockCount].isFree = 1;
-    strcpy(memory[blockCount].processId, "");
+    memory[blockCount].owner = NO_PROCESS;
     blockCount++;
     
-    printf("✓ Memory initialized: %d KB free\n", TOTAL_MEMORY);
-    printf("  Next Fit Pointer: %d\n\n", nextFitPointer);
+    LOG_SUMMARY("✓ Memory initialized: %d KB free\n", TOTAL_MEMORY);
+    LOG_SUMMARY("  Next Fit Pointer: %d\n\n", nextFitPointer);
 }
 
 /**
  * Display the entire memory layout
  */
 void displayMemoryLayout() {
+    if (logLevel < LOG_SUMMARY) return;
+
     printf("\n========== MEMORY LAYOUT (NEXT FIT) ==========\n");
     printf("%-8s %-15s %-12s %-15s %-10s\n", 
            "Block#", "Size (KB)", "Status", "Process ID", "Pointer");
@@ -72,7 +76,7 @@ void displayMemoryLayout() {
                i + 1,
                memory[i].size,
                memory[i].isFree ? "FREE" : "ALLOCATED",
-               memory[i].isFree ? "---" : memory[i].processId,
+               processName(memory[i].owner),
                pointer);
     }
     printf("==========================================\n");
@@ -82,6 +86,8 @@ void displayMemoryLayout() {
  * Display memory statistics
  */
 void displayStatistics() {
+    if (logLevel < LOG_SUMMARY) return;
+
     int usedMemory = 0;
     int freeMemory = 0;
     int activeProcesses = 0;
@@ -137,30 +143,41 @@ void displayStatistics() {
  * - Faster average case (distributes search cost)
  * - Memory treated as circular array
  *
- * @return: 1 if successful, 0 if failed
+ * @return: handle of the process, or NO_PROCESS if failed
  */
-int allocateNextFit(char *processId, int requiredSize) {
+ProcessHandle allocateNextFit(const char *processId, int requiredSize) {
     // Validation: size must be positive and within total memory
     if (requiredSize <= 0 || requiredSize > TOTAL_MEMORY) {
-        printf("✗ Invalid size: %d KB\n", requiredSize);
-        return 0;
+        LOG_OP("✗ Invalid size: %d KB\n", requiredSize);
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_NEXT_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
+    }
+
+    // Name → handle once; everything below compares integers
+    ProcessHandle process = internProcess(processId);
+    if (process == NO_PROCESS) {
+        LOG_OP("✗ Process table full\n");
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_NEXT_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
     }
 
     // Check if process already exists
     for (int i = 0; i < blockCount; i++) {
-        if (!memory[i].isFree && strcmp(memory[i].processId, processId) == 0) {
-            printf("✗ Process %s already allocated\n", processId);
-            return 0;
+        if (!memory[i].isFree && memory[i].owner == process) {
+            LOG_OP("✗ Process %s already allocated\n", processId);
+            logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_NEXT_FIT, processId, requiredSize, -1);
+            return NO_PROCESS;
         }
     }
 
     // Check array bounds
     if (blockCount >= MAX_BLOCKS - 1) {
-        printf("✗ Memory block limit reached\n");
-        return 0;
+        LOG_OP("✗ Memory block limit reached\n");
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_NEXT_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
     }
 
-    printf("  [Next Fit] Starting search from block %d (pointer position)\n", nextFitPointer + 1);
+    LOG_OP("  [Next Fit] Starting search from block %d (pointer position)\n", nextFitPointer + 1);
 
     int foundIndex = -1;
 
@@ -168,18 +185,18 @@ int allocateNextFit(char *processId, int requiredSize) {
     for (int i = nextFitPointer; i < blockCount; i++) {
         if (memory[i].isFree && memory[i].size >= requiredSize) {
             foundIndex = i;
-            printf("  [Next Fit] Found free block at position %d (size %d KB)\n", i + 1, memory[i].size);
+            LOG_OP("  [Next Fit] Found free block at position %d (size %d KB)\n", i + 1, memory[i].size);
             break;
         }
     }
 
     // If not found from nextFitPointer to end, wrap around to beginning
     if (foundIndex == -1) {
-        printf("  [Next Fit] Reached end, wrapping around to beginning...\n");
+        LOG_OP("  [Next Fit] Reached end, wrapping around to beginning...\n");
         for (int i = 0; i < nextFitPointer; i++) {
             if (memory[i].isFree && memory[i].size >= requiredSize) {
                 foundIndex = i;
-                printf("  [Next Fit] Found free block at position %d (size %d KB)\n", i + 1, memory[i].size);
+                LOG_OP("  [Next Fit] Found free block at position %d (size %d KB)\n", i + 1, memory[i].size);
                 break;
             }
         }
@@ -187,9 +204,10 @@ int allocateNextFit(char *processId, int requiredSize) {
 
     // Check if suitable block was found
     if (foundIndex == -1) {
-        printf("✗ [Next Fit] Cannot allocate %d KB to %s (no suitable block found)\n\n",
+        LOG_OP("✗ [Next Fit] Cannot allocate %d KB to %s (no suitable block found)\n\n",
                requiredSize, processId);
-        return 0;
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_NEXT_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
     }
 
     // Allocate to found block
@@ -205,43 +223,47 @@ int allocateNextFit(char *processId, int requiredSize) {
         // Set allocated block
         memory[foundIndex].size = requiredSize;
         memory[foundIndex].isFree = 0;
-        strcpy(memory[foundIndex].processId, processId);
+        memory[foundIndex].owner = process;
 
         // Set leftover free block
         memory[foundIndex + 1].size = leftoverSize;
         memory[foundIndex + 1].isFree = 1;
-        strcpy(memory[foundIndex + 1].processId, "");
+        memory[foundIndex + 1].owner = NO_PROCESS;
 
         blockCount++;
     } 
     // Exact fit: no split needed
     else {
         memory[foundIndex].isFree = 0;
-        strcpy(memory[foundIndex].processId, processId);
+        memory[foundIndex].owner = process;
     }
 
     // Update pointer for next search
     nextFitPointer = (foundIndex + 1) % blockCount;
-    printf("✓ [Next Fit] Allocated %d KB to %s\n", requiredSize, processId);
-    printf("  Next Fit Pointer updated to block %d\n\n", nextFitPointer + 1);
+    LOG_OP("✓ [Next Fit] Allocated %d KB to %s\n", requiredSize, processId);
+    logEvent(EVENT_ALLOCATE, STRATEGY_NEXT_FIT, processId, requiredSize, foundIndex);
+    LOG_OP("  Next Fit Pointer updated to block %d\n\n", nextFitPointer + 1);
     
-    return 1;
+    return process;
 }
 
 /**
- * Deallocate memory from a process
+ * Deallocate memory from a process (handle returned by the allocate call)
+ * @return: 1 if successful, 0 if failed
  */
-int deallocateMemory(char *processId) {
+int deallocateMemory(ProcessHandle process) {
     for (int i = 0; i < blockCount; i++) {
-        if (!memory[i].isFree && strcmp(memory[i].processId, processId) == 0) {
+        if (!memory[i].isFree && memory[i].owner == process) {
             memory[i].isFree = 1;
-            strcpy(memory[i].processId, "");
-            printf("✓ Deallocated process %s\n", processId);
+            memory[i].owner = NO_PROCESS;
+            LOG_OP("✓ Deallocated process %s\n", processName(process));
+            logEvent(EVENT_DEALLOCATE, STRATEGY_NONE, processName(process), memory[i].size, i);
             return 1;
         }
     }
 
-    printf("✗ Process %s not found\n", processId);
+    LOG_OP("✗ Process %s not found\n", processName(process));
+    logEvent(EVENT_DEALLOCATE_FAILED, STRATEGY_NONE, processName(process), 0, -1);
     return 0;
 }
 
@@ -250,6 +272,7 @@ int deallocateMemory(char *processId) {
  */
 void coalesceMemory() {
     int i = 0;
+    int merges = 0;
     while (i < blockCount - 1) {
         if (memory[i].isFree && memory[i + 1].isFree) {
             // Merge adjacent free blocks
@@ -260,6 +283,7 @@ void coalesceMemory() {
                 memory[j] = memory[j + 1];
             }
             blockCount--;
+            merges++;
             
             // Adjust pointer if it's beyond new blockCount
             if (nextFitPointer >= blockCount && blockCount > 0) {
@@ -269,24 +293,30 @@ void coalesceMemory() {
             i++;
         }
     }
+
+    logEvent(EVENT_COALESCE, STRATEGY_NONE, "", merges, blockCount);
 }
 
 // ============================================================================
 // MAIN - DEMONSTRATION OF NEXT FIT
 // ============================================================================
 
-int main() {
-    printf("\n");
-    printf("╔═══════════════════════════════════════════════════════════╗\n");
-    printf("║   NEXT FIT MEMORY ALLOCATION - C Implementation           ║\n");
-    printf("║              Total Memory: 10240 KB                       ║\n");
-    printf("╚═══════════════════════════════════════════════════════════╝\n\n");
+int main(int argc, char *argv[]) {
+    if (!parseLogOptions(argc, argv)) {
+        return 1;
+    }
+
+    LOG_SUMMARY("\n");
+    LOG_SUMMARY("╔═══════════════════════════════════════════════════════════╗\n");
+    LOG_SUMMARY("║   NEXT FIT MEMORY ALLOCATION - C Implementation           ║\n");
+    LOG_SUMMARY("║              Total Memory: 10240 KB                       ║\n");
+    LOG_SUMMARY("╚═══════════════════════════════════════════════════════════╝\n\n");
 
     initializeMemory();
 
     // ========== SCENARIO 1: Basic Allocation ==========
-    printf("--- SCENARIO 1: Basic Allocation with Next Fit ---\n");
-    printf("Notice how the pointer moves to next position after each allocation.\n\n");
+    LOG_SUMMARY("--- SCENARIO 1: Basic Allocation with Next Fit ---\n");
+    LOG_SUMMARY("Notice how the pointer moves to next position after each allocation.\n\n");
     allocateNextFit("P1", 200);
     displayMemoryLayout();
     
@@ -297,66 +327,68 @@ int main() {
     displayMemoryLayout();
 
     // ========== SCENARIO 2: Distribution advantage ==========
-    printf("\n--- SCENARIO 2: Next Fit Distribution Advantage ---\n");
+    LOG_SUMMARY("\n--- SCENARIO 2: Next Fit Distribution Advantage ---\n");
     initializeMemory();
-    printf("Allocating with Next Fit shows even distribution:\n\n");
-    allocateNextFit("Q1", 1000);
+    LOG_SUMMARY("Allocating with Next Fit shows even distribution:\n\n");
+    ProcessHandle q1 = allocateNextFit("Q1", 1000);
     allocateNextFit("Q2", 1000);
-    allocateNextFit("Q3", 1000);
+    ProcessHandle q3 = allocateNextFit("Q3", 1000);
     allocateNextFit("Q4", 1000);
     displayMemoryLayout();
     displayStatistics();
 
-    printf("\nDeallocating Q1, Q3:\n");
-    deallocateMemory("Q1");
-    deallocateMemory("Q3");
+    LOG_SUMMARY("\nDeallocating Q1, Q3:\n");
+    deallocateMemory(q1);
+    deallocateMemory(q3);
     coalesceMemory();
     displayMemoryLayout();
 
     // ========== SCENARIO 3: Wrap-around behavior ==========
-    printf("\n--- SCENARIO 3: Wrap-Around Behavior ---\n");
+    LOG_SUMMARY("\n--- SCENARIO 3: Wrap-Around Behavior ---\n");
     initializeMemory();
-    printf("Allocating to demonstrate wrap-around from end to beginning:\n\n");
+    LOG_SUMMARY("Allocating to demonstrate wrap-around from end to beginning:\n\n");
     allocateNextFit("R1", 2000);
-    allocateNextFit("R2", 2000);
+    ProcessHandle r2 = allocateNextFit("R2", 2000);
     allocateNextFit("R3", 2000);
     allocateNextFit("R4", 2000);
     displayMemoryLayout();
 
-    printf("Now deallocate R2:\n");
-    deallocateMemory("R2");
+    LOG_SUMMARY("Now deallocate R2:\n");
+    deallocateMemory(r2);
     displayMemoryLayout();
 
-    printf("\nNext allocation will start from R4's position and wrap to beginning:\n");
+    LOG_SUMMARY("\nNext allocation will start from R4's position and wrap to beginning:\n");
     allocateNextFit("R5", 1500);
     displayMemoryLayout();
     displayStatistics();
 
     // ========== SCENARIO 4: Complex scenario ==========
-    printf("\n--- SCENARIO 4: Complex Scenario with Multiple Operations ---\n");
+    LOG_SUMMARY("\n--- SCENARIO 4: Complex Scenario with Multiple Operations ---\n");
     initializeMemory();
-    allocateNextFit("S1", 1200);
+    ProcessHandle s1 = allocateNextFit("S1", 1200);
     allocateNextFit("S2", 800);
-    allocateNextFit("S3", 1500);
+    ProcessHandle s3 = allocateNextFit("S3", 1500);
     allocateNextFit("S4", 600);
     allocateNextFit("S5", 900);
     displayMemoryLayout();
     displayStatistics();
 
-    printf("\nDeallocating S1, S3:\n");
-    deallocateMemory("S1");
-    deallocateMemory("S3");
+    LOG_SUMMARY("\nDeallocating S1, S3:\n");
+    deallocateMemory(s1);
+    deallocateMemory(s3);
     coalesceMemory();
     displayMemoryLayout();
 
-    printf("\nAllocating S6 (2000 KB) - will use coalesced block:\n");
+    LOG_SUMMARY("\nAllocating S6 (2000 KB) - will use coalesced block:\n");
     allocateNextFit("S6", 2000);
     displayMemoryLayout();
     displayStatistics();
 
-    printf("\n╔═══════════════════════════════════════════════════════════╗\n");
-    printf("║               Next Fit Simulation Complete                ║\n");
-    printf("╚═══════════════════════════════════════════════════════════╝\n\n");
+    LOG_SUMMARY("\n╔═══════════════════════════════════════════════════════════╗\n");
+    LOG_SUMMARY("║               Next Fit Simulation Complete                ║\n");
+    LOG_SUMMARY("╚═══════════════════════════════════════════════════════════╝\n\n");
 
+    displayEventSummary();
+    eventLogClose();
     return 0;
 }
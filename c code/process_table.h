@@ -0,0 +1,90 @@
+// ============================================================================
+// PROCESS TABLE - Interned Process Names and Integer Handles
+// ============================================================================
+// Shared by the simulator programs in this directory (header-only, like
+// event_log.h).
+//
+// Memory blocks store a small integer handle instead of a copy of the
+// process ID. A name is copied once, the first time it is seen, into this
+// side table; from then on allocation, deallocation and lookups compare
+// integers only. Names of any length are accepted.
+//
+//   ProcessHandle p = internProcess("P1");   // same handle every time
+//   printf("%s", processName(p));            // for display only
+// ============================================================================
+
+#ifndef PROCESS_TABLE_H
+#define PROCESS_TABLE_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_PROCESSES 1024      // Distinct process names per run
+#define PROCESS_HASH_SIZE 2048  // Hash slots (power of two, > MAX_PROCESSES)
+#define NO_PROCESS 0            // Handle stored in free blocks
+
+typedef int ProcessHandle;
+
+// processNames[handle]; handle 0 (NO_PROCESS) displays as "---"
+static const char *processNames[MAX_PROCESSES + 1] = { "---" };
+static int processCount = 0;
+
+// Open-addressing hash: name → handle, 0 = empty slot
+static ProcessHandle processHash[PROCESS_HASH_SIZE];
+
+/**
+ * FNV-1a hash of a process name
+ */
+static unsigned int hashProcessName(const char *name) {
+    unsigned int hash = 2166136261u;
+    while (*name) {
+        hash = (hash ^ (unsigned char)*name++) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Find the hash slot holding name, or the empty slot where it would go
+ */
+static int processSlot(const char *name) {
+    unsigned int slot = hashProcessName(name) & (PROCESS_HASH_SIZE - 1);
+    while (processHash[slot] != NO_PROCESS &&
+           strcmp(processNames[processHash[slot]], name) != 0) {
+        slot = (slot + 1) & (PROCESS_HASH_SIZE - 1);
+    }
+    return (int)slot;
+}
+
+/**
+ * Handle for a process name, interning the name on first use
+ * @return: handle >= 1, or NO_PROCESS if the table is full
+ */
+static ProcessHandle internProcess(const char *name) {
+    int slot = processSlot(name);
+    if (processHash[slot] != NO_PROCESS) {
+        return processHash[slot];
+    }
+    if (processCount >= MAX_PROCESSES) {
+        return NO_PROCESS;
+    }
+
+    size_t length = strlen(name) + 1;
+    char *copy = malloc(length);
+    if (copy == NULL) {
+        return NO_PROCESS;
+    }
+    memcpy(copy, name, length);
+
+    processNames[++processCount] = copy;
+    processHash[slot] = processCount;
+    return processCount;
+}
+
+/**
+ * Display name of a handle
+ */
+static inline const char *processName(ProcessHandle handle) {
+    return (handle >= 0 && handle <= processCount) ? processNames[handle] : "?";
+}
+
+#endif // PROCESS_TABLE_H
@@ -0,0 +1,436 @@
+// ============================================================================
+// REGION SIMULATOR - NUMA-Style Memory Nodes with Local-First Placement
+// ============================================================================
+// The workload of event_sim.c (random arrivals, sizes and lifetimes, an
+// expiry queue for departures) over several independent memory regions,
+// each one an mm_engine region with its own blocks, coalescing and index.
+// Every arrival has a home region (the node its thread runs on), and a
+// placement policy decides where its memory comes from:
+//
+//   local       home region only; fails when home has no fit (strict bind)
+//   spill       home first, then remote regions nearest first
+//   spill-free  home first, then remote regions with the most free bytes
+//   interleave  round-robin over all regions, nearest first from there
+//
+// Regions sit on a ring, so the distance between two of them is the number
+// of hops the shorter way round. A byte placed h hops from home costs
+// 1 + h * penalty to access (--remote-penalty, default 1.1: one hop is
+// 2.1x local, like an ACPI SLIT distance of 21 against 10). The report
+// gives the locality ratio (allocations placed at home), the byte-weighted
+// access cost, and each region's steady-state utilisation and
+// fragmentation:
+//
+//   gcc -O2 -march=native -DENGINE_MAX_REGIONS=8 -o region_sim region_sim.c mm_engine.c -lm
+//   ./region_sim                                    # all four policies
+//   ./region_sim --regions=4 --hot=40 --policy=spill --remote-penalty=2
+//
+// --hot=P gives P% of arrivals home region 0 (the rest are spread evenly),
+// which overloads one node and makes the policies diverge. Distributions
+// are those of event_sim.c (sim_common.h: --arrival, --lifetime, --size in KB).
+// ============================================================================
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mm_engine.h"
+
+#if ENGINE_MAX_REGIONS < 2
+#error "region_sim needs several engine regions: build with -DENGINE_MAX_REGIONS=N (N >= 2)"
+#endif
+
+#define MAX_LIVE (ENGINE_MAX_BLOCKS * ENGINE_MAX_REGIONS)  // Owners / departures
+#define SIM_MAX_DEPARTURES MAX_LIVE
+
+#include "sim_common.h"
+
+typedef enum {
+    POLICY_ALL = 0,
+    POLICY_LOCAL = 1,
+    POLICY_SPILL = 2,
+    POLICY_SPILL_FREE = 3,
+    POLICY_INTERLEAVE = 4
+} PlacementPolicy;
+
+static const char *policyNames[] = { "all", "local", "spill", "spill-free", "interleave" };
+static const char *strategyNames[] = { "none", "first", "next", "best", "worst" };
+
+// ============================================================================
+// REGIONS AND PLACEMENT
+// ============================================================================
+typedef struct {
+    Distribution arrival;
+    Distribution lifetime;
+    Distribution size;      // KB
+    EngineSize heapBytes;   // All regions together, split evenly
+    int regions;
+    uint64_t arrivals;      // Run length
+    int strategy;
+    int coalesce;
+    double penalty;         // Extra access cost per hop
+    double hot;             // % of arrivals whose home is region 0
+    uint64_t seed;
+} SimConfig;
+
+typedef struct {
+    EngineSize bytes;
+    uint64_t local;         // Home requests placed here
+    uint64_t spilledIn;     // Other regions' requests placed here
+    uint64_t spilledOut;    // Home requests placed in another region
+    uint64_t failed;        // Home requests no allowed region could take
+    double utilization;     // Steady-state averages, %
+    double fragmentation;
+    double freeBlocks;
+} RegionResult;
+
+typedef struct {
+    uint64_t arrivals;
+    uint64_t departures;
+    uint64_t allocated;
+    uint64_t local;
+    uint64_t failed;
+    double bytesPlaced;
+    double costBytes;       // Sum of size * access cost
+    double seconds;
+    int samples;            // Steady-state samples taken
+    RegionResult regions[ENGINE_MAX_REGIONS];
+} SimResult;
+
+static int nearest[ENGINE_MAX_REGIONS][ENGINE_MAX_REGIONS];  // Regions by distance from each
+static EngineSize liveBytes[ENGINE_MAX_REGIONS];
+static int freeOwners[MAX_LIVE];  // Stack of unused owner IDs
+static int freeOwnerCount;
+
+static int hops(int from, int to, int regions) {
+    int d = from > to ? from - to : to - from;
+    return d < regions - d ? d : regions - d;
+}
+
+/**
+ * Order every region's peers by ring distance, ties to the next one up
+ * (home, home+1, home-1, home+2, ...)
+ */
+static void buildNearest(int regions) {
+    for (int home = 0; home < regions; home++) {
+        int n = 0;
+        nearest[home][n++] = home;
+        for (int d = 1; n < regions; d++) {
+            nearest[home][n++] = (home + d) % regions;
+            if (n < regions) {
+                nearest[home][n++] = (home - d + regions) % regions;
+            }
+        }
+    }
+}
+
+/**
+ * Regions to try for a request from home, best first
+ * @return: number of candidates written to order
+ */
+static int candidates(int policy, int home, uint64_t arrival, int regions, int *order) {
+    switch (policy) {
+    case POLICY_LOCAL:
+        order[0] = home;
+        return 1;
+    case POLICY_INTERLEAVE:
+        memcpy(order, nearest[arrival % regions], regions * sizeof(int));
+        return regions;
+    case POLICY_SPILL_FREE:
+        order[0] = home;
+        for (int i = 1; i < regions; i++) {
+            // Insertion sort of the remote regions, most free bytes first
+            // (regions are the same size: fewest live bytes), nearest on ties
+            int r = nearest[home][i];
+            int j = i;
+            while (j > 1 && liveBytes[order[j - 1]] > liveBytes[r]) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = r;
+        }
+        return regions;
+    default:
+        memcpy(order, nearest[home], regions * sizeof(int));
+        return regions;
+    }
+}
+
+/**
+ * Allocate from the first candidate region with a fit
+ * @return: block index in *region, or -1
+ */
+static int place(const SimConfig *config, int policy, int home, uint64_t arrival,
+                 int owner, EngineSize size, int *region) {
+    int order[ENGINE_MAX_REGIONS];
+    int count = candidates(policy, home, arrival, config->regions, order);
+
+    for (int i = 0; i < count; i++) {
+        engineSelectRegion(order[i]);
+        int index = engineAllocate(config->strategy, owner, size);
+        if (index != -1) {
+            *region = order[i];
+            return index;
+        }
+    }
+    return -1;
+}
+
+// ============================================================================
+// SIMULATION
+// ============================================================================
+
+static void takeSample(const SimConfig *config, SimResult *result) {
+    for (int r = 0; r < config->regions; r++) {
+        engineSelectRegion(r);
+        engineUpdateStats();
+        EngineSize freeBytes = engineFreeMemory();
+        int holes;
+        EngineSize largest = engineLargestFreeRun(&holes);
+
+        RegionResult *region = &result->regions[r];
+        region->utilization += 100.0 * engineUsedMemory() / engineTotalMemory();
+        region->fragmentation += freeBytes > 0 ? 100.0 * (1.0 - (double)largest / freeBytes) : 0;
+        region->freeBlocks += holes;
+    }
+    result->samples++;
+}
+
+/**
+ * Run one simulation with the given policy from empty regions
+ */
+static void simulate(const SimConfig *config, int policy, SimResult *result) {
+    memset(result, 0, sizeof(*result));
+    for (int r = 0; r < config->regions; r++) {
+        engineSelectRegion(r);
+        engineInit(config->heapBytes / config->regions);
+        engineSetCoalescePolicy(config->coalesce, DEFERRED_THRESHOLD);
+        result->regions[r].bytes = engineTotalMemory();
+        liveBytes[r] = 0;
+    }
+    rngState = config->seed;
+    departureCount = 0;
+    for (freeOwnerCount = 0; freeOwnerCount < MAX_LIVE; freeOwnerCount++) {
+        freeOwners[freeOwnerCount] = MAX_LIVE - freeOwnerCount;
+    }
+
+    uint64_t sampleEvery = config->arrivals / SAMPLES > 0 ? config->arrivals / SAMPLES : 1;
+    double nextArrival = sample(&config->arrival);
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    while (result->arrivals < config->arrivals) {
+        // Departures due before the next arrival go first
+        if (departureCount > 0 && departures[0].time <= nextArrival) {
+            Departure d = popDeparture();
+            engineSelectRegion(d.region);
+            int index = engineBlockAt(d.address);
+            if (index != -1 && engineBlockOwner(index) == d.owner) {
+                engineDeallocateAt(index);
+            } else {
+                engineDeallocate(d.owner);
+            }
+            liveBytes[d.region] -= d.size;
+            freeOwners[freeOwnerCount++] = d.owner;
+            result->departures++;
+            continue;
+        }
+
+        double now = nextArrival;
+        nextArrival = now + sample(&config->arrival);
+        result->arrivals++;
+
+        int home = randomUnit() * 100 < config->hot
+                 ? 0 : (int)(randomUnit() * config->regions);
+        EngineSize size = (EngineSize)(sample(&config->size) * KB);
+        double lifetime = sample(&config->lifetime);
+
+        int region = -1;
+        int index = freeOwnerCount > 0 && size > 0
+                  ? place(config, policy, home, result->arrivals, freeOwners[freeOwnerCount - 1],
+                          size, &region)
+                  : -1;
+        if (index == -1) {
+            result->failed++;
+            result->regions[home].failed++;
+        } else {
+            Departure d = { now + lifetime, engineBlockStart(index),
+                            freeOwners[--freeOwnerCount], size, region };
+            pushDeparture(d);
+            liveBytes[region] += size;
+
+            int distance = hops(home, region, config->regions);
+            result->allocated++;
+            result->bytesPlaced += (double)size;
+            result->costBytes += (double)size * (1.0 + distance * config->penalty);
+            if (distance == 0) {
+                result->local++;
+                result->regions[region].local++;
+            } else {
+                result->regions[region].spilledIn++;
+                result->regions[home].spilledOut++;
+            }
+        }
+
+        if (result->arrivals % sampleEvery == 0 &&
+            result->arrivals / sampleEvery > WARMUP_SAMPLES) {
+            takeSample(config, result);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    result->seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    for (int r = 0; r < config->regions && result->samples > 0; r++) {
+        result->regions[r].utilization /= result->samples;
+        result->regions[r].fragmentation /= result->samples;
+        result->regions[r].freeBlocks /= result->samples;
+    }
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+static void printSummary(const SimConfig *config, int policy, const SimResult *r) {
+    double used = 0, fragmentation = 0, lowest = 100, highest = 0;
+    for (int i = 0; i < config->regions; i++) {
+        used += r->regions[i].utilization / config->regions;
+        fragmentation += r->regions[i].fragmentation / config->regions;
+        if (r->regions[i].utilization < lowest) lowest = r->regions[i].utilization;
+        if (r->regions[i].utilization > highest) highest = r->regions[i].utilization;
+    }
+
+    printf("%-11s %-10.3f %-9.1f %-8.3f %-8.1f %-12.1f %-11.1f %-10.2f\n", policyNames[policy],
+           100.0 * r->failed / r->arrivals,
+           r->allocated > 0 ? 100.0 * r->local / r->allocated : 0,
+           r->bytesPlaced > 0 ? r->costBytes / r->bytesPlaced : 0,
+           used, fragmentation, highest - lowest,
+           (r->arrivals + r->departures) / 1e6 / r->seconds);
+}
+
+static void printRegions(const SimConfig *config, int policy, const SimResult *r) {
+    printf("\n%s: per region (steady state)\n", policyNames[policy]);
+    printf("%-7s %-8s %-8s %-12s %-12s %-10s %-11s %-12s %-8s\n", "Region", "MB", "Used %",
+           "Ext. Frag %", "Free Blocks", "Local", "Spilled in", "Spilled out", "Failed");
+    printf("------------------------------------------------------------------------------------------\n");
+    for (int i = 0; i < config->regions; i++) {
+        const RegionResult *region = &r->regions[i];
+        printf("%-7d %-8llu %-8.1f %-12.1f %-12.0f %-10llu %-11llu %-12llu %-8llu\n", i,
+               (unsigned long long)(region->bytes / MB), region->utilization,
+               region->fragmentation, region->freeBlocks,
+               (unsigned long long)region->local, (unsigned long long)region->spilledIn,
+               (unsigned long long)region->spilledOut, (unsigned long long)region->failed);
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char *argv[]) {
+    SimConfig config = {
+        .arrival = { DIST_EXPONENTIAL, 1, 0 },
+        .lifetime = { DIST_EXPONENTIAL, 1000, 0 },
+        .size = { DIST_UNIFORM, 1, 256 },
+        .heapBytes = 256 * MB,
+        .regions = 4,
+        .arrivals = 1000000,
+        .strategy = FIT_FIRST,
+        .coalesce = COALESCE_DEFERRED,
+        .penalty = 1.1,
+        .hot = 0,
+        .seed = 1,
+    };
+    int policy = POLICY_ALL;
+    int ok = 1;
+
+    for (int i = 1; i < argc && ok; i++) {
+        const char *arg = argv[i];
+        if (strncmp(arg, "--arrival=", 10) == 0) {
+            ok = parseDistribution(arg + 10, &config.arrival);
+        } else if (strncmp(arg, "--lifetime=", 11) == 0) {
+            ok = parseDistribution(arg + 11, &config.lifetime);
+        } else if (strncmp(arg, "--size=", 7) == 0) {
+            ok = parseDistribution(arg + 7, &config.size);
+        } else if (strncmp(arg, "--heap-mb=", 10) == 0) {
+            config.heapBytes = strtoull(arg + 10, NULL, 10) * MB;
+            ok = config.heapBytes > 0;
+        } else if (strncmp(arg, "--regions=", 10) == 0) {
+            config.regions = atoi(arg + 10);
+            ok = config.regions >= 1 && config.regions <= engineRegionCount();
+        } else if (strncmp(arg, "--arrivals=", 11) == 0) {
+            config.arrivals = strtoull(arg + 11, NULL, 10);
+            ok = config.arrivals > 0;
+        } else if (strncmp(arg, "--seed=", 7) == 0) {
+            config.seed = strtoull(arg + 7, NULL, 10) | 1;  // xorshift needs a nonzero state
+        } else if (strncmp(arg, "--policy=", 9) == 0) {
+            policy = -1;
+            for (int p = POLICY_ALL; p <= POLICY_INTERLEAVE; p++) {
+                if (strcmp(arg + 9, policyNames[p]) == 0) policy = p;
+            }
+            ok = policy >= 0;
+        } else if (strncmp(arg, "--strategy=", 11) == 0) {
+            config.strategy = -1;
+            for (int s = FIT_FIRST; s <= FIT_WORST; s++) {
+                if (strcmp(arg + 11, strategyNames[s]) == 0) config.strategy = s;
+            }
+            ok = config.strategy >= 0;
+        } else if (strncmp(arg, "--remote-penalty=", 17) == 0) {
+            config.penalty = atof(arg + 17);
+            ok = config.penalty >= 0;
+        } else if (strncmp(arg, "--hot=", 6) == 0) {
+            config.hot = atof(arg + 6);
+            ok = config.hot >= 0 && config.hot <= 100;
+        } else {
+            ok = 0;
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "Usage: %s [--policy=all|local|spill|spill-free|interleave] "
+                        "[--regions=N (1-%d)] [--remote-penalty=X] [--hot=PERCENT] "
+                        "[--strategy=first|next|best|worst] [--arrival=DIST] [--lifetime=DIST] "
+                        "[--size=DIST(KB)] [--heap-mb=N] [--arrivals=N] [--seed=N]\n"
+                        "DIST: fixed:V | uniform:LO:HI | exp:MEAN | pareto:ALPHA:MIN\n",
+                argv[0], engineRegionCount());
+        return 1;
+    }
+    buildNearest(config.regions);
+
+    // Little's law: expected live bytes if nothing fails
+    double live = distributionMean(&config.lifetime) / distributionMean(&config.arrival);
+    double offered = live * distributionMean(&config.size) * KB;
+    double hotShare = config.hot / 100 + (1 - config.hot / 100) / config.regions;
+
+    printf("\n========== NUMA REGION SIMULATION ==========\n");
+    printf("Regions:                   %d x %llu MB, %s fit, remote penalty %.2f per hop\n",
+           config.regions, (unsigned long long)(config.heapBytes / config.regions / MB),
+           strategyNames[config.strategy], config.penalty);
+    printf("Arrivals:                  %llu, offered load %.1f%% of all memory\n",
+           (unsigned long long)config.arrivals, 100.0 * offered / config.heapBytes);
+    printf("Region 0 is home to:       %.1f%% of arrivals (offered %.1f%% of its memory)\n",
+           100.0 * hotShare, 100.0 * hotShare * offered * config.regions / config.heapBytes);
+    printf("Steady state:              averages over samples %d-%d\n", WARMUP_SAMPLES + 1, SAMPLES);
+
+    static SimResult results[POLICY_INTERLEAVE + 1];
+    int first = policy == POLICY_ALL ? POLICY_LOCAL : policy;
+    int last = policy == POLICY_ALL ? POLICY_INTERLEAVE : policy;
+
+    printf("\n%-11s %-10s %-9s %-8s %-8s %-12s %-11s %-10s\n", "Policy", "Failed %", "Local %",
+           "Cost", "Used %", "Ext. Frag %", "Imbalance", "M events/s");
+    printf("---------------------------------------------------------------------------------\n");
+    for (int p = first; p <= last; p++) {
+        simulate(&config, p, &results[p]);
+        printSummary(&config, p, &results[p]);
+    }
+    for (int p = first; p <= last; p++) {
+        printRegions(&config, p, &results[p]);
+    }
+    printf("\nCost: byte-weighted access cost (1.00 = all local). "
+           "Imbalance: highest - lowest region Used %%.\n");
+    printf("============================================\n");
+    return 0;
+}
@@ -0,0 +1,159 @@
+// ============================================================================
+// SIM COMMON - Shared Pieces of the Discrete-Event Simulators
+// ============================================================================
+// Used by event_sim.c and region_sim.c (header-only, like event_log.h):
+// the random number generator and workload distributions, and the
+// expiry queue of departures. Both sample fragmentation over free runs
+// (engineLargestFreeRun).
+//
+// Distributions (--arrival = time between arrivals, --lifetime, --size in KB):
+//   fixed:V   uniform:LO:HI   exp:MEAN   pareto:ALPHA:MIN
+//
+// The expiry queue holds SIM_MAX_DEPARTURES entries, one engine's worth of
+// blocks unless the program defines more before including this header.
+// ============================================================================
+
+#ifndef SIM_COMMON_H
+#define SIM_COMMON_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "mm_engine.h"
+
+#define KB ((uint64_t)1 << 10)
+#define MB ((uint64_t)1 << 20)
+#define SAMPLES 100             // Statistics samples per run
+#define WARMUP_SAMPLES 20       // Left out of the steady-state averages
+#define DEFERRED_THRESHOLD 64
+
+#ifndef SIM_MAX_DEPARTURES
+#define SIM_MAX_DEPARTURES ENGINE_MAX_BLOCKS
+#endif
+
+// ============================================================================
+// RANDOM NUMBERS AND DISTRIBUTIONS
+// ============================================================================
+typedef enum {
+    DIST_FIXED,
+    DIST_UNIFORM,
+    DIST_EXPONENTIAL,
+    DIST_PARETO
+} DistributionKind;
+
+typedef struct {
+    DistributionKind kind;
+    double a;  // fixed: value, uniform: low,  exp: mean, pareto: alpha
+    double b;  //                  uniform: high,            pareto: minimum
+} Distribution;
+
+static uint64_t rngState;
+
+/**
+ * Uniform double in [0, 1) (xorshift64*)
+ */
+static inline double randomUnit(void) {
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    return ((rngState * 0x2545F4914F6CDD1Dull) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double sample(const Distribution *d) {
+    switch (d->kind) {
+    case DIST_FIXED:       return d->a;
+    case DIST_UNIFORM:     return d->a + (d->b - d->a) * randomUnit();
+    case DIST_EXPONENTIAL: return -d->a * log(1.0 - randomUnit());
+    case DIST_PARETO:      return d->b / pow(1.0 - randomUnit(), 1.0 / d->a);
+    }
+    return 0;
+}
+
+/**
+ * Parse "fixed:V", "uniform:LO:HI", "exp:MEAN" or "pareto:ALPHA:MIN"
+ * @return: 1 if valid
+ */
+static int parseDistribution(const char *text, Distribution *d) {
+    char name[16];
+    double a = 0, b = 0;
+    int fields = sscanf(text, "%15[a-z]:%lf:%lf", name, &a, &b);
+
+    if (strcmp(name, "fixed") == 0 && fields == 2 && a > 0) {
+        d->kind = DIST_FIXED;
+    } else if (strcmp(name, "uniform") == 0 && fields == 3 && a > 0 && b >= a) {
+        d->kind = DIST_UNIFORM;
+    } else if (strcmp(name, "exp") == 0 && fields == 2 && a > 0) {
+        d->kind = DIST_EXPONENTIAL;
+    } else if (strcmp(name, "pareto") == 0 && fields == 3 && a > 0 && b > 0) {
+        d->kind = DIST_PARETO;
+    } else {
+        return 0;
+    }
+    d->a = a;
+    d->b = b;
+    return 1;
+}
+
+static double distributionMean(const Distribution *d) {
+    switch (d->kind) {
+    case DIST_FIXED:       return d->a;
+    case DIST_UNIFORM:     return (d->a + d->b) / 2;
+    case DIST_EXPONENTIAL: return d->a;
+    case DIST_PARETO:      return d->a > 1 ? d->a * d->b / (d->a - 1) : INFINITY;
+    }
+    return 0;
+}
+
+// ============================================================================
+// EXPIRY QUEUE (binary min-heap on departure time)
+// ============================================================================
+typedef struct {
+    double time;
+    EngineSize address;  // Block start (blocks never move: no compaction here)
+    int owner;
+    EngineSize size;     // Bytes (region_sim.c; 0 where unused)
+    int region;          // Engine region of the block (region_sim.c)
+} Departure;
+
+static Departure departures[SIM_MAX_DEPARTURES];  // At most one per allocated block
+static int departureCount = 0;
+
+static void pushDeparture(Departure d) {
+    int i = departureCount++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (departures[parent].time <= d.time) {
+            break;
+        }
+        departures[i] = departures[parent];
+        i = parent;
+    }
+    departures[i] = d;
+}
+
+static Departure popDeparture(void) {
+    Departure top = departures[0];
+    Departure last = departures[--departureCount];
+    int i = 0;
+
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= departureCount) {
+            break;
+        }
+        if (child + 1 < departureCount && departures[child + 1].time < departures[child].time) {
+            child++;
+        }
+        if (last.time <= departures[child].time) {
+            break;
+        }
+        departures[i] = departures[child];
+        i = child;
+    }
+    departures[i] = last;
+    return top;
+}
+
+#endif // SIM_COMMON_H
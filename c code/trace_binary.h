@@ -0,0 +1,166 @@
+// ============================================================================
+// TRACE BINARY - Compact Event Trace Format
+// ============================================================================
+// Shared by trace_reader.h (decoding) and trace_convert.c (encoding);
+// header-only, like event_log.h. All integers are little-endian.
+//
+//   TraceFileHeader                       48 bytes
+//   block 0 .. blockCount-1               TraceBlockHeader + payload
+//   name table (named traces only)        per name: varint length, bytes
+//   index                                 TraceIndexEntry per block
+//
+// Blocks hold up to maxBlockEvents events and decode on their own: every
+// delta restarts from zero at a block boundary, so blocks can be decoded
+// in parallel, and any one of them can be reached through the index
+// (binary search on firstSequence) without reading the ones before it.
+// Each payload carries a CRC-32C.
+//
+// Event encoding (varints are LEB128, "delta" = zigzag varint of the
+// difference from the previous event in the block):
+//   tag        type (bits 0-2) | strategy (bits 3-5)
+//              | TRACE_TAG_SEQUENCE (bit 6) | TRACE_TAG_THREAD (bit 7)
+//   [sequence] delta from previous + 1, only if TRACE_TAG_SEQUENCE
+//   object     delta (address, or name number in named traces)
+//   size       varint, bytes
+//   [time]     delta in ns, only if the file has TRACE_FILE_TIMESTAMPS
+//   [thread]   varint, only if TRACE_TAG_THREAD (thread changed)
+//
+// A typical shim event takes 6-10 bytes, against about 60 as CSV.
+// ============================================================================
+
+#ifndef TRACE_BINARY_H
+#define TRACE_BINARY_H
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#define TRACE_MAGIC "MMTRACE"       // 7 characters + NUL in TraceFileHeader.magic
+#define TRACE_VERSION 1
+#define TRACE_BLOCK_EVENTS 65536    // Events per block written by the converter
+
+// TraceFileHeader.flags
+#define TRACE_FILE_TIMESTAMPS 0x1   // Events carry time and thread
+#define TRACE_FILE_NAMED 0x2        // Objects are numbers in the name table
+
+#define TRACE_TAG_SEQUENCE 0x40
+#define TRACE_TAG_THREAD 0x80
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t eventCount;
+    uint32_t blockCount;
+    uint32_t maxBlockEvents;
+    uint64_t namesOffset;       // 0 if no name table
+    uint32_t nameCount;         // Names are numbered from 1
+    uint32_t indexChecksum;     // CRC-32C of the index
+    uint64_t indexOffset;
+} TraceFileHeader;
+
+typedef struct {
+    uint32_t payloadBytes;
+    uint32_t eventCount;
+    uint32_t checksum;          // CRC-32C of the payload
+    uint32_t reserved;
+} TraceBlockHeader;
+
+typedef struct {
+    uint64_t offset;            // Of the TraceBlockHeader
+    uint64_t firstSequence;
+    uint64_t firstTimestamp;
+} TraceIndexEntry;
+
+// ============================================================================
+// CRC-32C
+// ============================================================================
+// SSE4.2 crc32 instruction when the compiler targets it (-msse4.2,
+// -march=native), else a table built by traceCrcInit().
+
+static uint32_t traceCrcTable[256];
+
+/**
+ * Build the software CRC table (call once, before any thread uses it)
+ */
+static void traceCrcInit(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1)));
+        }
+        traceCrcTable[i] = crc;
+    }
+}
+
+static uint32_t traceCrc(const void *data, size_t length) {
+    const unsigned char *p = data;
+    uint32_t crc = 0xFFFFFFFFu;
+
+#if defined(__SSE4_2__)
+    uint64_t crc64 = crc;
+    for (; length >= 8; p += 8, length -= 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = (uint32_t)crc64;
+    for (; length > 0; p++, length--) {
+        crc = _mm_crc32_u8(crc, *p);
+    }
+#else
+    for (; length > 0; p++, length--) {
+        crc = (crc >> 8) ^ traceCrcTable[(crc ^ *p) & 0xFF];
+    }
+#endif
+    return ~crc;
+}
+
+// ============================================================================
+// VARINTS
+// ============================================================================
+
+static inline uint64_t traceZigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t traceUnzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/**
+ * Write value as a varint at p
+ * @return: position after it (at most 10 bytes later)
+ */
+static inline unsigned char *tracePutVarint(unsigned char *p, uint64_t value) {
+    while (value >= 0x80) {
+        *p++ = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (unsigned char)value;
+    return p;
+}
+
+/**
+ * Read a varint at p, not past end
+ * @return: position after it, or NULL if truncated or too long
+ */
+static inline const unsigned char *traceGetVarint(const unsigned char *p,
+                                                  const unsigned char *end,
+                                                  uint64_t *value) {
+    uint64_t v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        unsigned char byte = *p++;
+        v |= (uint64_t)(byte & 0x7F) << shift;
+        if (byte < 0x80) {
+            *value = v;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+#endif // TRACE_BINARY_H
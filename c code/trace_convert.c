@@ -0,0 +1,338 @@
+// ============================================================================
+// TRACE CONVERT - Event CSV <-> Compact Binary Trace
+// ============================================================================
+// Converts an event CSV (simulator --events output or a trace_shim.c
+// capture) into the binary format of trace_binary.h, or a binary trace
+// back into CSV. The direction follows the input: binary traces are
+// recognised by their magic.
+//
+//   gcc -O2 -march=native -pthread -o trace_convert trace_convert.c
+//   ./trace_convert trace.csv trace.mmtb                  # about 7x smaller
+//   ./trace_convert --from=5000000 --count=100 trace.mmtb part.csv
+//
+// --from seeks through the binary index instead of decoding the blocks
+// before it. The binary format keeps every column trace_replay.c uses
+// except block_index, which comes back as -1.
+// ============================================================================
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "name_table.h"
+#include "trace_reader.h"
+
+#define MB ((uint64_t)1 << 20)
+#define MAX_EVENT_BYTES 51  // Tag + five 10-byte varints
+
+static const char *csvHeaderShim =
+    "sequence,event,strategy,process_id,size_kb,block_index,size_bytes,timestamp_ns,thread\n";
+static const char *csvHeaderSimulator =
+    "sequence,event,strategy,process_id,size_kb,block_index\n";
+
+// ============================================================================
+// ENCODER
+// ============================================================================
+static struct {
+    FILE *file;
+    uint64_t offset;            // Bytes written so far
+    TraceFileHeader header;
+    int flagsKnown;             // Set by the first event
+
+    unsigned char *payload;     // Current block
+    unsigned char *end;
+    uint32_t blockEvents;
+    uint32_t maxBlockEvents;
+    uint64_t sequence;          // Previous event in the block
+    uint64_t object;
+    uint64_t timestamp;
+    uint64_t thread;
+
+    TraceIndexEntry *index;
+    uint32_t indexCapacity;
+    uint64_t skipped;           // Events of the other kind than the first
+    NameTable names;            // Process IDs, numbered from 1 in order of appearance
+} encoder;
+
+static void writeBytes(const void *data, size_t length) {
+    fwrite(data, 1, length, encoder.file);
+    encoder.offset += length;
+}
+
+static int encoderOpen(const char *path, uint32_t blockEvents) {
+    encoder.file = fopen(path, "wb");
+    encoder.payload = malloc((size_t)blockEvents * MAX_EVENT_BYTES);
+    if (encoder.file == NULL || encoder.payload == NULL) {
+        fprintf(stderr, "✗ Cannot open %s for writing\n", path);
+        return 0;
+    }
+    encoder.maxBlockEvents = blockEvents;
+    encoder.end = encoder.payload;
+    encoder.sequence = UINT64_MAX;
+
+    memcpy(encoder.header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    encoder.header.version = TRACE_VERSION;
+    writeBytes(&encoder.header, sizeof(encoder.header));  // Rewritten at the end
+    return 1;
+}
+
+/**
+ * Write the current block and its index entry, and start a new one
+ */
+static void flushBlock(void) {
+    if (encoder.blockEvents == 0) {
+        return;
+    }
+
+    TraceBlockHeader block = { 0 };
+    block.payloadBytes = (uint32_t)(encoder.end - encoder.payload);
+    block.eventCount = encoder.blockEvents;
+    block.checksum = traceCrc(encoder.payload, block.payloadBytes);
+
+    encoder.index[encoder.header.blockCount++].offset = encoder.offset;
+    writeBytes(&block, sizeof(block));
+    writeBytes(encoder.payload, block.payloadBytes);
+
+    if (encoder.blockEvents > encoder.header.maxBlockEvents) {
+        encoder.header.maxBlockEvents = encoder.blockEvents;
+    }
+    encoder.end = encoder.payload;
+    encoder.blockEvents = 0;
+    encoder.sequence = UINT64_MAX;
+    encoder.object = 0;
+    encoder.timestamp = 0;
+    encoder.thread = 0;
+}
+
+static void encodeEntry(const TraceEntry *e) {
+    uint64_t object = e->object;
+
+    // The first event decides between address and named objects
+    if (!encoder.flagsKnown) {
+        encoder.header.flags = e->name != NULL ? TRACE_FILE_NAMED : TRACE_FILE_TIMESTAMPS;
+        encoder.flagsKnown = 1;
+    }
+    if ((e->name != NULL) != ((encoder.header.flags & TRACE_FILE_NAMED) != 0)) {
+        encoder.skipped++;
+        return;
+    }
+    if (e->name != NULL) {
+        object = nameIntern(&encoder.names, e->name, e->nameLength);
+        if (object == NO_NAME) {
+            fprintf(stderr, "✗ Out of memory for the name table (%u names)\n",
+                    encoder.names.count);
+            exit(1);
+        }
+    }
+
+    if (encoder.blockEvents == 0) {
+        if (encoder.header.blockCount == encoder.indexCapacity) {
+            uint32_t capacity = encoder.indexCapacity ? 2 * encoder.indexCapacity : 1024;
+            TraceIndexEntry *index = realloc(encoder.index, capacity * sizeof(TraceIndexEntry));
+            if (index == NULL) {
+                encoder.skipped++;
+                return;
+            }
+            encoder.index = index;
+            encoder.indexCapacity = capacity;
+        }
+        encoder.index[encoder.header.blockCount].firstSequence = e->sequence;
+        encoder.index[encoder.header.blockCount].firstTimestamp = e->timestamp;
+    }
+
+    unsigned tag = e->type | (unsigned)e->strategy << 3;
+    tag |= e->sequence != encoder.sequence + 1 ? TRACE_TAG_SEQUENCE : 0;
+    tag |= e->thread != encoder.thread ? TRACE_TAG_THREAD : 0;
+
+    unsigned char *p = encoder.end;
+    *p++ = (unsigned char)tag;
+    if (tag & TRACE_TAG_SEQUENCE) {
+        p = tracePutVarint(p, traceZigzag((int64_t)(e->sequence - (encoder.sequence + 1))));
+    }
+    p = tracePutVarint(p, traceZigzag((int64_t)(object - encoder.object)));
+    p = tracePutVarint(p, e->size);
+    if (encoder.header.flags & TRACE_FILE_TIMESTAMPS) {
+        p = tracePutVarint(p, traceZigzag((int64_t)(e->timestamp - encoder.timestamp)));
+    }
+    if (tag & TRACE_TAG_THREAD) {
+        p = tracePutVarint(p, e->thread);
+    }
+    encoder.end = p;
+
+    encoder.blockEvents++;
+    encoder.header.eventCount++;
+    encoder.sequence = e->sequence;
+    encoder.object = object;
+    encoder.timestamp = e->timestamp;
+    encoder.thread = e->thread;
+
+    if (encoder.blockEvents == encoder.maxBlockEvents) {
+        flushBlock();
+    }
+}
+
+/**
+ * Write the last block, the name table and the index, then the header
+ * @return: 1 if everything was written
+ */
+static int encoderClose(void) {
+    flushBlock();
+
+    if (encoder.header.flags & TRACE_FILE_NAMED) {
+        unsigned char length[10];
+        encoder.header.namesOffset = encoder.offset;
+        encoder.header.nameCount = encoder.names.count;
+        for (uint32_t i = 1; i <= encoder.names.count; i++) {
+            size_t bytes = encoder.names.lengths[i];
+            writeBytes(length, (size_t)(tracePutVarint(length, bytes) - length));
+            writeBytes(encoder.names.names[i], bytes);
+        }
+    }
+
+    static const char padding[8] = { 0 };
+    writeBytes(padding, (8 - encoder.offset % 8) % 8);
+    size_t indexBytes = (size_t)encoder.header.blockCount * sizeof(TraceIndexEntry);
+    encoder.header.indexOffset = encoder.offset;
+    encoder.header.indexChecksum = traceCrc(encoder.index, indexBytes);
+    writeBytes(encoder.index, indexBytes);
+
+    fseek(encoder.file, 0, SEEK_SET);
+    fwrite(&encoder.header, sizeof(encoder.header), 1, encoder.file);
+    int ok = !ferror(encoder.file);
+    ok &= fclose(encoder.file) == 0;
+
+    free(encoder.payload);
+    free(encoder.index);
+    nameTableFree(&encoder.names);
+    return ok;
+}
+
+// ============================================================================
+// CSV WRITER
+// ============================================================================
+
+static void writeCsvEntry(FILE *file, const TraceEntry *e) {
+    if (e->name == NULL) {
+        fprintf(file, "%llu,%s,%s,%llx,%llu,-1,%llu,%llu,%u\n",
+                (unsigned long long)e->sequence, traceEventNames[e->type],
+                traceStrategyNames[e->strategy], (unsigned long long)e->object,
+                (unsigned long long)((e->size + 1023) / 1024),
+                (unsigned long long)e->size, (unsigned long long)e->timestamp, e->thread);
+    } else {
+        fprintf(file, "%llu,%s,%s,%.*s,%llu,-1\n",
+                (unsigned long long)e->sequence, traceEventNames[e->type],
+                traceStrategyNames[e->strategy], (int)e->nameLength, e->name,
+                (unsigned long long)(e->size / 1024));
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char *argv[]) {
+    int threads = 2;
+    uint64_t blockEvents = TRACE_BLOCK_EVENTS;
+    uint64_t from = 0;
+    uint64_t count = UINT64_MAX;
+    const char *input = NULL;
+    const char *output = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strncmp(arg, "--threads=", 10) == 0) {
+            threads = atoi(arg + 10);
+        } else if (strncmp(arg, "--block-events=", 15) == 0) {
+            blockEvents = strtoull(arg + 15, NULL, 10);
+        } else if (strncmp(arg, "--from=", 7) == 0) {
+            from = strtoull(arg + 7, NULL, 10);
+        } else if (strncmp(arg, "--count=", 8) == 0) {
+            count = strtoull(arg + 8, NULL, 10);
+        } else if (arg[0] != '-' && input == NULL) {
+            input = arg;
+        } else if (arg[0] != '-' && output == NULL) {
+            output = arg;
+        } else {
+            output = NULL;
+            break;
+        }
+    }
+    if (output == NULL || blockEvents == 0 || blockEvents > (1u << 24)) {
+        fprintf(stderr, "Usage: %s [--threads=N] [--block-events=N] "
+                        "[--from=SEQ] [--count=N] INPUT OUTPUT\n", argv[0]);
+        return 1;
+    }
+
+    double start = traceNowNs();
+    if (!traceReaderOpen(input, threads, 4 * MB, from)) {
+        return 1;
+    }
+    uint64_t inputBytes = traceReader.size;
+    int toCsv = traceReader.header != NULL;
+    FILE *csv = NULL;
+
+    if (toCsv) {
+        csv = fopen(output, "w");
+        if (csv == NULL) {
+            fprintf(stderr, "✗ Cannot open %s for writing\n", output);
+            traceReaderClose();
+            return 1;
+        }
+        fputs(traceReader.header->flags & TRACE_FILE_NAMED ? csvHeaderSimulator : csvHeaderShim, csv);
+    } else if (!encoderOpen(output, (uint32_t)blockEvents)) {
+        traceReaderClose();
+        return 1;
+    }
+
+    uint64_t events = 0;
+    const TraceEntry *entries;
+    int n;
+    while (count > 0 && (entries = traceReaderNext(&n)) != NULL) {
+        for (int i = 0; i < n && count > 0; i++) {
+            if (entries[i].sequence < from) {
+                continue;
+            }
+            if (toCsv) {
+                writeCsvEntry(csv, &entries[i]);
+            } else {
+                encodeEntry(&entries[i]);
+            }
+            events++;
+            count--;
+        }
+    }
+    uint64_t malformed = traceReader.malformed;
+    uint64_t corrupt = traceReader.corruptBlocks;
+    traceReaderClose();
+
+    int ok = toCsv ? fclose(csv) == 0 : encoderClose();
+    if (!ok) {
+        fprintf(stderr, "✗ Error writing %s\n", output);
+        return 1;
+    }
+
+    FILE *written = fopen(output, "rb");
+    fseek(written, 0, SEEK_END);
+    uint64_t outputBytes = (uint64_t)ftell(written);
+    fclose(written);
+    double seconds = (traceNowNs() - start) / 1e9;
+
+    printf("%s: %llu events, %.1f MB -> %.1f MB (%.2fx) in %.2f s (%.0f MB/s)\n",
+           toCsv ? "binary -> CSV" : "CSV -> binary", (unsigned long long)events,
+           inputBytes / (double)MB, outputBytes / (double)MB,
+           outputBytes > 0 ? inputBytes / (double)outputBytes : 0.0,
+           seconds, inputBytes / (double)MB / seconds);
+    if (!toCsv) {
+        printf("Blocks: %u of up to %llu events\n", encoder.header.blockCount,
+               (unsigned long long)blockEvents);
+    }
+    if (malformed > 0 || corrupt > 0 || encoder.skipped > 0) {
+        printf("Skipped: %llu malformed lines, %llu corrupt blocks, %llu mixed-kind events\n",
+               (unsigned long long)malformed, (unsigned long long)corrupt,
+               (unsigned long long)encoder.skipped);
+    }
+    return 0;
+}
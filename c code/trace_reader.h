@@ -0,0 +1,766 @@
+// ============================================================================
+// TRACE READER - Memory-Mapped, Zero-Copy Event Trace Parser
+// ============================================================================
+// Shared by the trace tools in this directory (header-only, like
+// event_log.h).
+//
+// Reads the event CSV written by the simulators (event_log.h) and by the
+// malloc trace shim (trace_shim.c), and the binary format of
+// trace_binary.h (recognised by its magic):
+//
+//   sequence,event,strategy,process_id,size_kb,block_index[,size_bytes,timestamp_ns,thread]
+//
+// Columns after block_index are the shim's unless the header line names
+// something else there, e.g. the web UI's export (js/trace.js) with its
+// trailing external_frag_kb; those lines are read as simulator events and
+// the extra columns are ignored. A file without a header is taken as is.
+//
+// The file is mmap'd and parsed where it lies; nothing is copied or
+// allocated per event. It is cut into chunks (at line boundaries, or one
+// per binary block), and parser threads turn chunks into arrays of
+// TraceEntry while the caller replays earlier ones (pipelined hand-off
+// through a ring of slots):
+//
+//   traceReaderOpen("trace.csv", 2, 4 << 20, 0);
+//   while ((entries = traceReaderNext(&count)) != NULL) {
+//       for (int i = 0; i < count; i++) replay(&entries[i]);
+//   }
+//   traceReaderClose();
+//
+// Chunks come back in file order whatever the number of threads. With 0
+// threads the caller parses each chunk itself. The mapping is advised
+// MADV_SEQUENTIAL, each chunk is prefetched (MADV_WILLNEED) when a parser
+// claims it and dropped (MADV_DONTNEED) once parsed, so resident memory
+// stays at a few chunks even for traces of many GB.
+//
+// Compile with: gcc -pthread <program>.c
+// ============================================================================
+
+#ifndef TRACE_READER_H
+#define TRACE_READER_H
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "trace_binary.h"
+
+#define TRACE_MAX_THREADS 64
+#define TRACE_MIN_LINE 16  // Shortest event line: "0,compact,-,,0,0"
+
+// Event types, numbered as in event_log.h
+typedef enum {
+    TRACE_ALLOCATE = 0,
+    TRACE_ALLOCATE_FAILED,
+    TRACE_DEALLOCATE,
+    TRACE_DEALLOCATE_FAILED,
+    TRACE_COALESCE,
+    TRACE_COMPACT,
+    TRACE_EVENT_TYPES
+} TraceEventType;
+
+static const char *traceEventNames[TRACE_EVENT_TYPES] = {
+    "allocate", "allocate_failed", "deallocate",
+    "deallocate_failed", "coalesce", "compact"
+};
+
+// Strategy column, numbered as EventStrategy / FitStrategy (0 = "-")
+#define TRACE_STRATEGY_MAX 4
+static const char *traceStrategyNames[TRACE_STRATEGY_MAX + 1] = {
+    "-", "first_fit", "next_fit", "best_fit", "worst_fit"
+};
+
+// One event. Shim traces (with a size_bytes column) name objects by hex
+// address, which is parsed into `object`; simulator traces name them by
+// process ID, which is left in the mapping (`name`, not NUL-terminated).
+typedef struct {
+    uint64_t sequence;
+    uint64_t size;           // Bytes
+    uint64_t object;         // Address, if name == NULL
+    uint64_t timestamp;      // ns, 0 if not recorded
+    const char *name;        // Process ID inside the mapped file, or NULL
+    uint32_t nameLength;
+    uint32_t thread;         // 0 if not recorded
+    uint8_t type;            // TraceEventType
+    uint8_t strategy;        // 0 = "-"
+} TraceEntry;
+
+typedef struct {
+    TraceEntry *entries;
+    int capacity;
+    int count;
+    long chunk;              // Chunk held, valid when ready
+    int ready;
+    uint64_t malformed;      // Lines, or events of a corrupt block
+    int corrupt;             // Binary block failed its checks
+} TraceSlot;
+
+// ============================================================================
+// READER STATE
+// ============================================================================
+static struct {
+    const char *data;        // Mapped file
+    size_t size;
+    size_t chunkBytes;
+    long chunkCount;
+
+    const TraceFileHeader *header;   // Binary traces only, else NULL
+    int shimColumns;                 // Text: columns 7+ are size_bytes,...
+    const TraceIndexEntry *index;
+    const char **names;              // Name table, indexed from 1
+    uint32_t *nameLengths;
+
+    TraceSlot *slots;        // Ring: chunk c is parsed into slots[c % ringSize]
+    int ringSize;
+    int threadCount;         // Parser threads (0 = parse in traceReaderNext)
+    pthread_t threads[TRACE_MAX_THREADS];
+
+    pthread_mutex_t lock;
+    pthread_cond_t parsed;   // Caller: a slot became ready
+    pthread_cond_t released; // Parsers: the caller finished a chunk
+    long nextChunk;          // Next chunk to claim
+    long returnedChunks;     // Chunks handed to the caller
+    long releasedChunks;     // Chunks the caller has finished with
+    int stopping;
+
+    uint64_t malformed;      // Lines skipped as unparseable (header excluded)
+    uint64_t corruptBlocks;  // Binary blocks skipped (bad checksum or encoding)
+    double waitNs;           // Time the caller spent waiting for parsers
+} traceReader;
+
+static double traceNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// ============================================================================
+// LINE PARSER
+// ============================================================================
+
+/**
+ * Decimal field at *p, leaves *p on the character after it
+ * @return: 1 if at least one digit was read
+ */
+static inline int traceParseDecimal(const char **p, const char *end, uint64_t *value) {
+    const char *s = *p;
+    uint64_t v = 0;
+    while (s < end && (unsigned)(*s - '0') < 10) {
+        v = v * 10 + (uint64_t)(*s++ - '0');
+    }
+    *value = v;
+    int ok = s != *p;
+    *p = s;
+    return ok;
+}
+
+/**
+ * Hex field in [s, end)
+ * @return: 1 if the whole field is hex digits
+ */
+static inline int traceParseHex(const char *s, const char *end, uint64_t *value) {
+    uint64_t v = 0;
+    if (s == end || end - s > 16) {
+        return 0;
+    }
+    for (; s < end; s++) {
+        unsigned c = (unsigned char)*s;
+        if ((c - '0' < 10) + ((c | 0x20) - 'a' < 6) == 0) {
+            return 0;
+        }
+        v = (v << 4) | ((c & 0xF) + 9 * (c >> 6));  // '0'-'9', 'a'-'f', 'A'-'F'
+    }
+    *value = v;
+    return 1;
+}
+
+/**
+ * Event type named by [s, s + length), told apart by length and first letter
+ * @return: TraceEventType, or -1 if unknown
+ */
+static inline int traceEventType(const char *s, size_t length) {
+    int type;
+    switch (length) {
+    case 7:  type = TRACE_COMPACT; break;
+    case 8:  type = s[0] == 'a' ? TRACE_ALLOCATE : TRACE_COALESCE; break;
+    case 10: type = TRACE_DEALLOCATE; break;
+    case 15: type = TRACE_ALLOCATE_FAILED; break;
+    case 17: type = TRACE_DEALLOCATE_FAILED; break;
+    default: return -1;
+    }
+    return memcmp(s, traceEventNames[type], length) == 0 ? type : -1;
+}
+
+/**
+ * Strategy named by [s, s + length)
+ * @return: strategy code (0 for "-"), or -1 if unknown
+ */
+static inline int traceStrategy(const char *s, size_t length) {
+    if (length == 1) {
+        return s[0] == '-' ? 0 : -1;
+    }
+    int strategy = s[0] == 'f' ? 1 : s[0] == 'n' ? 2 : s[0] == 'b' ? 3 : s[0] == 'w' ? 4 : 0;
+    return strategy > 0 && strlen(traceStrategyNames[strategy]) == length &&
+           memcmp(s, traceStrategyNames[strategy], length) == 0 ? strategy : -1;
+}
+
+/**
+ * End of the field starting at s (its comma, or end)
+ */
+static inline const char *traceFieldEnd(const char *s, const char *end) {
+    while (s < end && *s != ',') {
+        s++;
+    }
+    return s;
+}
+
+/**
+ * Parse one line [line, end) (no newline) into entry, in a single pass
+ * @return: 1 if parsed, 0 if malformed, -1 for a header or blank line
+ */
+static int traceParseLine(const char *line, const char *end, TraceEntry *entry) {
+    if (line == end || (unsigned)(*line - '0') >= 10) {
+        return -1;
+    }
+
+    const char *s = line;
+    if (!traceParseDecimal(&s, end, &entry->sequence) || s == end || *s++ != ',') {
+        return 0;
+    }
+
+    const char *fieldEnd = traceFieldEnd(s, end);
+    int type = traceEventType(s, (size_t)(fieldEnd - s));
+    if (type < 0 || fieldEnd == end) {
+        return 0;
+    }
+    s = fieldEnd + 1;
+
+    fieldEnd = traceFieldEnd(s, end);
+    int strategy = traceStrategy(s, (size_t)(fieldEnd - s));
+    if (strategy < 0 || fieldEnd == end) {
+        return 0;
+    }
+    s = fieldEnd + 1;
+
+    const char *id = s;
+    const char *idEnd = traceFieldEnd(s, end);
+    if (idEnd == end) {
+        return 0;
+    }
+    s = idEnd + 1;
+
+    uint64_t sizeKb;
+    if (!traceParseDecimal(&s, end, &sizeKb) || s == end || *s++ != ',') {
+        return 0;
+    }
+    s = traceFieldEnd(s, end);  // block_index (not replayed)
+
+    entry->type = (uint8_t)type;
+    entry->strategy = (uint8_t)strategy;
+
+    if (s == end || !traceReader.shimColumns) {
+        // Simulator (or web UI) trace: objects are process IDs, left in
+        // the mapping
+        entry->size = sizeKb * 1024;
+        entry->object = 0;
+        entry->timestamp = 0;
+        entry->thread = 0;
+        entry->name = id;
+        entry->nameLength = (uint32_t)(idEnd - id);
+        return 1;
+    }
+
+    // Shim trace: exact size_bytes, object ID is the block address in hex
+    s++;
+    if (!traceParseDecimal(&s, end, &entry->size) || (s != end && *s != ',') ||
+        !traceParseHex(id, idEnd, &entry->object)) {
+        return 0;
+    }
+    entry->name = NULL;
+    entry->nameLength = 0;
+
+    entry->timestamp = 0;
+    entry->thread = 0;
+    if (s != end) {
+        uint64_t thread = 0;
+        s++;
+        if (!traceParseDecimal(&s, end, &entry->timestamp) ||
+            (s != end && (*s++ != ',' || !traceParseDecimal(&s, end, &thread)))) {
+            return 0;
+        }
+        entry->thread = (uint32_t)thread;
+    }
+    return 1;
+}
+
+// ============================================================================
+// CHUNKS
+// ============================================================================
+
+/**
+ * Offset of the first line that starts at or after offset
+ */
+static size_t traceLineStart(size_t offset) {
+    if (offset == 0 || offset >= traceReader.size) {
+        return offset == 0 ? 0 : traceReader.size;
+    }
+    const char *newline = memchr(traceReader.data + offset - 1, '\n',
+                                 traceReader.size - (offset - 1));
+    return newline != NULL ? (size_t)(newline + 1 - traceReader.data) : traceReader.size;
+}
+
+/**
+ * Apply advice to the whole pages inside [start, end)
+ */
+static void traceAdvise(size_t start, size_t end, int advice) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    start = (start + page - 1) & ~(page - 1);
+    end &= ~(page - 1);
+    if (end > start) {
+        madvise((void *)(traceReader.data + start), end - start, advice);
+    }
+}
+
+/**
+ * Parse the lines that start inside chunk c into slot
+ */
+static void traceParseText(long c, TraceSlot *slot) {
+    size_t start = traceLineStart((size_t)c * traceReader.chunkBytes);
+    size_t stop = traceLineStart((size_t)(c + 1) * traceReader.chunkBytes);
+    traceAdvise(start, stop, MADV_WILLNEED);
+
+    const char *line = traceReader.data + start;
+    const char *end = traceReader.data + stop;
+    slot->count = 0;
+    slot->malformed = 0;
+
+    while (line < end) {
+        const char *newline = memchr(line, '\n', (size_t)(end - line));
+        const char *lineEnd = newline != NULL ? newline : end;
+        const char *textEnd = (lineEnd > line && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd;
+
+        if (slot->count == slot->capacity) {
+            slot->malformed++;  // Unreachable: event lines are >= TRACE_MIN_LINE bytes
+        } else {
+            int parsed = traceParseLine(line, textEnd, &slot->entries[slot->count]);
+            slot->count += parsed == 1;
+            slot->malformed += parsed == 0;
+        }
+        line = lineEnd + 1;
+    }
+
+    // Shim traces never need the text again; simulator traces keep their
+    // process IDs in the mapping, so their pages stay until replayed
+    if (slot->count == 0 || slot->entries[0].name == NULL) {
+        traceAdvise(start, stop, MADV_DONTNEED);
+    }
+}
+
+/**
+ * Decode binary block c into slot
+ * @return: 1 if successful, 0 if the block is damaged (slot left empty)
+ */
+static int traceDecodeBlock(long c, TraceSlot *slot) {
+    uint64_t offset = traceReader.index[c].offset;
+    TraceBlockHeader block;
+    if (offset > traceReader.size - sizeof(block)) {
+        return 0;
+    }
+    memcpy(&block, traceReader.data + offset, sizeof(block));  // Not aligned
+    slot->malformed = block.eventCount;  // Lost if anything below fails
+
+    size_t start = (size_t)offset + sizeof(block);
+    if (block.payloadBytes > traceReader.size - start || block.eventCount > (uint32_t)slot->capacity) {
+        return 0;
+    }
+    traceAdvise(start, start + block.payloadBytes, MADV_WILLNEED);
+
+    const unsigned char *p = (const unsigned char *)traceReader.data + start;
+    const unsigned char *end = p + block.payloadBytes;
+    if (traceCrc(p, block.payloadBytes) != block.checksum) {
+        return 0;
+    }
+
+    int timestamps = (traceReader.header->flags & TRACE_FILE_TIMESTAMPS) != 0;
+    int named = (traceReader.header->flags & TRACE_FILE_NAMED) != 0;
+    uint64_t sequence = UINT64_MAX;  // Deltas restart in every block
+    uint64_t object = 0;
+    uint64_t timestamp = 0;
+    uint64_t thread = 0;
+
+    for (uint32_t i = 0; i < block.eventCount; i++) {
+        TraceEntry *e = &slot->entries[i];
+        uint64_t value;
+        if (p == end) {
+            return 0;
+        }
+        unsigned tag = *p++;
+
+        sequence++;
+        if (tag & TRACE_TAG_SEQUENCE) {
+            if ((p = traceGetVarint(p, end, &value)) == NULL) return 0;
+            sequence += (uint64_t)traceUnzigzag(value);
+        }
+        if ((p = traceGetVarint(p, end, &value)) == NULL) return 0;
+        object += (uint64_t)traceUnzigzag(value);
+        if ((p = traceGetVarint(p, end, &e->size)) == NULL) return 0;
+        if (timestamps) {
+            if ((p = traceGetVarint(p, end, &value)) == NULL) return 0;
+            timestamp += (uint64_t)traceUnzigzag(value);
+        }
+        if (tag & TRACE_TAG_THREAD) {
+            if ((p = traceGetVarint(p, end, &thread)) == NULL) return 0;
+        }
+
+        e->sequence = sequence;
+        e->timestamp = timestamp;
+        e->thread = (uint32_t)thread;
+        e->type = tag & 7;
+        e->strategy = (tag >> 3) & 7;
+        if (e->type >= TRACE_EVENT_TYPES || e->strategy > TRACE_STRATEGY_MAX) {
+            return 0;
+        }
+        if (named) {
+            if (object == 0 || object > traceReader.header->nameCount) return 0;
+            e->object = 0;
+            e->name = traceReader.names[object];
+            e->nameLength = traceReader.nameLengths[object];
+        } else {
+            e->object = object;
+            e->name = NULL;
+            e->nameLength = 0;
+        }
+    }
+    if (p != end) {
+        return 0;
+    }
+
+    // Names live in the name table, so the block is never needed again
+    traceAdvise(start, start + block.payloadBytes, MADV_DONTNEED);
+    slot->count = (int)block.eventCount;
+    slot->malformed = 0;
+    return 1;
+}
+
+/**
+ * Parse chunk c (a range of lines, or a binary block) into slot
+ */
+static void traceParseChunk(long c, TraceSlot *slot) {
+    if (traceReader.header == NULL) {
+        traceParseText(c, slot);
+        slot->corrupt = 0;
+        return;
+    }
+    slot->count = 0;
+    slot->corrupt = !traceDecodeBlock(c, slot);
+    if (slot->corrupt) {
+        slot->count = 0;
+    }
+}
+
+static void *traceParserThread(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&traceReader.lock);
+    for (;;) {
+        long c = traceReader.nextChunk;
+        while (!traceReader.stopping && c < traceReader.chunkCount &&
+               c >= traceReader.releasedChunks + traceReader.ringSize) {
+            pthread_cond_wait(&traceReader.released, &traceReader.lock);
+        }
+        if (traceReader.stopping || c >= traceReader.chunkCount) {
+            break;
+        }
+        if (c != traceReader.nextChunk) {
+            continue;  // Another parser claimed it while we waited
+        }
+        traceReader.nextChunk++;
+        pthread_mutex_unlock(&traceReader.lock);
+
+        // The slot is ours: its previous chunk (c - ringSize) is done
+        TraceSlot *slot = &traceReader.slots[c % traceReader.ringSize];
+        traceParseChunk(c, slot);
+
+        pthread_mutex_lock(&traceReader.lock);
+        slot->chunk = c;
+        slot->ready = 1;
+        pthread_cond_broadcast(&traceReader.parsed);
+    }
+    pthread_mutex_unlock(&traceReader.lock);
+    return NULL;
+}
+
+/**
+ * Check a binary trace's header and index and load its name table
+ * @return: 1 if usable, 0 otherwise
+ */
+static int traceOpenBinary(void) {
+    const TraceFileHeader *header = (const TraceFileHeader *)traceReader.data;
+    size_t indexBytes = (size_t)header->blockCount * sizeof(TraceIndexEntry);
+    if (header->version != TRACE_VERSION || header->indexOffset % 8 != 0 ||
+        header->indexOffset > traceReader.size || indexBytes > traceReader.size - header->indexOffset ||
+        header->maxBlockEvents == 0 || header->maxBlockEvents > (1u << 24) ||
+        traceCrc(traceReader.data + header->indexOffset, indexBytes) != header->indexChecksum) {
+        return 0;
+    }
+    traceReader.header = header;
+    traceReader.index = (const TraceIndexEntry *)(traceReader.data + header->indexOffset);
+    traceReader.chunkCount = header->blockCount;
+
+    if (header->nameCount == 0) {
+        return 1;
+    }
+    if (header->namesOffset > header->indexOffset) {
+        return 0;
+    }
+    traceReader.names = malloc((header->nameCount + 1) * sizeof(const char *));
+    traceReader.nameLengths = malloc((header->nameCount + 1) * sizeof(uint32_t));
+    if (traceReader.names == NULL || traceReader.nameLengths == NULL) {
+        return 0;
+    }
+    const unsigned char *p = (const unsigned char *)traceReader.data + header->namesOffset;
+    const unsigned char *end = (const unsigned char *)traceReader.data + header->indexOffset;
+    for (uint32_t i = 1; i <= header->nameCount; i++) {
+        uint64_t length;
+        if ((p = traceGetVarint(p, end, &length)) == NULL || length > (uint64_t)(end - p)) {
+            return 0;
+        }
+        traceReader.names[i] = (const char *)p;
+        traceReader.nameLengths[i] = (uint32_t)length;
+        p += length;
+    }
+    return 1;
+}
+
+/**
+ * Binary block holding sequence: the last one starting at or before it
+ * (binary search on the index)
+ * @return: block number, or 0 for text traces
+ */
+static long traceFindBlock(uint64_t sequence) {
+    long low = 0;
+    long high = traceReader.header != NULL ? traceReader.chunkCount - 1 : 0;
+    while (low < high) {
+        long mid = (low + high + 1) / 2;
+        if (traceReader.index[mid].firstSequence <= sequence) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+/**
+ * Whether the columns after block_index are the shim's: true unless the
+ * file starts with a header whose seventh column is not size_bytes
+ */
+static int traceShimColumns(void) {
+    const char *line = traceReader.data;
+    if (traceReader.size == 0 || (unsigned)(*line - '0') < 10) {
+        return 1;
+    }
+    const char *newline = memchr(line, '\n', traceReader.size);
+    const char *end = newline != NULL ? newline : line + traceReader.size;
+    const char *s = line;
+    for (int column = 1; column < 7 && s < end; column++) {
+        s = traceFieldEnd(s, end) + 1;
+    }
+    if (s >= end) {
+        return 1;  // Six columns or fewer: nothing to tell apart
+    }
+    const char *fieldEnd = traceFieldEnd(s, end);
+    if (fieldEnd > s && fieldEnd[-1] == '\r') {
+        fieldEnd--;
+    }
+    return fieldEnd - s == 10 && memcmp(s, "size_bytes", 10) == 0;
+}
+
+/**
+ * Map a trace and start `threads` parser threads (0 = parse on demand)
+ * over chunks of about chunkBytes. Binary traces start at the block
+ * holding fromSequence; text traces always start at the beginning.
+ * @return: 1 if successful, 0 if the file cannot be read
+ */
+static int traceReaderOpen(const char *path, int threads, size_t chunkBytes,
+                           uint64_t fromSequence) {
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "✗ Cannot open trace %s\n", path);
+        if (fd >= 0) close(fd);
+        return 0;
+    }
+
+    memset(&traceReader, 0, sizeof(traceReader));
+    traceReader.size = (size_t)st.st_size;
+    traceReader.chunkBytes = chunkBytes < 4096 ? 4096 : chunkBytes;
+    traceReader.chunkCount = (long)((traceReader.size + traceReader.chunkBytes - 1) /
+                                    traceReader.chunkBytes);
+    traceReader.threadCount = threads < 0 ? 0 : (threads > TRACE_MAX_THREADS ? TRACE_MAX_THREADS : threads);
+    traceReader.ringSize = traceReader.threadCount == 0 ? 1 : 2 * traceReader.threadCount;
+
+    if (traceReader.size > 0) {
+        void *data = mmap(NULL, traceReader.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            fprintf(stderr, "✗ Cannot map trace %s\n", path);
+            close(fd);
+            return 0;
+        }
+        traceReader.data = data;
+        madvise(data, traceReader.size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    // Slots are sized once: a text chunk can hold at most one entry per
+    // TRACE_MIN_LINE bytes (plus the line running past its end)
+    int capacity = (int)(traceReader.chunkBytes / TRACE_MIN_LINE) + 2;
+    traceCrcInit();
+    if (traceReader.size >= sizeof(TraceFileHeader) &&
+        memcmp(traceReader.data, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0) {
+        if (!traceOpenBinary()) {
+            fprintf(stderr, "✗ Damaged binary trace %s\n", path);
+            free(traceReader.names);
+            free(traceReader.nameLengths);
+            munmap((void *)traceReader.data, traceReader.size);
+            return 0;
+        }
+        capacity = (int)traceReader.header->maxBlockEvents;
+
+        long first = traceFindBlock(fromSequence);
+        traceReader.nextChunk = first;
+        traceReader.returnedChunks = first;
+        traceReader.releasedChunks = first;
+    } else {
+        traceReader.shimColumns = traceShimColumns();
+    }
+    traceReader.slots = calloc((size_t)traceReader.ringSize, sizeof(TraceSlot));
+    for (int i = 0; traceReader.slots != NULL && i < traceReader.ringSize; i++) {
+        traceReader.slots[i].entries = malloc((size_t)capacity * sizeof(TraceEntry));
+        traceReader.slots[i].capacity = capacity;
+        if (traceReader.slots[i].entries == NULL) {
+            while (i-- > 0) free(traceReader.slots[i].entries);
+            free(traceReader.slots);
+            traceReader.slots = NULL;
+        }
+    }
+    if (traceReader.slots == NULL) {
+        fprintf(stderr, "✗ Out of memory for trace chunks\n");
+        free(traceReader.names);
+        free(traceReader.nameLengths);
+        if (traceReader.data != NULL) munmap((void *)traceReader.data, traceReader.size);
+        return 0;
+    }
+
+    pthread_mutex_init(&traceReader.lock, NULL);
+    pthread_cond_init(&traceReader.parsed, NULL);
+    pthread_cond_init(&traceReader.released, NULL);
+
+    for (int i = 0; i < traceReader.threadCount; i++) {
+        if (pthread_create(&traceReader.threads[i], NULL, traceParserThread, NULL) != 0) {
+            traceReader.threadCount = i;  // Run with the ones that started
+            break;
+        }
+    }
+    if (traceReader.threadCount == 0) {
+        traceReader.ringSize = 1;
+    }
+    return 1;
+}
+
+/**
+ * Entries of the next chunk, in file order. The array stays valid until
+ * the next call, which hands its slot back to the parsers.
+ * @return: entries (count may be 0 for a chunk of headers), or NULL at the end
+ */
+static const TraceEntry *traceReaderNext(int *count) {
+    long c = traceReader.returnedChunks;
+    TraceSlot *previous = traceReader.releasedChunks < c
+                        ? &traceReader.slots[(c - 1) % traceReader.ringSize] : NULL;
+
+    if (traceReader.threadCount == 0) {
+        if (previous != NULL) {
+            traceReader.malformed += previous->malformed;
+            traceReader.corruptBlocks += previous->corrupt;
+            traceReader.releasedChunks = c;
+        }
+        if (c >= traceReader.chunkCount) {
+            return NULL;
+        }
+        traceParseChunk(c, &traceReader.slots[0]);
+        traceReader.returnedChunks = c + 1;
+        *count = traceReader.slots[0].count;
+        return traceReader.slots[0].entries;
+    }
+
+    pthread_mutex_lock(&traceReader.lock);
+    if (previous != NULL) {
+        traceReader.malformed += previous->malformed;
+        traceReader.corruptBlocks += previous->corrupt;
+        previous->ready = 0;
+        traceReader.releasedChunks = c;
+        pthread_cond_broadcast(&traceReader.released);
+    }
+    if (c >= traceReader.chunkCount) {
+        pthread_mutex_unlock(&traceReader.lock);
+        return NULL;
+    }
+
+    TraceSlot *slot = &traceReader.slots[c % traceReader.ringSize];
+    if (!(slot->ready && slot->chunk == c)) {
+        double start = traceNowNs();
+        while (!(slot->ready && slot->chunk == c)) {
+            pthread_cond_wait(&traceReader.parsed, &traceReader.lock);
+        }
+        traceReader.waitNs += traceNowNs() - start;
+    }
+    traceReader.returnedChunks = c + 1;
+    pthread_mutex_unlock(&traceReader.lock);
+
+    *count = slot->count;
+    return slot->entries;
+}
+
+/**
+ * Stop the parser threads and unmap the trace
+ */
+static void traceReaderClose(void) {
+    pthread_mutex_lock(&traceReader.lock);
+    traceReader.stopping = 1;
+    pthread_cond_broadcast(&traceReader.released);
+    pthread_mutex_unlock(&traceReader.lock);
+
+    for (int i = 0; i < traceReader.threadCount; i++) {
+        pthread_join(traceReader.threads[i], NULL);
+    }
+    for (int i = 0; traceReader.slots != NULL && i < traceReader.ringSize; i++) {
+        free(traceReader.slots[i].entries);
+    }
+    free(traceReader.slots);
+    free(traceReader.names);
+    free(traceReader.nameLengths);
+    if (traceReader.data != NULL) {
+        munmap((void *)traceReader.data, traceReader.size);
+    }
+
+    pthread_cond_destroy(&traceReader.released);
+    pthread_cond_destroy(&traceReader.parsed);
+    pthread_mutex_destroy(&traceReader.lock);
+    traceReader.data = NULL;
+    traceReader.slots = NULL;
+    traceReader.names = NULL;
+    traceReader.nameLengths = NULL;
+}
+
+#endif // TRACE_READER_H
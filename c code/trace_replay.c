@@ -0,0 +1,461 @@
+// ============================================================================
+// TRACE REPLAY - Drive the Allocator Engine from a Recorded Event Trace
+// ============================================================================
+// Replays an event trace (a simulator's --events CSV, a real program's
+// malloc/free trace from trace_shim.c, or either one converted to the
+// binary format by trace_convert.c) against mm_engine.c and reports the
+// failed allocations and the fragmentation left behind, together with how
+// fast the trace was read and replayed.
+//
+// The trace is memory-mapped and parsed in place by trace_reader.h: parser
+// threads pre-parse chunks (or decode binary blocks) ahead of the replay
+// loop, which only ever sees ready arrays of events, so multi-GB traces
+// replay at engine speed. --from=SEQ starts part way through; binary
+// traces seek to it through their block index.
+//
+//   allocate            engineAllocate(strategy, owner, size)
+//   deallocate          engineDeallocateAt(block of that object)
+//   coalesce / compact  engineCoalesce() / engineCompact()
+//   *_failed            skipped (counted)
+//
+// Objects are shim addresses (hex) or simulator process IDs, interned with
+// name_table.h (grows with the trace). Each live object gets its own engine owner ID; at most
+// ENGINE_MAX_BLOCKS objects can be live, so raise it for real traces:
+//
+//   gcc -O2 -march=native -pthread -DENGINE_MAX_BLOCKS=1048576
+//       -o trace_replay trace_replay.c mm_engine.c
+//   ./trace_replay --strategy=best --heap-mb=8192 --threads=4 trace.csv
+//
+// Events are replayed in file order; sort multi-threaded shim traces by
+// sequence first (see trace_shim.c). Out-of-order sequence numbers are
+// counted and reported. --counters=PATH writes the engine's hot-path
+// counters as JSON at exit and on SIGUSR1 (engine_counters.h).
+//
+// --fast-bins=N turns on N engine fast bins of --bin-granule bytes each
+// (default 16, malloc_shim.c's alignment) and reports their hits, misses
+// and the bytes still parked in them at the end.
+//
+// --latency times every engine call and reports p50 .. p99.99 and max per
+// operation (latency_histogram.h). --latency-save=PATH keeps the
+// histograms; --latency-merge=PATH (repeatable) adds saved runs to the
+// report, so percentiles can be taken over many runs:
+//   ./trace_replay --latency-save=run1.hist trace1.mmtb
+//   ./trace_replay --latency-merge=run1.hist --latency-save=all.hist trace2.mmtb
+// ============================================================================
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mm_engine.h"
+#include "name_table.h"
+#include "trace_reader.h"
+#include "engine_counters.h"
+#include "latency_histogram.h"
+
+#define MB ((uint64_t)1 << 20)
+#define NAME_KEY ((uint64_t)1 << 63)  // Object key bit for interned process IDs
+#define EMPTY_KEY UINT64_MAX
+#define DEFERRED_THRESHOLD 64
+
+static const char *strategyNames[] = { "trace", "first", "next", "best", "worst" };
+static const char *coalesceNames[] = { "manual", "eager", "deferred" };
+
+// ============================================================================
+// LIVE OBJECTS
+// ============================================================================
+// Open addressing with linear probing and backward-shift deletion (no
+// tombstones, so heavy churn never degrades the probes). Sized once for
+// ENGINE_MAX_BLOCKS live objects at a load factor of at most 1/2.
+typedef struct {
+    uint64_t key;
+    EngineSize address;  // Block start when allocated
+    EngineSize size;
+    int owner;
+} LiveObject;
+
+static LiveObject *objects;
+static uint64_t objectMask;
+static int objectShift;
+static int *freeOwners;     // Stack of unused owner IDs
+static int freeOwnerCount;
+
+static inline uint64_t objectSlot(uint64_t key) {
+    return (key * 0x9E3779B97F4A7C15ull) >> objectShift;  // Fibonacci hashing
+}
+
+static int initObjects(void) {
+    uint64_t slots = 2;
+    objectShift = 63;
+    while (slots < 2 * (uint64_t)ENGINE_MAX_BLOCKS) {
+        slots <<= 1;
+        objectShift--;
+    }
+    objects = malloc(slots * sizeof(LiveObject));
+    freeOwners = malloc(ENGINE_MAX_BLOCKS * sizeof(int));
+    if (objects == NULL || freeOwners == NULL) {
+        return 0;
+    }
+    objectMask = slots - 1;
+    for (uint64_t i = 0; i < slots; i++) {
+        objects[i].key = EMPTY_KEY;
+    }
+    for (freeOwnerCount = 0; freeOwnerCount < ENGINE_MAX_BLOCKS; freeOwnerCount++) {
+        freeOwners[freeOwnerCount] = ENGINE_MAX_BLOCKS - freeOwnerCount;  // Pops 1 first
+    }
+    return 1;
+}
+
+/**
+ * Slot holding key, or the empty slot where it would go
+ */
+static inline uint64_t findObject(uint64_t key) {
+    uint64_t slot = objectSlot(key);
+    while (objects[slot].key != key && objects[slot].key != EMPTY_KEY) {
+        slot = (slot + 1) & objectMask;
+    }
+    return slot;
+}
+
+static void removeObject(uint64_t slot) {
+    // Pull later entries of the probe run back over the hole
+    uint64_t hole = slot;
+    for (uint64_t next = (hole + 1) & objectMask; objects[next].key != EMPTY_KEY;
+         next = (next + 1) & objectMask) {
+        uint64_t home = objectSlot(objects[next].key);
+        if (((next - home) & objectMask) >= ((next - hole) & objectMask)) {
+            objects[hole] = objects[next];
+            hole = next;
+        }
+    }
+    objects[hole].key = EMPTY_KEY;
+}
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+typedef enum {
+    OP_ALLOCATE,
+    OP_DEALLOCATE,
+    OP_COALESCE,
+    OP_COMPACT,
+    OP_COUNT
+} ReplayOp;
+
+static const char *opNames[OP_COUNT] = { "allocate", "deallocate", "coalesce", "compact" };
+static LatencyHistogram latency[OP_COUNT];
+static int latencyOn = 0;
+
+static NameTable names;  // Simulator process IDs seen in the trace
+
+static struct {
+    uint64_t events;
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t maintenance;       // Coalesce / compact events
+    uint64_t skipped;           // *_failed events
+    uint64_t failed;            // Allocations the engine could not place
+    uint64_t unknownFrees;      // Object not live
+    uint64_t duplicates;        // Object already live
+    uint64_t outOfOrder;        // Sequence lower than the previous event's
+    uint64_t liveBytes;
+    uint64_t peakLiveBytes;
+    uint64_t lastSequence;
+} replay;
+
+/**
+ * Object key of an entry: its address, or its interned process ID
+ * (exits if the name table cannot grow)
+ */
+static uint64_t entryKey(const TraceEntry *e) {
+    if (e->name == NULL) {
+        return e->object;
+    }
+    uint32_t id = nameIntern(&names, e->name, e->nameLength);
+    if (id == NO_NAME) {
+        fprintf(stderr, "✗ Out of memory for the name table (%u names)\n", names.count);
+        exit(1);
+    }
+    return NAME_KEY | id;
+}
+
+static void replayAllocate(const TraceEntry *e, int strategy, uint64_t key) {
+    uint64_t slot = findObject(key);
+    if (objects[slot].key != EMPTY_KEY) {
+        replay.duplicates++;
+        return;
+    }
+    if (freeOwnerCount == 0) {
+        replay.failed++;  // ENGINE_MAX_BLOCKS objects live
+        return;
+    }
+
+    int owner = freeOwners[freeOwnerCount - 1];
+    EngineSize size = e->size > 0 ? e->size : 1;  // malloc(0) still takes a block
+    uint64_t start = latencyOn ? latencyNow() : 0;
+    int index = engineAllocate(strategy, owner, size);
+    if (latencyOn) {
+        latencyRecord(&latency[OP_ALLOCATE], latencyElapsedNs(start));
+    }
+    if (index == -1) {
+        replay.failed++;
+        return;
+    }
+
+    freeOwnerCount--;
+    objects[slot].key = key;
+    objects[slot].address = engineBlockStart(index);
+    objects[slot].size = size;
+    objects[slot].owner = owner;
+    replay.liveBytes += size;
+    if (replay.liveBytes > replay.peakLiveBytes) {
+        replay.peakLiveBytes = replay.liveBytes;
+    }
+}
+
+static void replayDeallocate(uint64_t key) {
+    uint64_t slot = findObject(key);
+    if (objects[slot].key == EMPTY_KEY) {
+        replay.unknownFrees++;
+        return;
+    }
+
+    // Blocks only move on compaction; then fall back to the owner scan
+    int owner = objects[slot].owner;
+    uint64_t start = latencyOn ? latencyNow() : 0;
+    int index = engineBlockAt(objects[slot].address);
+    if (index == -1 || engineBlockOwner(index) != owner) {
+        engineDeallocate(owner);
+    } else {
+        engineDeallocateAt(index);
+    }
+    if (latencyOn) {
+        latencyRecord(&latency[OP_DEALLOCATE], latencyElapsedNs(start));
+    }
+    replay.liveBytes -= objects[slot].size;
+
+    freeOwners[freeOwnerCount++] = owner;
+    removeObject(slot);
+}
+
+static void replayEntry(const TraceEntry *e, int strategy) {
+    replay.events++;
+    replay.outOfOrder += e->sequence < replay.lastSequence;
+    replay.lastSequence = e->sequence;
+
+    if (strategy == FIT_NONE) {
+        strategy = e->strategy != FIT_NONE ? e->strategy : FIT_FIRST;
+    }
+
+    switch (e->type) {
+    case TRACE_ALLOCATE:
+    case TRACE_DEALLOCATE: {
+        uint64_t key = entryKey(e);
+        if (e->type == TRACE_ALLOCATE) {
+            replay.allocations++;
+            replayAllocate(e, strategy, key);
+        } else {
+            replay.deallocations++;
+            replayDeallocate(key);
+        }
+        break;
+    }
+    case TRACE_COALESCE:
+    case TRACE_COMPACT: {
+        replay.maintenance++;
+        uint64_t start = latencyOn ? latencyNow() : 0;
+        if (e->type == TRACE_COALESCE) {
+            engineCoalesce();
+        } else {
+            engineCompact();
+        }
+        if (latencyOn) {
+            latencyRecord(&latency[e->type == TRACE_COALESCE ? OP_COALESCE : OP_COMPACT],
+                          latencyElapsedNs(start));
+        }
+        break;
+    }
+    default:
+        replay.skipped++;
+        break;
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+static int parseChoice(const char *value, const char **names, int count) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(value, names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    int strategy = FIT_NONE;  // As recorded in the trace
+    int coalesce = COALESCE_DEFERRED;
+    uint64_t heapMb = 4096;
+    int threads = 2;
+    int fastBins = 0;
+    uint64_t binGranule = 16;
+    uint64_t chunkMb = 4;
+    uint64_t from = 0;
+    const char *path = NULL;
+    const char *countersOutput = NULL;
+    const char *latencyOutput = NULL;
+    int ok = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strncmp(arg, "--strategy=", 11) == 0) {
+            strategy = parseChoice(arg + 11, strategyNames, 5);
+        } else if (strncmp(arg, "--coalesce=", 11) == 0) {
+            coalesce = parseChoice(arg + 11, coalesceNames, 3);
+        } else if (strncmp(arg, "--heap-mb=", 10) == 0) {
+            heapMb = strtoull(arg + 10, NULL, 10);
+        } else if (strncmp(arg, "--threads=", 10) == 0) {
+            threads = atoi(arg + 10);
+        } else if (strncmp(arg, "--fast-bins=", 12) == 0) {
+            fastBins = atoi(arg + 12);
+        } else if (strncmp(arg, "--bin-granule=", 14) == 0) {
+            binGranule = strtoull(arg + 14, NULL, 10);
+        } else if (strncmp(arg, "--chunk-mb=", 11) == 0) {
+            chunkMb = strtoull(arg + 11, NULL, 10);
+        } else if (strncmp(arg, "--from=", 7) == 0) {
+            from = strtoull(arg + 7, NULL, 10);
+        } else if (strncmp(arg, "--counters=", 11) == 0) {
+            countersOutput = arg + 11;
+        } else if (strcmp(arg, "--latency") == 0) {
+            latencyOn = 1;
+        } else if (strncmp(arg, "--latency-save=", 15) == 0) {
+            latencyOn = 1;
+            latencyOutput = arg + 15;
+        } else if (strncmp(arg, "--latency-merge=", 16) == 0) {
+            latencyOn = 1;
+            ok = ok && latencyLoad(arg + 16, opNames, latency, OP_COUNT);
+        } else if (arg[0] != '-' && path == NULL) {
+            path = arg;
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!ok) {
+        return 1;
+    }
+    if (path == NULL || strategy < 0 || coalesce < 0 || heapMb == 0 || chunkMb == 0 ||
+        fastBins < 0 || fastBins > ENGINE_FAST_BINS || binGranule == 0) {
+        fprintf(stderr, "Usage: %s [--strategy=trace|first|next|best|worst] "
+                        "[--coalesce=manual|eager|deferred] [--heap-mb=N] "
+                        "[--fast-bins=0..%d] [--bin-granule=BYTES] [--threads=N] [--chunk-mb=N] [--from=SEQ] [--counters=PATH] "
+                        "[--latency] [--latency-save=PATH] [--latency-merge=PATH] TRACE\n",
+                argv[0], ENGINE_FAST_BINS);
+        return 1;
+    }
+    if (countersOutput &&
+        (!countersDumpAtExit(countersOutput) || !countersDumpOnSignal(countersOutput, SIGUSR1))) {
+        fprintf(stderr, "✗ Cannot dump counters to %s\n", countersOutput);
+        return 1;
+    }
+
+    if (!initObjects()) {
+        fprintf(stderr, "✗ Out of memory for the object table\n");
+        return 1;
+    }
+    engineInit(heapMb * MB);
+    engineSetCoalescePolicy(coalesce, DEFERRED_THRESHOLD);
+    engineSetFastBins(binGranule, fastBins, 0);
+    if (latencyOn) {
+        latencyClockInit();
+    }
+
+    double start = traceNowNs();
+    if (!traceReaderOpen(path, threads, chunkMb * MB, from)) {
+        return 1;
+    }
+    uint64_t traceBytes = traceReader.size;
+    long chunks = traceReader.chunkCount;
+    int binary = traceReader.header != NULL;
+
+    const TraceEntry *entries;
+    int count;
+    while ((entries = traceReaderNext(&count)) != NULL) {
+        for (int i = 0; i < count; i++) {
+            if (entries[i].sequence >= from) {
+                replayEntry(&entries[i], strategy);
+            }
+        }
+    }
+    double elapsed = traceNowNs() - start;
+    double waited = traceReader.waitNs;
+    uint64_t malformed = traceReader.malformed;
+    uint64_t corrupt = traceReader.corruptBlocks;
+    traceReaderClose();
+
+    engineUpdateStats();
+    int freeRuns;
+    EngineSize largestRun = engineLargestFreeRun(&freeRuns);
+    double seconds = elapsed / 1e9;
+
+    printf("\n========== TRACE REPLAY ==========\n");
+    printf("Trace:                     %s (%s, %.1f MB, %ld %s, %d parser threads)\n",
+           path, binary ? "binary" : "CSV", traceBytes / (double)MB, chunks,
+           binary ? "blocks" : "chunks", threads);
+    printf("Strategy:                  %s, coalescing %s, %llu MB heap, kernel %s\n",
+           strategyNames[strategy], coalesceNames[coalesce],
+           (unsigned long long)heapMb, engineScanKernel());
+    printf("Events:                    %llu (%llu allocate, %llu deallocate, "
+           "%llu coalesce/compact, %llu skipped)\n",
+           (unsigned long long)replay.events, (unsigned long long)replay.allocations,
+           (unsigned long long)replay.deallocations, (unsigned long long)replay.maintenance,
+           (unsigned long long)replay.skipped);
+    printf("Failed Allocations:        %llu\n", (unsigned long long)replay.failed);
+    printf("Unknown Frees:             %llu\n", (unsigned long long)replay.unknownFrees);
+    printf("Duplicate Allocations:     %llu\n", (unsigned long long)replay.duplicates);
+    if (replay.outOfOrder > 0) {
+        printf("Out-of-Order Events:       %llu (sort the trace by sequence)\n",
+               (unsigned long long)replay.outOfOrder);
+    }
+    if (malformed > 0 && !binary) {
+        printf("Malformed Lines:           %llu\n", (unsigned long long)malformed);
+    }
+    if (corrupt > 0) {
+        printf("Corrupt Blocks:            %llu (%llu events lost)\n",
+               (unsigned long long)corrupt, (unsigned long long)malformed);
+    }
+    if (fastBins > 0) {
+        int hits = engineFastBinHits();
+        int lookups = hits + engineFastBinMisses();
+        printf("Fast Bins:                 %d x %llu bytes, %d hits / %d misses (%.1f%%), "
+               "%d consolidations\n", fastBins, (unsigned long long)binGranule, hits,
+               engineFastBinMisses(), lookups > 0 ? hits * 100.0 / lookups : 0.0,
+               engineFastBinConsolidations());
+        printf("Parked in Bins:            %llu bytes (counted as used below)\n",
+               (unsigned long long)engineFastBinBytes());
+    }
+    printf("Peak Live Bytes:           %llu\n", (unsigned long long)replay.peakLiveBytes);
+    printf("Used / Free Memory:        %llu / %llu bytes\n",
+           (unsigned long long)engineUsedMemory(), (unsigned long long)engineFreeMemory());
+    // Free runs, not raw blocks: deferred coalescing may not have merged them yet
+    printf("Largest Free Run:          %llu bytes (%d runs of %d free blocks)\n",
+           (unsigned long long)largestRun, freeRuns, engineFreeBlockCount());
+    printf("Time:                      %.3f s (%.0f MB/s, %.2f M events/s), "
+           "%.3f s waiting for the parsers\n",
+           seconds, traceBytes / (double)MB / seconds, replay.events / 1e6 / seconds,
+           waited / 1e9);
+    if (latencyOn) {
+        latencyPrintTable(opNames, latency, OP_COUNT);
+    }
+    printf("==================================\n");
+
+    if (latencyOutput && !latencySave(latencyOutput, opNames, latency, OP_COUNT)) {
+        return 1;
+    }
+    return 0;
+}
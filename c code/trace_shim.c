@@ -0,0 +1,466 @@
+// ============================================================================
+// TRACE SHIM - Capture malloc/free Traces from Unmodified Programs
+// ============================================================================
+// An LD_PRELOAD interposer that records every malloc/calloc/realloc/free
+// (and the aligned variants) of a running process, then forwards the call
+// to glibc's allocator:
+//
+//   gcc -O2 -shared -fPIC -pthread -o libmmtrace.so trace_shim.c
+//   MM_TRACE_FILE=trace.%p.csv LD_PRELOAD=./libmmtrace.so ./my_program
+//
+// Output is the simulators' event CSV (event_log.h, js/trace.js) with
+// three more columns, so the web UI and the C replay read it as is:
+//
+//   sequence,event,strategy,process_id,size_kb,block_index,size_bytes,timestamp_ns,thread
+//
+//   event       allocate | allocate_failed | deallocate
+//   process_id  object ID: the block's address in hex (unique while live)
+//   size_kb     size_bytes rounded up to whole KB
+//   realloc     deallocate of the old object (logged before the call), then
+//               allocate of the new one
+//
+// Hot path: one relaxed atomic increment for the sequence number, a clock
+// read and a store into the calling thread's own buffer. Full buffers go
+// to a background flusher thread that formats and writes them, so no
+// call does I/O. Records are in sequence order within a thread; buffers of
+// different threads are written as they fill, so sort a multi-threaded
+// trace by the first column before replaying it:
+//   (head -1 t.csv; tail -n +2 t.csv | sort -t, -k1,1n) > sorted.csv
+//
+// Environment:
+//   MM_TRACE_FILE   output path, %p = process ID   (default malloc_trace.%p.csv)
+// Child processes stop tracing after fork() and start their own file on
+// exec(). Calls made while the shim itself is inside a call, or before it
+// is initialised, are passed through unrecorded.
+// ============================================================================
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TRACE_BUFFER_RECORDS 8192  // Records per thread buffer
+#define TRACE_LINE_MAX 128         // Longest formatted CSV line
+#define TRACE_WRITE_CHUNK (1 << 20)
+
+#define TLS __thread __attribute__((tls_model("initial-exec")))
+
+// glibc's own allocator entry points
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void *__libc_valloc(size_t size);
+extern void *__libc_pvalloc(size_t size);
+extern void __libc_free(void *ptr);
+
+// Event types, numbered as in event_log.h
+typedef enum {
+    TRACE_ALLOCATE = 0,
+    TRACE_ALLOCATE_FAILED = 1,
+    TRACE_DEALLOCATE = 2
+} TraceEvent;
+
+static const char *traceEventNames[] = { "allocate", "allocate_failed", "deallocate" };
+
+typedef struct {
+    uint64_t sequence;
+    uint64_t timestamp;  // CLOCK_MONOTONIC, ns
+    uint64_t object;     // Block address
+    uint64_t size;       // Bytes (0 for deallocate)
+    uint32_t thread;     // Kernel thread ID
+    uint32_t event;      // TraceEvent
+} TraceRecord;
+
+typedef struct TraceBuffer {
+    struct TraceBuffer *next;       // Flush queue / free list / registry link
+    struct TraceBuffer *nextThread; // Registry of thread buffers
+    int count;                      // Records below it are complete (release store)
+    TraceRecord records[TRACE_BUFFER_RECORDS];
+} TraceBuffer;
+
+static int traceFile = -1;
+static int traceReady = 0;
+static uint64_t traceSequence = 0;
+
+static pthread_t flusher;
+static pthread_mutex_t traceLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t traceFull = PTHREAD_COND_INITIALIZER;
+static TraceBuffer *flushQueue = NULL;   // Full buffers, oldest first
+static TraceBuffer *flushQueueTail = NULL;
+static TraceBuffer *spareBuffers = NULL; // Written buffers for reuse
+static TraceBuffer *threadBuffers = NULL;// Every thread's current buffer
+static int stopping = 0;                 // Set under traceLock by stopTrace()
+
+static TLS TraceBuffer *myBuffer = NULL;
+static TLS uint32_t myThread = 0;
+static TLS int insideShim = 0;           // Also set for the flusher thread
+
+// ============================================================================
+// RECORDING (calling thread)
+// ============================================================================
+
+static TraceBuffer *newBuffer(void) {
+    pthread_mutex_lock(&traceLock);
+    TraceBuffer *buffer = spareBuffers;
+    if (buffer != NULL) {
+        spareBuffers = buffer->next;
+    }
+    pthread_mutex_unlock(&traceLock);
+
+    if (buffer == NULL) {
+        void *mapped = mmap(NULL, sizeof(TraceBuffer), PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED) {
+            return NULL;
+        }
+        buffer = mapped;
+    }
+    buffer->next = NULL;
+    buffer->count = 0;
+    return buffer;
+}
+
+/**
+ * Queue the calling thread's full buffer for the flusher and take a new one
+ */
+static void handOffBuffer(void) {
+    TraceBuffer *full = myBuffer;
+    TraceBuffer *fresh = newBuffer();
+
+    pthread_mutex_lock(&traceLock);
+    if (stopping) {
+        // The flusher is gone and stopTrace() owns the registry: leave the
+        // buffer full where it is (this thread passed enter() before the
+        // stop, so it records nothing more)
+        if (fresh != NULL) {
+            fresh->next = spareBuffers;
+            spareBuffers = fresh;
+        }
+    } else if (fresh != NULL) {
+        // The fresh buffer takes the full one's place in the registry
+        for (TraceBuffer **link = &threadBuffers; *link; link = &(*link)->nextThread) {
+            if (*link == full) {
+                *link = fresh;
+                fresh->nextThread = full->nextThread;
+                break;
+            }
+        }
+        full->nextThread = NULL;
+        if (flushQueueTail) flushQueueTail->next = full; else flushQueue = full;
+        flushQueueTail = full;
+        pthread_cond_signal(&traceFull);
+        myBuffer = fresh;
+    } else {
+        myBuffer->count = 0;  // Out of memory: drop this buffer's records
+    }
+    pthread_mutex_unlock(&traceLock);
+}
+
+/**
+ * Append one event to the calling thread's buffer (no I/O)
+ */
+static void recordEvent(TraceEvent event, const void *object, uint64_t size) {
+    if (myBuffer == NULL) {
+        myBuffer = newBuffer();
+        if (myBuffer == NULL) {
+            return;
+        }
+        myThread = (uint32_t)syscall(SYS_gettid);
+        pthread_mutex_lock(&traceLock);
+        myBuffer->nextThread = threadBuffers;
+        threadBuffers = myBuffer;
+        pthread_mutex_unlock(&traceLock);
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    int count = myBuffer->count;
+    TraceRecord *r = &myBuffer->records[count];
+    r->sequence = __atomic_fetch_add(&traceSequence, 1, __ATOMIC_RELAXED);
+    r->timestamp = (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+    r->object = (uint64_t)(uintptr_t)object;
+    r->size = size;
+    r->thread = myThread;
+    r->event = (uint32_t)event;
+
+    __atomic_store_n(&myBuffer->count, count + 1, __ATOMIC_RELEASE);
+    if (count + 1 == TRACE_BUFFER_RECORDS) {
+        handOffBuffer();
+    }
+}
+
+// Whether this call should be recorded; if so the caller must leave()
+static int enter(void) {
+    if (!__atomic_load_n(&traceReady, __ATOMIC_ACQUIRE) || insideShim) {
+        return 0;
+    }
+    insideShim = 1;
+    return 1;
+}
+
+static void leave(void) {
+    insideShim = 0;
+}
+
+static void recordAllocation(const void *ptr, size_t size) {
+    recordEvent(ptr != NULL ? TRACE_ALLOCATE : TRACE_ALLOCATE_FAILED, ptr, size);
+}
+
+// ============================================================================
+// FLUSHER THREAD
+// ============================================================================
+
+static void writeAll(const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(traceFile, data, length);
+        if (written <= 0) {
+            return;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+}
+
+/**
+ * Format a buffer as CSV lines and write it (only the records published
+ * when it starts, if the owning thread may still be appending)
+ */
+static void writeBuffer(const TraceBuffer *buffer) {
+    static char text[TRACE_WRITE_CHUNK + TRACE_LINE_MAX];
+    size_t used = 0;
+    int count = __atomic_load_n(&buffer->count, __ATOMIC_ACQUIRE);
+
+    for (int i = 0; i < count; i++) {
+        const TraceRecord *r = &buffer->records[i];
+        used += (size_t)snprintf(text + used, TRACE_LINE_MAX,
+                                 "%llu,%s,-,%llx,%llu,-1,%llu,%llu,%u\n",
+                                 (unsigned long long)r->sequence,
+                                 traceEventNames[r->event],
+                                 (unsigned long long)r->object,
+                                 (unsigned long long)(r->size / 1024 + (r->size % 1024 != 0)),
+                                 (unsigned long long)r->size,
+                                 (unsigned long long)r->timestamp,
+                                 r->thread);
+        if (used >= TRACE_WRITE_CHUNK) {
+            writeAll(text, used);
+            used = 0;
+        }
+    }
+    writeAll(text, used);
+}
+
+static void *flusherThread(void *arg) {
+    (void)arg;
+    insideShim = 1;  // Never trace the flusher's own allocations
+
+    pthread_mutex_lock(&traceLock);
+    for (;;) {
+        while (flushQueue == NULL && !stopping) {
+            pthread_cond_wait(&traceFull, &traceLock);
+        }
+        if (flushQueue == NULL) {
+            break;
+        }
+
+        TraceBuffer *batch = flushQueue;
+        flushQueue = flushQueueTail = NULL;
+        pthread_mutex_unlock(&traceLock);
+
+        TraceBuffer *last = batch;
+        for (TraceBuffer *b = batch; b; b = b->next) {
+            writeBuffer(b);
+            last = b;
+        }
+
+        pthread_mutex_lock(&traceLock);
+        last->next = spareBuffers;
+        spareBuffers = batch;
+    }
+    pthread_mutex_unlock(&traceLock);
+    return NULL;
+}
+
+// ============================================================================
+// SETUP / TEARDOWN
+// ============================================================================
+
+static void stopTracingInChild(void) {
+    traceReady = 0;
+    traceFile = -1;
+}
+
+__attribute__((constructor))
+static void startTrace(void) {
+    insideShim = 1;
+
+    const char *pattern = getenv("MM_TRACE_FILE");
+    if (pattern == NULL || *pattern == '\0') {
+        pattern = "malloc_trace.%p.csv";
+    }
+
+    // Expand %p to the process ID
+    char path[4096];
+    size_t length = 0;
+    for (const char *c = pattern; *c && length < sizeof(path) - 24; c++) {
+        if (c[0] == '%' && c[1] == 'p') {
+            length += (size_t)snprintf(path + length, 24, "%d", (int)getpid());
+            c++;
+        } else {
+            path[length++] = *c;
+        }
+    }
+    path[length] = '\0';
+
+    traceFile = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (traceFile != -1) {
+        static const char header[] = "sequence,event,strategy,process_id,size_kb,"
+                                     "block_index,size_bytes,timestamp_ns,thread\n";
+        writeAll(header, sizeof(header) - 1);
+        if (pthread_create(&flusher, NULL, flusherThread, NULL) == 0) {
+            pthread_atfork(NULL, NULL, stopTracingInChild);
+            traceReady = 1;
+        }
+    }
+
+    insideShim = 0;
+}
+
+__attribute__((destructor))
+static void stopTrace(void) {
+    if (!traceReady) {
+        return;
+    }
+    insideShim = 1;
+    __atomic_store_n(&traceReady, 0, __ATOMIC_RELEASE);
+
+    pthread_mutex_lock(&traceLock);
+    stopping = 1;
+    pthread_cond_signal(&traceFull);
+    pthread_mutex_unlock(&traceLock);
+    pthread_join(flusher, NULL);
+
+    // Partly filled buffers of every thread that ever traced. Threads still
+    // running may be inside a call that passed enter() before the stop: the
+    // lock keeps them from swapping or registering buffers meanwhile, and
+    // writeBuffer() stops at the records they had published.
+    pthread_mutex_lock(&traceLock);
+    for (TraceBuffer *b = threadBuffers; b; b = b->nextThread) {
+        writeBuffer(b);
+    }
+    pthread_mutex_unlock(&traceLock);
+    close(traceFile);
+}
+
+// ============================================================================
+// INTERPOSED API
+// ============================================================================
+
+void *malloc(size_t size) {
+    void *ptr = __libc_malloc(size);
+    if (enter()) {
+        recordAllocation(ptr, size);
+        leave();
+    }
+    return ptr;
+}
+
+void *calloc(size_t count, size_t size) {
+    void *ptr = __libc_calloc(count, size);
+    if (enter()) {
+        size_t bytes;
+        if (__builtin_mul_overflow(count, size, &bytes)) {
+            bytes = SIZE_MAX;  // glibc failed it; record an impossible request
+        }
+        recordAllocation(ptr, bytes);
+        leave();
+    }
+    return ptr;
+}
+
+/**
+ * The old object is logged as freed before glibc can hand its address to
+ * another thread, as free() does; if the call then fails, old is still
+ * live and is logged as allocated again (at its usable size).
+ */
+void *realloc(void *old, size_t size) {
+    int tracing = old != NULL && enter();
+    if (tracing) {
+        recordEvent(TRACE_DEALLOCATE, old, 0);
+        leave();
+    }
+
+    void *ptr = __libc_realloc(old, size);
+    if (enter()) {
+        if (old == NULL || size != 0) {
+            recordAllocation(ptr, size);
+        }
+        if (tracing && ptr == NULL && size != 0) {
+            recordAllocation(old, malloc_usable_size(old));
+        }
+        leave();
+    }
+    return ptr;
+}
+
+void free(void *ptr) {
+    if (ptr != NULL && enter()) {
+        recordEvent(TRACE_DEALLOCATE, ptr, 0);
+        leave();
+    }
+    __libc_free(ptr);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    void *ptr = __libc_memalign(alignment, size);
+    if (enter()) {
+        recordAllocation(ptr, size);
+        leave();
+    }
+    return ptr;
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+void *valloc(size_t size) {
+    void *ptr = __libc_valloc(size);
+    if (enter()) {
+        recordAllocation(ptr, size);
+        leave();
+    }
+    return ptr;
+}
+
+void *pvalloc(size_t size) {
+    void *ptr = __libc_pvalloc(size);
+    if (enter()) {
+        recordAllocation(ptr, size);
+        leave();
+    }
+    return ptr;
+}
+
+int posix_memalign(void **memptr, size_t alignment, size_t size) {
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void *ptr = memalign(alignment, size);
+    if (ptr == NULL && size != 0) {
+        return ENOMEM;
+    }
+    *memptr = ptr;
+    return 0;
+}
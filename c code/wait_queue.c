@@ -0,0 +1,217 @@
+// ============================================================================
+// WAIT QUEUE - Size-Indexed Retry of Blocked Requests (see wait_queue.h)
+// ============================================================================
+// Requests live in a fixed node pool. Each size class has a doubly-linked
+// list kept in policy order (best first), so the best request of a class
+// is its head, and the best request of the boundary class that fits is
+// the first one in it that is small enough.
+//
+// No libc calls: this file must build with -nostdlib, like mm_engine.c.
+// ============================================================================
+
+#include <stdint.h>
+#include "wait_queue.h"
+
+#define WAIT_CLASSES 64
+
+typedef struct {
+    WaitRequest request;
+    uint64_t sequence;  // Arrival order, breaks every tie
+    int prev;
+    int next;
+} WaitNode;
+
+static WaitNode nodes[WAIT_MAX_REQUESTS];
+static int classHead[WAIT_CLASSES];
+static int classTail[WAIT_CLASSES];
+static uint64_t classMask = 0;  // Bit c set if class c has requests
+
+static int policy = WAIT_FIFO;
+static int freeNode = -1;       // Unused nodes, linked through next
+static int waiting = 0;
+static uint64_t nextSequence = 0;
+
+static uint64_t releases = 0;
+static uint64_t examined = 0;
+static uint64_t served = 0;
+
+/**
+ * Size class of a byte count: floor(log2(size)), class 0 for 0 and 1
+ */
+static int sizeClass(EngineSize size) {
+    return size > 1 ? 63 - __builtin_clzll(size) : 0;
+}
+
+/**
+ * Whether node a is served before node b under the current policy
+ */
+static int servedBefore(int a, int b) {
+    const WaitRequest *x = &nodes[a].request;
+    const WaitRequest *y = &nodes[b].request;
+
+    if (policy == WAIT_SJF && x->size != y->size) {
+        return x->size < y->size;
+    }
+    if (policy == WAIT_PRIORITY && x->priority != y->priority) {
+        return x->priority > y->priority;
+    }
+    return nodes[a].sequence < nodes[b].sequence;
+}
+
+// ============================================================================
+// SETUP
+// ============================================================================
+
+/**
+ * Empty the queue and choose how waiting requests are ordered
+ */
+void waitQueueInit(int queuePolicy) {
+    policy = queuePolicy;
+    for (int c = 0; c < WAIT_CLASSES; c++) {
+        classHead[c] = -1;
+        classTail[c] = -1;
+    }
+    for (int i = 0; i < WAIT_MAX_REQUESTS; i++) {
+        nodes[i].next = i + 1 < WAIT_MAX_REQUESTS ? i + 1 : -1;
+    }
+    freeNode = 0;
+    classMask = 0;
+    waiting = 0;
+    nextSequence = 0;
+    releases = 0;
+    examined = 0;
+    served = 0;
+}
+
+// ============================================================================
+// QUEUEING
+// ============================================================================
+
+/**
+ * Queue a blocked request. Later requests go behind earlier ones they tie
+ * with, so the list is walked from the tail.
+ * @return: 1 if queued, 0 if the queue is full
+ */
+int waitQueueAdd(const WaitRequest *request) {
+    if (freeNode < 0) {
+        return 0;
+    }
+
+    int n = freeNode;
+    freeNode = nodes[n].next;
+    nodes[n].request = *request;
+    nodes[n].request.index = -1;
+    nodes[n].sequence = nextSequence++;
+
+    int c = sizeClass(request->size);
+    int after = classTail[c];
+    while (after >= 0 && servedBefore(n, after)) {
+        after = nodes[after].prev;
+    }
+
+    int before = after >= 0 ? nodes[after].next : classHead[c];
+    nodes[n].prev = after;
+    nodes[n].next = before;
+    if (after >= 0) nodes[after].next = n; else classHead[c] = n;
+    if (before >= 0) nodes[before].prev = n; else classTail[c] = n;
+
+    classMask |= (uint64_t)1 << c;
+    waiting++;
+    return 1;
+}
+
+/**
+ * Unlink node n from its class and return it to the pool
+ */
+static void removeNode(int n) {
+    int c = sizeClass(nodes[n].request.size);
+    int prev = nodes[n].prev;
+    int next = nodes[n].next;
+
+    if (prev >= 0) nodes[prev].next = next; else classHead[c] = next;
+    if (next >= 0) nodes[next].prev = prev; else classTail[c] = prev;
+    if (classHead[c] < 0) {
+        classMask &= ~((uint64_t)1 << c);
+    }
+
+    nodes[n].next = freeNode;
+    freeNode = n;
+    waiting--;
+}
+
+/**
+ * Best waiting request no larger than budget: the best head among the
+ * classes below budget's class, against the first request of budget's own
+ * class that fits
+ * @return: node, or -1 if nothing fits
+ */
+static int bestFitting(EngineSize budget) {
+    int top = sizeClass(budget);
+    int best = -1;
+
+    for (int n = classHead[top]; n >= 0; n = nodes[n].next) {
+        examined++;
+        if (nodes[n].request.size <= budget) {
+            best = n;
+            break;
+        }
+    }
+
+    uint64_t below = classMask & (((uint64_t)1 << top) - 1);
+    while (below) {
+        int c = __builtin_ctzll(below);
+        below &= below - 1;
+        examined++;
+        if (best < 0 || servedBefore(classHead[c], best)) {
+            best = classHead[c];
+        }
+    }
+    return best;
+}
+
+/**
+ * Serve waiting requests after the block at address was freed. The free
+ * run around it bounds what can be served; each served request uses up
+ * its size from that budget. Stops at the first allocation that fails
+ * (e.g. the run is not merged under COALESCE_MANUAL).
+ * @return: number of requests served (written to served[], at most max)
+ */
+int waitQueueRelease(EngineSize address, WaitRequest *servedRequests, int max) {
+    releases++;
+    if (waiting == 0) {
+        return 0;
+    }
+
+    EngineSize budget = engineFreeRunAt(engineBlockAt(address));
+    int count = 0;
+
+    while (count < max && budget > 0) {
+        int n = bestFitting(budget);
+        if (n < 0) {
+            break;
+        }
+
+        WaitRequest *request = &nodes[n].request;
+        int index = engineAllocate(request->strategy, request->owner, request->size);
+        if (index < 0) {
+            break;
+        }
+
+        request->index = index;
+        servedRequests[count++] = *request;
+        budget -= request->size;
+        removeNode(n);
+    }
+
+    served += count;
+    return count;
+}
+
+// ============================================================================
+// INSPECTION
+// ============================================================================
+
+int waitQueueLength(void) { return waiting; }
+uint64_t waitQueueReleases(void) { return releases; }
+uint64_t waitQueueExamined(void) { return examined; }
+uint64_t waitQueueServed(void) { return served; }
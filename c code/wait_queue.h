@@ -0,0 +1,60 @@
+// ============================================================================
+// WAIT QUEUE - Blocked Allocation Requests, Retried When Memory Is Freed
+// ============================================================================
+// A request that finds no fit can wait here instead of failing. After
+// each free, waitQueueRelease() looks at the free run left at that address
+// (the freed block plus any free neighbours, merged or not) and serves
+// waiting requests that fit in it, best first by the queue's policy:
+//
+//   WAIT_FIFO      oldest request first
+//   WAIT_SJF       smallest request first (shortest job first)
+//   WAIT_PRIORITY  highest priority first, oldest first among equals
+//
+// Requests are indexed by size class (floor(log2(size))), and a 64-bit
+// mask records which classes are non-empty. A release only visits classes
+// at or below the class of the free run. Every class below it fits
+// entirely, so only its best request is compared; just the boundary class
+// is walked. Requests that cannot fit are never examined, which also means
+// a request that fits may overtake an older one that still does not.
+//
+// Times are the caller's clock, stored so the caller can compute waits.
+// Like mm_engine.c there is no I/O and no libc dependency:
+//   gcc -O2 -march=native tool.c mm_engine.c wait_queue.c
+// ============================================================================
+
+#ifndef WAIT_QUEUE_H
+#define WAIT_QUEUE_H
+
+#include <stdint.h>
+#include "mm_engine.h"
+
+#ifndef WAIT_MAX_REQUESTS
+#define WAIT_MAX_REQUESTS 65536  // Requests waiting at once (-D to override)
+#endif
+
+typedef enum {
+    WAIT_FIFO = 0,
+    WAIT_SJF = 1,
+    WAIT_PRIORITY = 2
+} WaitPolicy;
+
+typedef struct {
+    int owner;           // Engine owner ID to allocate for
+    int strategy;        // Fit strategy to allocate with
+    EngineSize size;
+    int priority;        // Higher is served first under WAIT_PRIORITY
+    double enqueued;     // Caller's clock when the request blocked
+    int index;           // Set when served: block allocated
+} WaitRequest;
+
+void waitQueueInit(int policy);
+int waitQueueAdd(const WaitRequest *request);  // 1 if queued, 0 if full
+int waitQueueRelease(EngineSize address, WaitRequest *served, int max);
+int waitQueueLength(void);
+
+// Work counters: releases, requests compared while choosing, and served
+uint64_t waitQueueReleases(void);
+uint64_t waitQueueExamined(void);
+uint64_t waitQueueServed(void);
+
+#endif // WAIT_QUEUE_H
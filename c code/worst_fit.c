@@ -17,7 +17,9 @@
 
 #define TOTAL_MEMORY 10240  // Total memory in KB
 #define MAX_BLOCKS 100      // Maximum number of memory blocks
-#define MAX_PROCESS_ID 10   // Max characters in process ID
+
+#include "event_log.h"
+#include "process_table.h"
 
 // ============================================================================
 // MEMORY BLOCK STRUCTURE
@@ -25,7 +27,7 @@
 typedef struct {
     int size;                      // Size of block in KB
     int isFree;                    // 1 = free, 0 = allocated
-    char processId[MAX_PROCESS_ID]; // Process ID (empty if free)
+    ProcessHandle owner;           // Owner (NO_PROCESS if free)
 } MemoryBlock;
 
 // Global memory blocks array
@@ -43,16 +45,18 @@ void initializeMemory() {
     blockCount = 0;
     memory[blockCount].size = TOTAL_MEMORY;
     memory[blockCount].isFree = 1;
-    strcpy(memory[blockCount].processId, "");
+    memory[blockCount].owner = NO_PROCESS;
     blockCount++;
     
-    printf("✓ Memory initialized: %d KB free\n\n", TOTAL_MEMORY);
+    LOG_SUMMARY("✓ Memory initialized: %d KB free\n\n", TOTAL_MEMORY);
 }
 
 /**
  * Display the entire memory layout
  */
 void displayMemoryLayout() {
+    if (logLevel < LOG_SUMMARY) return;
+
     printf("\n========== MEMORY LAYOUT (WORST FIT) ==========\n");
     printf("%-8s %-15s %-12s %-15s\n", "Block#", "Size (KB)", "Status", "Process ID");
     printf("---------------------------------------------\n");
@@ -62,7 +66,7 @@ void displayMemoryLayout() {
                i + 1,
                memory[i].size,
                memory[i].isFree ? "FREE" : "ALLOCATED",
-               memory[i].isFree ? "---" : memory[i].processId);
+               processName(memory[i].owner));
     }
     printf("==========================================\n");
 }
@@ -71,6 +75,8 @@ void displayMemoryLayout() {
  * Display memory statistics
  */
 void displayStatistics() {
+    if (logLevel < LOG_SUMMARY) return;
+
     int usedMemory = 0;
     int freeMemory = 0;
     int activeProcesses = 0;
@@ -123,27 +129,38 @@ void displayStatistics() {
  * - Provides more flexibility for future large allocations
  * - Avoids breaking large blocks into small unusable pieces
  *
- * @return: 1 if successful, 0 if failed
+ * @return: handle of the process, or NO_PROCESS if failed
  */
-int allocateWorstFit(char *processId, int requiredSize) {
+ProcessHandle allocateWorstFit(const char *processId, int requiredSize) {
     // Validation: size must be positive and within total memory
     if (requiredSize <= 0 || requiredSize > TOTAL_MEMORY) {
-        printf("✗ Invalid size: %d KB\n", requiredSize);
-        return 0;
+        LOG_OP("✗ Invalid size: %d KB\n", requiredSize);
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_WORST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
+    }
+
+    // Name → handle once; everything below compares integers
+    ProcessHandle process = internProcess(processId);
+    if (process == NO_PROCESS) {
+        LOG_OP("✗ Process table full\n");
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_WORST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
     }
 
     // Check if process already exists
     for (int i = 0; i < blockCount; i++) {
-        if (!memory[i].isFree && strcmp(memory[i].processId, processId) == 0) {
-            printf("✗ Process %s already allocated\n", processId);
-            return 0;
+        if (!memory[i].isFree && memory[i].owner == process) {
+            LOG_OP("✗ Process %s already allocated\n", processId);
+            logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_WORST_FIT, processId, requiredSize, -1);
+            return NO_PROCESS;
         }
     }
 
     // Check array bounds
     if (blockCount >= MAX_BLOCKS - 1) {
-        printf("✗ Memory block limit reached\n");
-        return 0;
+        LOG_OP("✗ Memory block limit reached\n");
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_WORST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
     }
 
     // WORST FIT: Scan ALL blocks to find the LARGEST suitable block
@@ -163,14 +180,15 @@ int allocateWorstFit(char *processId, int requiredSize) {
 
     // Check if suitable block was found
     if (worstIndex == -1) {
-        printf("✗ [Worst Fit] Cannot allocate %d KB to %s (no suitable block found)\n\n",
+        LOG_OP("✗ [Worst Fit] Cannot allocate %d KB to %s (no suitable block found)\n\n",
                requiredSize, processId);
-        return 0;
+        logEvent(EVENT_ALLOCATE_FAILED, STRATEGY_WORST_FIT, processId, requiredSize, -1);
+        return NO_PROCESS;
     }
 
-    printf("  [Worst Fit] Found worst-fit block %d (size %d KB) at position %d\n",
+    LOG_OP("  [Worst Fit] Found worst-fit block %d (size %d KB) at position %d\n",
            worstIndex + 1, memory[worstIndex].size, worstIndex);
-    printf("  This is the LARGEST block that can fit the process\n");
+    LOG_OP("  This is the LARGEST block that can fit the process\n");
 
     // Allocate to worst fit block
     if (memory[worstIndex].size > requiredSize) {
@@ -185,39 +203,44 @@ int allocateWorstFit(char *processId, int requiredSize) {
         // Set allocated block
         memory[worstIndex].size = requiredSize;
         memory[worstIndex].isFree = 0;
-        strcpy(memory[worstIndex].processId, processId);
+        memory[worstIndex].owner = process;
 
         // Set leftover free block (large, for future allocations)
         memory[worstIndex + 1].size = leftoverSize;
         memory[worstIndex + 1].isFree = 1;
-        strcpy(memory[worstIndex + 1].processId, "");
+        memory[worstIndex + 1].owner = NO_PROCESS;
 
         blockCount++;
     } 
     // Exact fit: no split needed
     else {
         memory[worstIndex].isFree = 0;
-        strcpy(memory[worstIndex].processId, processId);
+        memory[worstIndex].owner = process;
     }
 
-    printf("✓ [Worst Fit] Allocated %d KB to %s\n\n", requiredSize, processId);
-    return 1;
+    LOG_OP("✓ [Worst Fit] Allocated %d KB to %s\n\n", requiredSize, processId);
+
+    logEvent(EVENT_ALLOCATE, STRATEGY_WORST_FIT, processId, requiredSize, worstIndex);
+    return process;
 }
 
 /**
- * Deallocate memory from a process
+ * Deallocate memory from a process (handle returned by the allocate call)
+ * @return: 1 if successful, 0 if failed
  */
-int deallocateMemory(char *processId) {
+int deallocateMemory(ProcessHandle process) {
     for (int i = 0; i < blockCount; i++) {
-        if (!memory[i].isFree && strcmp(memory[i].processId, processId) == 0) {
+        if (!memory[i].isFree && memory[i].owner == process) {
             memory[i].isFree = 1;
-            strcpy(memory[i].processId, "");
-            printf("✓ Deallocated process %s\n", processId);
+            memory[i].owner = NO_PROCESS;
+            LOG_OP("✓ Deallocated process %s\n", processName(process));
+            logEvent(EVENT_DEALLOCATE, STRATEGY_NONE, processName(process), memory[i].size, i);
             return 1;
         }
     }
 
-    printf("✗ Process %s not found\n", processId);
+    LOG_OP("✗ Process %s not found\n", processName(process));
+    logEvent(EVENT_DEALLOCATE_FAILED, STRATEGY_NONE, processName(process), 0, -1);
     return 0;
 }
 
@@ -226,6 +249,7 @@ int deallocateMemory(char *processId) {
  */
 void coalesceMemory() {
     int i = 0;
+    int merges = 0;
     while (i < blockCount - 1) {
         if (memory[i].isFree && memory[i + 1].isFree) {
             // Merge adjacent free blocks
@@ -236,28 +260,35 @@ void coalesceMemory() {
                 memory[j] = memory[j + 1];
             }
             blockCount--;
+            merges++;
             // Don't increment i, continue checking for more merges
         } else {
             i++;
         }
     }
+
+    logEvent(EVENT_COALESCE, STRATEGY_NONE, "", merges, blockCount);
 }
 
 // ============================================================================
 // MAIN - DEMONSTRATION OF WORST FIT
 // ============================================================================
 
-int main() {
-    printf("\n");
-    printf("╔═══════════════════════════════════════════════════════════╗\n");
-    printf("║   WORST FIT MEMORY ALLOCATION - C Implementation          ║\n");
-    printf("║              Total Memory: 10240 KB                       ║\n");
-    printf("╚═══════════════════════════════════════════════════════════╝\n\n");
+int main(int argc, char *argv[]) {
+    if (!parseLogOptions(argc, argv)) {
+        return 1;
+    }
+
+    LOG_SUMMARY("\n");
+    LOG_SUMMARY("╔═══════════════════════════════════════════════════════════╗\n");
+    LOG_SUMMARY("║   WORST FIT MEMORY ALLOCATION - C Implementation          ║\n");
+    LOG_SUMMARY("║              Total Memory: 10240 KB                       ║\n");
+    LOG_SUMMARY("╚═══════════════════════════════════════════════════════════╝\n\n");
 
     initializeMemory();
 
     // ========== SCENARIO 1: Basic Allocation ==========
-    printf("--- SCENARIO 1: Basic Allocation with Worst Fit ---\n");
+    LOG_SUMMARY("--- SCENARIO 1: Basic Allocation with Worst Fit ---\n");
     allocateWorstFit("P1", 200);
     allocateWorstFit("P2", 150);
     allocateWorstFit("P3", 100);
@@ -265,58 +296,60 @@ int main() {
     displayStatistics();
 
     // ========== SCENARIO 2: Show Worst Fit advantage ==========
-    printf("\n--- SCENARIO 2: Worst Fit Advantage ---\n");
+    LOG_SUMMARY("\n--- SCENARIO 2: Worst Fit Advantage ---\n");
     initializeMemory();
-    printf("Allocating with Worst Fit to maximize large free blocks:\n");
-    allocateWorstFit("Q1", 500);  // [500] [9740]
-    allocateWorstFit("Q2", 400);  // [500] [400] [9340]
+    LOG_SUMMARY("Allocating with Worst Fit to maximize large free blocks:\n");
+    ProcessHandle q1 = allocateWorstFit("Q1", 500);  // [500] [9740]
+    ProcessHandle q2 = allocateWorstFit("Q2", 400);  // [500] [400] [9340]
     allocateWorstFit("Q3", 300);  // [500] [400] [300] [9040]
-    printf("\nNow deallocate Q1 and Q2:\n");
-    deallocateMemory("Q1");
-    deallocateMemory("Q2");
+    LOG_SUMMARY("\nNow deallocate Q1 and Q2:\n");
+    deallocateMemory(q1);
+    deallocateMemory(q2);
     coalesceMemory();
     displayMemoryLayout();
-    printf("\nNow try to allocate Q4 (700 KB) and Q5 (600 KB):\n");
+    LOG_SUMMARY("\nNow try to allocate Q4 (700 KB) and Q5 (600 KB):\n");
     allocateWorstFit("Q4", 700);  // Uses the 900 KB block (worst fit)
     allocateWorstFit("Q5", 600);  // Uses the next largest
     displayMemoryLayout();
     displayStatistics();
 
     // ========== SCENARIO 3: Comparison scenario ==========
-    printf("\n--- SCENARIO 3: Worst Fit vs Best Fit ---\n");
+    LOG_SUMMARY("\n--- SCENARIO 3: Worst Fit vs Best Fit ---\n");
     initializeMemory();
-    printf("Both algorithms starting with same scenario:\n");
+    LOG_SUMMARY("Both algorithms starting with same scenario:\n");
     allocateWorstFit("R1", 1000);
-    allocateWorstFit("R2", 800);
+    ProcessHandle r2 = allocateWorstFit("R2", 800);
     allocateWorstFit("R3", 1200);
     allocateWorstFit("R4", 600);
     displayMemoryLayout();
     displayStatistics();
 
-    printf("\nDeallocating R2:\n");
-    deallocateMemory("R2");
+    LOG_SUMMARY("\nDeallocating R2:\n");
+    deallocateMemory(r2);
     displayMemoryLayout();
-    printf("\nWorst Fit will prefer the 800 KB block (largest available)\n");
+    LOG_SUMMARY("\nWorst Fit will prefer the 800 KB block (largest available)\n");
     allocateWorstFit("R5", 750);
     displayMemoryLayout();
     displayStatistics();
 
     // ========== SCENARIO 4: Large allocation scenario ==========
-    printf("\n--- SCENARIO 4: Large Memory Allocations ---\n");
+    LOG_SUMMARY("\n--- SCENARIO 4: Large Memory Allocations ---\n");
     initializeMemory();
     allocateWorstFit("S1", 2000);
-    allocateWorstFit("S2", 1500);
+    ProcessHandle s2 = allocateWorstFit("S2", 1500);
     allocateWorstFit("S3", 2500);
-    deallocateMemory("S2");
+    deallocateMemory(s2);
     coalesceMemory();
-    printf("\nAfter deallocating S2 (1500 KB), trying to allocate S4 (1400 KB):\n");
+    LOG_SUMMARY("\nAfter deallocating S2 (1500 KB), trying to allocate S4 (1400 KB):\n");
     allocateWorstFit("S4", 1400);
     displayMemoryLayout();
     displayStatistics();
 
-    printf("\n╔═══════════════════════════════════════════════════════════╗\n");
-    printf("║               Worst Fit Simulation Complete               ║\n");
-    printf("╚═══════════════════════════════════════════════════════════╝\n\n");
+    LOG_SUMMARY("\n╔═══════════════════════════════════════════════════════════╗\n");
+    LOG_SUMMARY("║               Worst Fit Simulation Complete               ║\n");
+    LOG_SUMMARY("╚═══════════════════════════════════════════════════════════╝\n\n");
 
+    displayEventSummary();
+    eventLogClose();
     return 0;
 }
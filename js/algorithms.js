@@ -1,54 +1,66 @@
 /* ================================
-   HELPER: Allocate Block
+   ANIMATION
+   Allocations highlight the chosen block and apply after a delay.
+   With animation off they apply immediately (the search itself is
+   the same findFitIndex() the batch worker uses, see simcore.js).
 ================================ */
-function allocateBlock(index, pid, size, allocatedBy = null) {
-  const block = memory[index];
-  const remaining = block.size - size;
-
-  // Replace free block with allocated block
-  memory.splice(index, 1, {
-    size: size,
-    free: false,
-    pid: pid,
-    allocatedBy: allocatedBy
-  });
+const ANIMATION_DELAY = 500;
+let animationEnabled = true;
+let pendingAnimations = 0;   // allocations highlighted but not yet applied
 
-  // Insert remaining free block if any
-  if (remaining > 0) {
-    memory.splice(index + 1, 0, {
-      size: remaining,
-      free: true,
-      pid: null,
-      allocatedBy: null
-    });
+function setAnimation(enabled) {
+  animationEnabled = enabled;
+}
+
+function afterAnimation(callback) {
+  if (animationEnabled) {
+    pendingAnimations++;
+    setTimeout(() => {
+      pendingAnimations--;
+      callback();
+    }, ANIMATION_DELAY);
+  } else {
+    callback();
   }
 }
 
 /* ================================
-   FIRST FIT
+   HELPER: Allocate Block
 ================================ */
-function firstFit(pid, size) {
-  for (let i = 0; i < memory.length; i++) {
-    if (memory[i].free && memory[i].size >= size) {
+function allocateBlock(index, pid, size, allocatedBy = null) {
+  // Replace free block with allocated block + remaining free block if any
+  splitBlock(memory, index, pid, size, allocatedBy);
+}
 
-      highlightBlock(i);
+// Shared tail of every strategy: highlight, allocate, redraw, record
+function commitAllocation(index, pid, size, allocatedBy, onAllocated) {
+  highlightBlock(index);
 
-      setTimeout(() => {
-        allocateBlock(i, pid, size, "firstFit");
-        render();
+  afterAnimation(() => {
+    allocateBlock(index, pid, size, allocatedBy);
+    if (onAllocated) onAllocated();
+    render();
 
-        const stats = calculateStats();
-        updateChart(fragChart.data.labels.length + 1, stats.externalFrag);
+    const stats = calculateStats();
+    updateChart(nextChartStep(), stats.externalFrag);
+    logTraceEvent("allocate", allocatedBy, pid, size, index, stats.externalFrag);
 
-        // ✅ RECORD FINAL STATE AFTER ALLOCATION
-        recordStep();
+    // ✅ RECORD FINAL STATE AFTER ALLOCATION (only the split block changed)
+    recordStep("allocate", index, 1);
+  });
+}
 
-      }, 500);
+/* ================================
+   FIRST FIT
+================================ */
+function firstFit(pid, size) {
+  if (useWasmEngine()) return wasmFit("firstFit", pid, size);
 
-      return true;
-    }
-  }
-  return false;
+  const index = findFitIndex(memory, "firstFit", size);
+  if (index === -1) return false;
+
+  commitAllocation(index, pid, size, "firstFit");
+  return true;
 }
 
 
@@ -56,111 +68,41 @@ function firstFit(pid, size) {
    NEXT FIT (FIXED)
 ================================ */
 function nextFit(pid, size) {
-  const n = memory.length;
-  let count = 0;
-
-  while (count < n) {
-    if (memory[lastIndex].free && memory[lastIndex].size >= size) {
-
-      const allocIndex = lastIndex; // preserve index
-      highlightBlock(allocIndex);
-
-      setTimeout(() => {
-        allocateBlock(allocIndex, pid, size, "nextFit");
+  if (useWasmEngine()) return wasmFit("nextFit", pid, size);
 
-        // ✅ UPDATE lastIndex AFTER allocation
-        lastIndex = allocIndex + 1;
-        if (lastIndex >= memory.length) lastIndex = 0;
+  const allocIndex = findFitIndex(memory, "nextFit", size, lastIndex);
+  if (allocIndex === -1) return false;
 
-        render();
-
-        const stats = calculateStats();
-        updateChart(fragChart.data.labels.length + 1, stats.externalFrag);
-
-        // ✅ RECORD FINAL STATE AFTER ALLOCATION
-        recordStep();
-      }, 500);
-
-      return true;
-    }
-
-    lastIndex = (lastIndex + 1) % n;
-    count++;
-  }
-
-  return false;
+  commitAllocation(allocIndex, pid, size, "nextFit", () => {
+    // ✅ UPDATE lastIndex AFTER allocation
+    lastIndex = allocIndex + 1;
+    if (lastIndex >= memory.length) lastIndex = 0;
+  });
+  return true;
 }
 
 /* ================================
    BEST FIT
 ================================ */
 function bestFit(pid, size) {
-  let bestIndex = -1;
-  let minDiff = Infinity;
-
-  for (let i = 0; i < memory.length; i++) {
-    if (memory[i].free && memory[i].size >= size) {
-      const diff = memory[i].size - size;
-      if (diff < minDiff) {
-        minDiff = diff;
-        bestIndex = i;
-      }
-    }
-  }
-
-  if (bestIndex !== -1) {
-    highlightBlock(bestIndex);
-
-    setTimeout(() => {
-      allocateBlock(bestIndex, pid, size, "bestFit");
-      render();
+  if (useWasmEngine()) return wasmFit("bestFit", pid, size);
 
-      const stats = calculateStats();
-      updateChart(fragChart.data.labels.length + 1, stats.externalFrag);
+  const bestIndex = findFitIndex(memory, "bestFit", size);
+  if (bestIndex === -1) return false;
 
-      // ✅ RECORD FINAL STATE AFTER ALLOCATION
-        recordStep();
-    }, 500);
-
-    return true;
-  }
-
-  return false;
+  commitAllocation(bestIndex, pid, size, "bestFit");
+  return true;
 }
 
 /* ================================
    WORST FIT
 ================================ */
 function worstFit(pid, size) {
-  let worstIndex = -1;
-  let maxSize = -1;
-
-  for (let i = 0; i < memory.length; i++) {
-    if (memory[i].free && memory[i].size >= size) {
-      if (memory[i].size > maxSize) {
-        maxSize = memory[i].size;
-        worstIndex = i;
-      }
-    }
-  }
-
-  if (worstIndex !== -1) {
-    highlightBlock(worstIndex);
+  if (useWasmEngine()) return wasmFit("worstFit", pid, size);
 
-    setTimeout(() => {
-      allocateBlock(worstIndex, pid, size, "worstFit");
-      render();
-
-      const stats = calculateStats();
-      updateChart(fragChart.data.labels.length + 1, stats.externalFrag);
-
-      // ✅ RECORD FINAL STATE AFTER ALLOCATION
-        recordStep();
-        
-    }, 500);
-
-    return true;
-  }
+  const worstIndex = findFitIndex(memory, "worstFit", size);
+  if (worstIndex === -1) return false;
 
-  return false;
+  commitAllocation(worstIndex, pid, size, "worstFit");
+  return true;
 }
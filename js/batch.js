@@ -0,0 +1,160 @@
+/* ================================
+   BATCH MODE
+
+   runBatch(ops) applies thousands of operations in one go, without
+   animation, in a Web Worker (simworker.js). The worker answers with
+   splice patches; they are replayed into `memory` and the step log,
+   and the page redraws once per batch.
+
+   Batches never touch `memory` themselves; the worker (or the local
+   fallback) works on a copy, so runBatch(ops, false) doubles as a
+   what-if fork of the current heap.
+
+   When the page runs on the WASM engine the worker replays the batch
+   in its own engine instance, so the outcome matches interactive use.
+   If workers are unavailable (e.g. Chrome on file://, where the engine
+   cannot load either) the same applyBatch() runs on the main thread.
+================================ */
+let simWorker = null;      // null = not started, false = unavailable
+let batchRunning = false;
+let nextBatchId = 0;
+const pendingBatches = new Map();
+
+function getSimWorker() {
+  if (simWorker === null) {
+    try {
+      simWorker = new Worker("js/simworker.js");
+      simWorker.onmessage = event => {
+        const pending = pendingBatches.get(event.data.id);
+        pendingBatches.delete(event.data.id);
+        if (pending) pending.resolve(event.data);
+      };
+      simWorker.onerror = () => {
+        // Worker failed to load: finish anything in flight locally
+        simWorker = false;
+        pendingBatches.forEach(p =>
+          p.resolve(runBatchLocally(p.blocks, p.ops, p.nextFitIndex, p.recordPatches)));
+        pendingBatches.clear();
+      };
+    } catch (e) {
+      simWorker = false;
+    }
+  }
+  return simWorker || null;
+}
+
+/*
+ A batch's patches are applied to whatever `memory` holds when it
+ finishes, so nothing else may change memory while one is in flight:
+ interactive operations and playback are refused meanwhile, and a
+ batch does not start while an animated allocation is still pending.
+*/
+function refuseWhileBatchRunning() {
+  if (!batchRunning && !traceReplaying) return false;
+  alert("Wait for the running batch to finish");
+  return true;
+}
+
+function refuseBatchStart() {
+  if (batchRunning || traceReplaying) return true;
+  if (pendingAnimations === 0) return false;
+  alert("Wait for the pending allocation to finish");
+  return true;
+}
+
+function runBatchLocally(blocks, ops, nextFitIndex, recordPatches) {
+  return applyBatch(blocks.map(b => ({ ...b })), ops, nextFitIndex, recordPatches);
+}
+
+function runBatch(ops, recordPatches = true) {
+  const blocks = memory;
+  const nextFitIndex = lastIndex;
+  const engine = useWasmEngine();
+
+  return new Promise(resolve => {
+    const worker = getSimWorker();
+    if (!worker) {
+      resolve(runBatchLocally(blocks, ops, nextFitIndex, recordPatches));
+      return;
+    }
+
+    const id = ++nextBatchId;
+    pendingBatches.set(id, { resolve, blocks, ops, nextFitIndex, recordPatches });
+    worker.postMessage({ id, blocks, nextFitIndex, ops, recordPatches, engine });
+  });
+}
+
+// Replay the worker's patches into memory, the step log and the trace
+function applyBatchResult(result, ops) {
+  result.patches.forEach(p => {
+    if (p.op === "compact") {
+      memory = p.blocks;
+      recordStep("compact");
+    } else {
+      memory.splice(p.start, p.removed, ...p.blocks);
+      recordStep(p.op, p.start, p.removed);
+    }
+  });
+
+  ops.forEach((o, k) => {
+    const ok = result.results[k] === 1;
+    const event = o.op === "compact" ? "compact" : ok ? o.op : `${o.op}_failed`;
+    logTraceEvent(event, o.algo, o.pid, o.size, result.blockIndexes[k], result.fragmentation[k]);
+  });
+
+  lastIndex = result.nextFitIndex;
+  engineMemoryReplaced();
+  render();
+  appendChartPoints(Array.from(result.fragmentation));
+}
+
+/*
+ Random allocate/free workload with the selected algorithm:
+ ~60% allocations of 16-512 KB, ~40% frees of a process from this batch
+*/
+function randomBatchOps(count, algo) {
+  const ops = [];
+  const live = [];
+  const prefix = `B${nextBatchId + 1}_`;
+
+  for (let k = 0; k < count; k++) {
+    if (live.length === 0 || Math.random() < 0.6) {
+      const pid = prefix + k;
+      const size = 16 + Math.floor(Math.random() * 497);
+      ops.push({ op: "allocate", pid, size, algo });
+      live.push(pid);
+    } else {
+      const victim = Math.floor(Math.random() * live.length);
+      ops.push({ op: "deallocate", pid: live[victim] });
+      live[victim] = live[live.length - 1];
+      live.pop();
+    }
+  }
+  return ops;
+}
+
+const ALGORITHM_KEYS = { first: "firstFit", next: "nextFit", best: "bestFit", worst: "worstFit" };
+
+async function runRandomBatch() {
+  const count = parseInt(document.getElementById("batchCount").value);
+  if (isNaN(count) || count <= 0) {
+    alert("Enter a valid number of operations");
+    return;
+  }
+  if (refuseBatchStart()) return;
+  pauseSimulation();
+
+  const algo = ALGORITHM_KEYS[document.getElementById("algorithm").value];
+  const ops = randomBatchOps(count, algo);
+
+  batchRunning = true;
+  const started = performance.now();
+  const result = await runBatch(ops);
+  applyBatchResult(result, ops);
+  batchRunning = false;
+
+  const succeeded = result.results.reduce((sum, ok) => sum + ok, 0);
+  const elapsed = (performance.now() - started).toFixed(0);
+  document.getElementById("batchStatus").textContent =
+    `${count} operations (${count - succeeded} failed) in ${elapsed} ms`;
+}
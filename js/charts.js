@@ -1,29 +1,137 @@
+/* ================================
+   FRAGMENTATION CHART
+
+   Points go into a fixed-size ring buffer (the last
+   FRAG_HISTORY_CAPACITY steps), never into Chart.js directly.
+   At most one redraw per animation frame; it hands Chart.js at most
+   CHART_MAX_POINTS points, downsampled by keeping the min and max of
+   each bucket so spikes stay visible.
+================================ */
+const FRAG_HISTORY_CAPACITY = 65536;
+const CHART_MAX_POINTS = 600;
+
 let fragChart;
 
+const fragHistory = {
+  steps: new Float64Array(FRAG_HISTORY_CAPACITY),
+  values: new Float64Array(FRAG_HISTORY_CAPACITY),
+  head: 0,      // next write slot
+  count: 0,
+  lastStep: 0
+};
+
+let chartRedrawPending = false;
+
 function initChart() {
   const ctx = document.getElementById("fragChart").getContext("2d");
 
   fragChart = new Chart(ctx, {
     type: "line",
     data: {
-      labels: [],
       datasets: [{
         label: "External Fragmentation (KB)",
         data: [],
-        borderWidth: 2
+        borderWidth: 2,
+        pointRadius: 0
       }]
     },
     options: {
       responsive: true,
+      animation: false,
+      parsing: false,
+      normalized: true,
       scales: {
+        x: {
+          type: "linear",
+          ticks: { precision: 0, callback: value => `Step ${value}` }
+        },
         y: { beginAtZero: true }
       }
     }
   });
 }
 
+// Step number the next appended point gets
+function nextChartStep() {
+  return fragHistory.lastStep + 1;
+}
+
+function pushHistoryPoint(step, value) {
+  fragHistory.steps[fragHistory.head] = step;
+  fragHistory.values[fragHistory.head] = value;
+  fragHistory.head = (fragHistory.head + 1) % FRAG_HISTORY_CAPACITY;
+  if (fragHistory.count < FRAG_HISTORY_CAPACITY) fragHistory.count++;
+  fragHistory.lastStep = step;
+}
+
+// Min/max per bucket over the ring buffer, oldest first
+function downsampleHistory(maxPoints) {
+  const { steps, values, count } = fragHistory;
+  const oldest = (fragHistory.head - count + FRAG_HISTORY_CAPACITY) % FRAG_HISTORY_CAPACITY;
+  const at = k => (oldest + k) % FRAG_HISTORY_CAPACITY;
+  const points = [];
+
+  if (count <= maxPoints) {
+    for (let k = 0; k < count; k++) {
+      points.push({ x: steps[at(k)], y: values[at(k)] });
+    }
+    return points;
+  }
+
+  const bucket = Math.ceil(count / Math.floor(maxPoints / 2));
+  for (let from = 0; from < count; from += bucket) {
+    const to = Math.min(from + bucket, count);
+    let min = at(from);
+    let max = min;
+
+    for (let k = from + 1; k < to; k++) {
+      const i = at(k);
+      if (values[i] < values[min]) min = i;
+      if (values[i] > values[max]) max = i;
+    }
+
+    // Emit the pair in step order so the line doesn't double back
+    const [first, second] = steps[min] <= steps[max] ? [min, max] : [max, min];
+    points.push({ x: steps[first], y: values[first] });
+    if (second !== first) points.push({ x: steps[second], y: values[second] });
+  }
+  return points;
+}
+
+function scheduleChartRedraw() {
+  if (chartRedrawPending || !fragChart) return;
+  chartRedrawPending = true;
+
+  const redraw = () => {
+    chartRedrawPending = false;
+    fragChart.data.datasets[0].data = downsampleHistory(CHART_MAX_POINTS);
+    fragChart.update("none");
+  };
+
+  if (typeof requestAnimationFrame === "function") {
+    requestAnimationFrame(redraw);
+  } else {
+    setTimeout(redraw, 16);
+  }
+}
+
+function clearChart() {
+  fragHistory.head = 0;
+  fragHistory.count = 0;
+  fragHistory.lastStep = 0;
+  scheduleChartRedraw();
+}
+
+// Append many points with a single redraw (batch runs)
+function appendChartPoints(values) {
+  let step = nextChartStep();
+  for (let k = 0; k < values.length; k++) {
+    pushHistoryPoint(step++, values[k]);
+  }
+  scheduleChartRedraw();
+}
+
 function updateChart(step, value) {
-  fragChart.data.labels.push(`Step ${step}`);
-  fragChart.data.datasets[0].data.push(value);
-  fragChart.update();
+  pushHistoryPoint(step, value);
+  scheduleChartRedraw();
 }
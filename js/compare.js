@@ -1,6 +1,12 @@
 /* ================================
    PROCESS COMPARISON FOR ALL ALGORITHMS
 ================================ */
+const COMPARE_ALGORITHMS = [
+  { name: "First Fit", key: "firstFit" },
+  { name: "Next Fit", key: "nextFit" },
+  { name: "Best Fit", key: "bestFit" },
+  { name: "Worst Fit", key: "worstFit" }
+];
 
 // Find a process in memory by its exact PID
 function findProcessInMemory(pid) {
@@ -34,107 +40,34 @@ function compareProcessAlgorithms() {
   // Get the process size
   const processSize = processInfo.block.size;
 
-  // Test each algorithm with this process size
-  const results = {
-    firstFit: testFirstFitForSize(processSize),
-    nextFit: testNextFitForSize(processSize),
-    bestFit: testBestFitForSize(processSize),
-    worstFit: testWorstFitForSize(processSize)
-  };
+  // Test every algorithm with this process size in one scan
+  const results = testAllAlgorithmsForSize(processSize);
 
   // Display the comparison table
   displayComparisonTable(pid, processSize, results);
 }
 
-// Test First Fit for a given size
-function testFirstFitForSize(size) {
-  for (let i = 0; i < memory.length; i++) {
-    if (memory[i].free && memory[i].size >= size) {
-      const internalFrag = memory[i].size - size;
-      return {
-        canAllocate: true,
-        blockSize: memory[i].size,
-        internalFrag: internalFrag,
-        efficiency: ((size / memory[i].size) * 100).toFixed(2)
-      };
-    }
-  }
-  return { canAllocate: false };
-}
+// Candidate block of each algorithm for a given size
+function testAllAlgorithmsForSize(size) {
+  const fits = findAllFits(memory, size, lastIndex);
+  const results = {};
 
-// Test Next Fit for a given size
-function testNextFitForSize(size) {
-  const n = memory.length;
-  let count = 0;
-  let index = lastIndex;
-
-  while (count < n) {
-    if (memory[index].free && memory[index].size >= size) {
-      const internalFrag = memory[index].size - size;
-      return {
-        canAllocate: true,
-        blockSize: memory[index].size,
-        internalFrag: internalFrag,
-        efficiency: ((size / memory[index].size) * 100).toFixed(2)
-      };
+  Object.entries(fits).forEach(([algo, index]) => {
+    if (index === -1) {
+      results[algo] = { canAllocate: false };
+      return;
     }
-    index = (index + 1) % n;
-    count++;
-  }
-  return { canAllocate: false };
-}
-
-// Test Best Fit for a given size
-function testBestFitForSize(size) {
-  let bestIndex = -1;
-  let minDiff = Infinity;
 
-  for (let i = 0; i < memory.length; i++) {
-    if (memory[i].free && memory[i].size >= size) {
-      const diff = memory[i].size - size;
-      if (diff < minDiff) {
-        minDiff = diff;
-        bestIndex = i;
-      }
-    }
-  }
-
-  if (bestIndex !== -1) {
-    const internalFrag = memory[bestIndex].size - size;
-    return {
+    const blockSize = memory[index].size;
+    results[algo] = {
       canAllocate: true,
-      blockSize: memory[bestIndex].size,
-      internalFrag: internalFrag,
-      efficiency: ((size / memory[bestIndex].size) * 100).toFixed(2)
+      blockSize: blockSize,
+      internalFrag: blockSize - size,
+      efficiency: ((size / blockSize) * 100).toFixed(2)
     };
-  }
-  return { canAllocate: false };
-}
-
-// Test Worst Fit for a given size
-function testWorstFitForSize(size) {
-  let worstIndex = -1;
-  let maxSize = -1;
-
-  for (let i = 0; i < memory.length; i++) {
-    if (memory[i].free && memory[i].size >= size) {
-      if (memory[i].size > maxSize) {
-        maxSize = memory[i].size;
-        worstIndex = i;
-      }
-    }
-  }
+  });
 
-  if (worstIndex !== -1) {
-    const internalFrag = memory[worstIndex].size - size;
-    return {
-      canAllocate: true,
-      blockSize: memory[worstIndex].size,
-      internalFrag: internalFrag,
-      efficiency: ((size / memory[worstIndex].size) * 100).toFixed(2)
-    };
-  }
-  return { canAllocate: false };
+  return results;
 }
 
 // Display comparison as a table
@@ -168,12 +101,7 @@ function displayComparisonTable(pid, processSize, results) {
       <tbody>
   `;
 
-  const algorithms = [
-    { name: "First Fit", key: "firstFit" },
-    { name: "Next Fit", key: "nextFit" },
-    { name: "Best Fit", key: "bestFit" },
-    { name: "Worst Fit", key: "worstFit" }
-  ];
+  const algorithms = COMPARE_ALGORITHMS;
 
   algorithms.forEach(algo => {
     const result = results[algo.key];
@@ -202,6 +130,105 @@ function displayComparisonTable(pid, processSize, results) {
   container.innerHTML = html;
 }
 
+/* ================================
+   WHAT-IF: REPLAY PENDING QUEUE
+   Forks the current heap once per strategy and replays the requests
+   still waiting in processQueue (the latest entry for the pid is
+   requested or failed, and it is not in memory), oldest first. Runs in the batch worker, so large heaps
+   don't block the page.
+================================ */
+function pendingQueueRequests() {
+  const inMemory = new Set();
+  memory.forEach(b => { if (!b.free) inMemory.add(b.pid); });
+
+  // processQueue is newest first; only the latest entry of a pid counts
+  const seen = new Set();
+  const pending = [];
+  processQueue.forEach(q => {
+    if (seen.has(q.pid)) return;
+    seen.add(q.pid);
+    if ((q.status === "requested" || q.status === "failed") &&
+        q.size > 0 && !inMemory.has(q.pid)) {
+      pending.push({ pid: q.pid, size: q.size });
+    }
+  });
+  return pending.reverse();
+}
+
+async function compareWhatIf() {
+  const pending = pendingQueueRequests();
+  if (pending.length === 0) {
+    showCompareError("No pending requests in the process queue to replay");
+    return;
+  }
+
+  const container = document.getElementById("compareTableContainer");
+  container.innerHTML = `<div class="success-message">Replaying ${pending.length} pending request(s)…</div>`;
+
+  const runs = await Promise.all(COMPARE_ALGORITHMS.map(algo =>
+    runBatch(pending.map(p => ({ op: "allocate", pid: p.pid, size: p.size, algo: algo.key })), false)
+  ));
+
+  const results = {};
+  COMPARE_ALGORITHMS.forEach((algo, i) => {
+    const run = runs[i];
+    results[algo.key] = {
+      placed: run.results.reduce((sum, ok) => sum + ok, 0),
+      externalFrag: run.stats.externalFrag,
+      largestFree: run.stats.largestFree
+    };
+  });
+
+  displayWhatIfTable(pending.length, results);
+}
+
+// Best = most requests placed, then least external fragmentation
+function displayWhatIfTable(total, results) {
+  let bestAlgo = null;
+  COMPARE_ALGORITHMS.forEach(({ key }) => {
+    const r = results[key];
+    const best = bestAlgo && results[bestAlgo];
+    if (!best || r.placed > best.placed ||
+        (r.placed === best.placed && r.externalFrag < best.externalFrag)) {
+      bestAlgo = key;
+    }
+  });
+
+  let html = `
+    <div class="success-message">✓ Replayed ${total} pending request(s) from the current memory state</div>
+    <table class="compare-table">
+      <thead>
+        <tr>
+          <th>Algorithm</th>
+          <th>Placed</th>
+          <th>External Fragment (KB)</th>
+          <th>Largest Free (KB)</th>
+        </tr>
+      </thead>
+      <tbody>
+  `;
+
+  COMPARE_ALGORITHMS.forEach(algo => {
+    const r = results[algo.key];
+    const isBest = algo.key === bestAlgo;
+
+    html += `<tr${isBest ? ' style="background: #fffacd;"' : ""}>
+      <td class="algo-name">${algo.name}${isBest ? ' ⭐' : ''}</td>
+      <td class="${r.placed === total ? 'status-success' : 'status-failure'}">${r.placed} / ${total}</td>
+      <td>${r.externalFrag}</td>
+      <td>${r.largestFree}</td>
+    </tr>`;
+  });
+
+  html += `
+      </tbody>
+    </table>
+  `;
+
+  const container = document.getElementById("compareTableContainer");
+  container.innerHTML = html;
+}
+
 // Show error message
 function showCompareError(message) {
   const container = document.getElementById("compareTableContainer");
@@ -0,0 +1,214 @@
+/* ================================
+   WASM ENGINE BINDING
+
+   When wasm/mm_engine.wasm is available (built from c code/mm_engine.c,
+   see the command in mm_engine.h) every allocation, free, coalesce and
+   compaction runs in the C engine. The `memory` array is then only a
+   view that is refreshed after each operation, so render() and
+   calculateStats() read the C engine's state.
+
+   The engine counts 64-bit bytes (BigInt on this side of the boundary);
+   the page works in KB, converted by toEngineBytes / fromEngineBytes.
+
+   Without the .wasm file (or when opened via file://, where fetch is
+   blocked) the JS algorithms in algorithms.js are used unchanged.
+================================ */
+const WASM_ENGINE_URL = "wasm/mm_engine.wasm";
+
+// allocatedBy ↔ engine strategy code (FitStrategy in mm_engine.h;
+// "sample" is a caller-defined tag for preloaded blocks)
+const ENGINE_TAGS = [null, "firstFit", "nextFit", "bestFit", "worstFit", "sample"];
+const ENGINE_SAMPLE_TAG = 5;
+
+let wasmEngine = null;
+
+// False while the page holds more blocks than the engine's block array
+// (ENGINE_MAX_BLOCKS); the JS algorithms then run on `memory` until the
+// next wholesale replacement fits again
+let engineInSync = false;
+
+function toEngineBytes(kb) {
+  return BigInt(kb) * 1024n;
+}
+
+function fromEngineBytes(bytes) {
+  return Number(bytes / 1024n);
+}
+
+// Process IDs are interned to integer owners; the engine never sees strings
+const ownerIds = new Map();
+const ownerNames = [null];
+
+function useWasmEngine() {
+  return wasmEngine !== null && engineInSync;
+}
+
+function internPid(pid) {
+  let owner = ownerIds.get(pid);
+  if (owner === undefined) {
+    owner = ownerNames.length;
+    ownerIds.set(pid, owner);
+    ownerNames.push(pid);
+  }
+  return owner;
+}
+
+async function loadWasmEngine() {
+  if (typeof WebAssembly === "undefined" || location.protocol === "file:") {
+    return false;
+  }
+
+  try {
+    const response = await fetch(WASM_ENGINE_URL);
+    if (!response.ok) return false;
+
+    const { instance } = await WebAssembly.instantiate(
+      await response.arrayBuffer(),
+      { env: {}, wasi_snapshot_preview1: { proc_exit() {} } }
+    );
+    wasmEngine = instance.exports;
+  } catch (e) {
+    console.info("WASM engine unavailable, using JS algorithms:", e);
+    return false;
+  }
+
+  engineMemoryReplaced();
+  render();
+  return true;
+}
+
+/* ================================
+   SYNC: JS view ↔ engine
+================================ */
+
+// Pull the engine's blocks into the JS `memory` view
+function engineSyncMemory() {
+  const count = wasmEngine.engineBlockCount();
+  const view = new Array(count);
+
+  for (let i = 0; i < count; i++) {
+    const free = wasmEngine.engineBlockIsFree(i) === 1;
+    view[i] = {
+      size: fromEngineBytes(wasmEngine.engineBlockSize(i)),
+      free: free,
+      pid: free ? null : ownerNames[wasmEngine.engineBlockOwner(i)],
+      allocatedBy: free ? null : ENGINE_TAGS[wasmEngine.engineBlockAllocatedBy(i)]
+    };
+  }
+
+  memory = view;
+  lastIndex = wasmEngine.engineNextFitPointer();
+}
+
+// Push the JS `memory` array into the engine after it was replaced
+// wholesale (reset, sample load, playback, seeking)
+function engineMemoryReplaced() {
+  if (wasmEngine === null) return;
+
+  wasmEngine.engineClear(toEngineBytes(TOTAL_MEMORY));
+  engineInSync = memory.every(b => {
+    const tag = ENGINE_TAGS.indexOf(b.allocatedBy);
+    return wasmEngine.engineAppendBlock(
+      toEngineBytes(b.size),
+      b.free ? 1 : 0,
+      b.free ? 0 : internPid(b.pid),
+      tag > 0 ? tag : ENGINE_SAMPLE_TAG
+    ) === 1;
+  });
+
+  if (engineInSync) {
+    wasmEngine.engineSetNextFitPointer(lastIndex);
+  } else {
+    engineOutOfBlocks();
+  }
+}
+
+// The engine cannot hold the current layout: keep `memory` as the
+// authoritative state and hand operations back to the JS algorithms
+function engineOutOfBlocks() {
+  engineInSync = false;
+  console.warn(`WASM engine block array full (${memory.length} blocks), using JS algorithms`);
+}
+
+/* ================================
+   OPERATIONS
+================================ */
+
+// Same flow as firstFit/nextFit/bestFit/worstFit, with the engine choosing
+// and splitting the block
+function wasmFit(algo, pid, size) {
+  const strategy = ENGINE_TAGS.indexOf(algo);
+  const index = wasmEngine.engineFindBlock(strategy, toEngineBytes(size));
+  if (index === -1) return false;
+
+  highlightBlock(index);
+
+  afterAnimation(() => {
+    const placed = wasmEngine.engineAllocateAt(
+      index, internPid(pid), toEngineBytes(size), strategy) === 1;
+
+    if (placed) {
+      engineSyncMemory();
+    } else if (memory[index] && memory[index].free && memory[index].size >= size) {
+      // The block still fits, so only the split ran out of engine slots
+      engineOutOfBlocks();
+      allocateBlock(index, pid, size, algo);
+      if (algo === "nextFit") lastIndex = (index + 1) % memory.length;
+    } else {
+      markQueueStatus(pid, 'failed', { reason: 'Block no longer available', size });
+      logTraceEvent("allocate_failed", algo, pid, size, -1, calculateStats().externalFrag);
+      render();
+      return;
+    }
+    render();
+
+    const stats = calculateStats();
+    updateChart(nextChartStep(), stats.externalFrag);
+    logTraceEvent("allocate", algo, pid, size, index, stats.externalFrag);
+
+    recordStep("allocate", index, 1);
+  });
+
+  return true;
+}
+
+// Free every block owned by pid; returns the freed indexes
+function wasmDeallocate(pid) {
+  const freed = [];
+  if (!ownerIds.has(pid)) return freed;
+
+  const owner = ownerIds.get(pid);
+  let index;
+  while ((index = wasmEngine.engineDeallocate(owner)) !== -1) {
+    freed.push(index);
+  }
+
+  engineSyncMemory();
+  return freed;
+}
+
+function wasmCoalesce() {
+  wasmEngine.engineCoalesce();
+  engineSyncMemory();
+}
+
+function wasmCompact() {
+  wasmEngine.engineCompact();
+  engineSyncMemory();
+}
+
+function wasmStats() {
+  wasmEngine.engineUpdateStats();
+
+  const free = fromEngineBytes(wasmEngine.engineFreeMemory());
+  const largestFree = fromEngineBytes(wasmEngine.engineLargestFreeBlock());
+
+  return {
+    total: TOTAL_MEMORY,
+    used: fromEngineBytes(wasmEngine.engineUsedMemory()),
+    free,
+    active: wasmEngine.engineActiveProcesses(),
+    largestFree,
+    externalFrag: free - largestFree
+  };
+}
@@ -0,0 +1,382 @@
+/* ================================
+   CANVAS MEMORY MAP
+
+   Draws the memory layout on a canvas instead of one DOM element per
+   block, so cost depends on the canvas width rather than the number
+   of blocks:
+   - only the visible address range [viewStart, viewEnd) is drawn
+     (scroll to zoom around the cursor, drag to pan, double-click to
+     reset)
+   - pixel columns that contain a block boundary are drawn as one
+     aggregate column shaded by how much of it is allocated
+   - after an operation only the address range whose blocks changed
+     is redrawn
+================================ */
+const MAP_HEIGHT = 80;          // CSS pixels
+const MAP_LABEL_MIN_WIDTH = 48; // CSS pixels needed to print a label
+
+const MAP_TAGS = ["free", "firstFit", "nextFit", "bestFit", "worstFit", "sample"];
+const MAP_COLORS = ["#cbd5e1", "#ef4444", "#3b82f6", "#10b981", "#f59e0b", "#8b5cf6"];
+const MAP_MIXED_USED = [71, 85, 105]; // #475569, aggregate column fully used
+const MAP_MIXED_FREE = [203, 213, 225]; // #cbd5e1, aggregate column fully free
+
+const memoryMap = {
+  canvas: null,
+  ctx: null,
+  dpr: 1,
+  width: 0,   // device pixels
+  height: 0,  // device pixels
+
+  viewStart: 0,
+  viewEnd: TOTAL_MEMORY,
+
+  // Layout of the last drawn memory state
+  count: 0,
+  starts: new Float64Array(0),
+  sizes: new Float64Array(0),
+  tags: new Uint8Array(0),
+  pids: [],
+  allocatedBy: [], // kept to detect re-tagged blocks
+  usedPrefix: new Float64Array(1), // used KB before block i
+
+  highlight: -1,
+  fullRedrawPending: false
+};
+
+function initMemoryMap() {
+  const canvas = document.getElementById("memory");
+  memoryMap.canvas = canvas;
+  memoryMap.ctx = canvas.getContext("2d");
+
+  canvas.addEventListener("wheel", onMapWheel, { passive: false });
+  canvas.addEventListener("mousedown", onMapDragStart);
+  canvas.addEventListener("mousemove", onMapHover);
+  canvas.addEventListener("dblclick", () => setMapView(0, TOTAL_MEMORY));
+  window.addEventListener("resize", resizeMemoryMap);
+
+  resizeMemoryMap();
+}
+
+function resizeMemoryMap() {
+  const map = memoryMap;
+  map.dpr = window.devicePixelRatio || 1;
+  map.width = Math.max(1, Math.round(map.canvas.clientWidth * map.dpr));
+  map.height = Math.round(MAP_HEIGHT * map.dpr);
+  map.canvas.width = map.width;
+  map.canvas.height = map.height;
+  drawMapRange(map.viewStart, map.viewEnd);
+}
+
+/* ================================
+   LAYOUT (addresses + dirty range)
+================================ */
+
+const MAP_TAG_CODES = { firstFit: 1, nextFit: 2, bestFit: 3, worstFit: 4, sample: 5 };
+
+function tagOf(block) {
+  if (block.free) return 0;
+  return MAP_TAG_CODES[block.allocatedBy] || 5;
+}
+
+// Sync the cached layout with `memory`; returns the changed address
+// range [start, end), or null if nothing changed.
+// Operations replace a short run of blocks, so the unchanged prefix and
+// suffix are found by comparison and only the run in between is rebuilt
+// (the suffix is moved with a typed-array copy).
+function updateMapLayout() {
+  const map = memoryMap;
+  const n = memory.length;
+  const oldCount = map.count;
+
+  const same = (oldIndex, block) =>
+    map.sizes[oldIndex] === block.size &&
+    map.pids[oldIndex] === block.pid &&
+    (map.tags[oldIndex] === 0) === block.free &&
+    map.allocatedBy[oldIndex] === block.allocatedBy;
+
+  let first = 0;
+  while (first < oldCount && first < n && same(first, memory[first])) first++;
+
+  let tail = 0;
+  while (tail < oldCount - first && tail < n - first &&
+         same(oldCount - 1 - tail, memory[n - 1 - tail])) {
+    tail++;
+  }
+
+  if (first === oldCount && first === n) return null;
+
+  const oldEnd = first < oldCount - tail
+    ? map.starts[oldCount - 1 - tail] + map.sizes[oldCount - 1 - tail]
+    : null;
+  const oldSuffixUsed = map.usedPrefix[oldCount - tail];
+
+  // Resize the arrays, keeping the prefix and moving the suffix
+  if (n !== oldCount) {
+    const starts = new Float64Array(n);
+    const sizes = new Float64Array(n);
+    const tags = new Uint8Array(n);
+    const usedPrefix = new Float64Array(n + 1);
+
+    starts.set(map.starts.subarray(0, first));
+    sizes.set(map.sizes.subarray(0, first));
+    tags.set(map.tags.subarray(0, first));
+    usedPrefix.set(map.usedPrefix.subarray(0, first + 1));
+
+    starts.set(map.starts.subarray(oldCount - tail, oldCount), n - tail);
+    sizes.set(map.sizes.subarray(oldCount - tail, oldCount), n - tail);
+    tags.set(map.tags.subarray(oldCount - tail, oldCount), n - tail);
+    usedPrefix.set(map.usedPrefix.subarray(oldCount - tail + 1, oldCount + 1), n - tail + 1);
+
+    const gap = new Array(n - tail - first);
+    map.pids = map.pids.slice(0, first).concat(gap, map.pids.slice(oldCount - tail));
+    map.allocatedBy = map.allocatedBy.slice(0, first).concat(gap, map.allocatedBy.slice(oldCount - tail));
+    map.starts = starts;
+    map.sizes = sizes;
+    map.tags = tags;
+    map.usedPrefix = usedPrefix;
+    map.count = n;
+  }
+
+  // Rebuild the changed run
+  let address = first > 0 ? map.starts[first - 1] + map.sizes[first - 1] : 0;
+  for (let i = first; i < n - tail; i++) {
+    const b = memory[i];
+    map.starts[i] = address;
+    map.sizes[i] = b.size;
+    map.tags[i] = tagOf(b);
+    map.pids[i] = b.pid;
+    map.allocatedBy[i] = b.allocatedBy;
+    map.usedPrefix[i + 1] = map.usedPrefix[i] + (b.free ? 0 : b.size);
+    address += b.size;
+  }
+
+  // Allocated KB before each suffix block shifts by the run's change
+  const usedDelta = map.usedPrefix[n - tail] - oldSuffixUsed;
+  if (usedDelta !== 0) {
+    for (let j = n - tail + 1; j <= n; j++) map.usedPrefix[j] += usedDelta;
+  }
+
+  const dirtyStart = first < n ? map.starts[first] : address;
+  return [dirtyStart, Math.max(address, oldEnd === null ? address : oldEnd)];
+}
+
+// Index of the block containing address (largest i with starts[i] <= address)
+function mapBlockAt(address) {
+  const starts = memoryMap.starts;
+  let lo = 0;
+  let hi = memoryMap.count - 1;
+  while (lo < hi) {
+    const mid = (lo + hi + 1) >> 1;
+    if (starts[mid] <= address) lo = mid;
+    else hi = mid - 1;
+  }
+  return lo;
+}
+
+// Allocated KB in [0, address)
+function mapUsedBefore(address) {
+  const map = memoryMap;
+  if (map.count === 0) return 0;
+  const i = mapBlockAt(address);
+  const inside = Math.min(address - map.starts[i], map.sizes[i]);
+  return map.usedPrefix[i] + (map.tags[i] !== 0 ? inside : 0);
+}
+
+/* ================================
+   DRAWING
+================================ */
+
+function mapX(address) {
+  const map = memoryMap;
+  return (address - map.viewStart) / (map.viewEnd - map.viewStart) * map.width;
+}
+
+function mapAddress(x) {
+  const map = memoryMap;
+  return map.viewStart + x / map.width * (map.viewEnd - map.viewStart);
+}
+
+// Redraw the pixel columns covering the address range [start, end)
+function drawMapRange(start, end) {
+  const map = memoryMap;
+  const ctx = map.ctx;
+  if (!ctx) return;
+
+  const x0 = Math.max(0, Math.floor(mapX(start)));
+  const x1 = Math.min(map.width, Math.ceil(mapX(end)));
+  if (x1 <= x0) return;
+
+  ctx.save();
+  ctx.beginPath();
+  ctx.rect(x0, 0, x1 - x0, map.height);
+  ctx.clip();
+  ctx.clearRect(x0, 0, x1 - x0, map.height);
+
+  let x = x0;
+  while (x < x1 && map.count > 0) {
+    const i = mapBlockAt(mapAddress(x));
+    const blockEndX = mapX(map.starts[i] + map.sizes[i]);
+
+    if (blockEndX >= x + 1) {
+      // Block covers whole columns: draw them as one solid run
+      const runEnd = Math.min(x1, Math.floor(blockEndX));
+      ctx.fillStyle = MAP_COLORS[map.tags[i]];
+      ctx.fillRect(x, 0, runEnd - x, map.height);
+      drawMapLabel(i);
+      x = runEnd;
+    } else {
+      // Several blocks share this column: shade by allocated fraction
+      const a = mapAddress(x);
+      const b = mapAddress(x + 1);
+      const used = (mapUsedBefore(b) - mapUsedBefore(a)) / (b - a);
+      const rgb = MAP_MIXED_FREE.map((c, k) =>
+        Math.round(c + (MAP_MIXED_USED[k] - c) * used));
+      ctx.fillStyle = `rgb(${rgb[0]}, ${rgb[1]}, ${rgb[2]})`;
+      ctx.fillRect(x, 0, 1, map.height);
+      x++;
+    }
+  }
+
+  drawMapHighlight();
+  ctx.restore();
+}
+
+function drawMapLabel(i) {
+  const map = memoryMap;
+  const ctx = map.ctx;
+  const left = Math.max(0, mapX(map.starts[i]));
+  const right = Math.min(map.width, mapX(map.starts[i] + map.sizes[i]));
+  if (right - left < MAP_LABEL_MIN_WIDTH * map.dpr) return;
+
+  const center = (left + right) / 2;
+  const name = map.tags[i] === 0 ? "FREE" : map.pids[i];
+
+  ctx.fillStyle = map.tags[i] === 0 ? "#1f2937" : "#ffffff";
+  ctx.font = `600 ${11 * map.dpr}px sans-serif`;
+  ctx.textAlign = "center";
+  ctx.fillText(name, center, map.height / 2 - 2 * map.dpr, right - left - 4);
+  ctx.fillText(`${map.sizes[i]} KB`, center, map.height / 2 + 12 * map.dpr, right - left - 4);
+
+  // Block separator
+  ctx.fillStyle = "rgba(0, 0, 0, 0.15)";
+  ctx.fillRect(Math.floor(right) - 1, 0, 1, map.height);
+}
+
+function drawMapHighlight() {
+  const map = memoryMap;
+  const i = map.highlight;
+  if (i < 0 || i >= map.count) return;
+
+  const left = mapX(map.starts[i]);
+  const right = mapX(map.starts[i] + map.sizes[i]);
+  const lineWidth = 3 * map.dpr;
+  map.ctx.strokeStyle = "yellow";
+  map.ctx.lineWidth = lineWidth;
+  map.ctx.strokeRect(left + lineWidth / 2, lineWidth / 2,
+                     Math.max(1, right - left - lineWidth), map.height - lineWidth);
+}
+
+function updateMapRuler() {
+  const map = memoryMap;
+  const labels = document.querySelectorAll(".ruler-label");
+  const span = map.viewEnd - map.viewStart;
+  labels.forEach((label, k) => {
+    const address = map.viewStart + span * k / (labels.length - 1);
+    label.textContent = `${Math.round(address)} KB`;
+  });
+}
+
+/* ================================
+   PUBLIC: render + highlight
+================================ */
+
+// Called from render(): redraw only what the last operation changed
+function drawMemoryMap() {
+  const map = memoryMap;
+
+  // A re-render clears the allocation highlight (as rebuilding the
+  // DOM blocks used to)
+  let highlighted = null;
+  if (map.highlight >= 0 && map.highlight < map.count) {
+    const i = map.highlight;
+    highlighted = [map.starts[i], map.starts[i] + map.sizes[i]];
+  }
+  map.highlight = -1;
+
+  const dirty = updateMapLayout();
+  if (dirty) drawMapRange(dirty[0], dirty[1]);
+  if (highlighted) drawMapRange(highlighted[0], highlighted[1]);
+}
+
+function highlightMapBlock(index) {
+  const map = memoryMap;
+  const previous = map.highlight;
+  map.highlight = index;
+
+  if (previous >= 0 && previous < map.count) {
+    drawMapRange(map.starts[previous], map.starts[previous] + map.sizes[previous]);
+  }
+  if (index >= 0 && index < map.count) {
+    drawMapRange(map.starts[index], map.starts[index] + map.sizes[index]);
+  }
+}
+
+/* ================================
+   ZOOM / PAN
+================================ */
+
+function setMapView(start, end) {
+  const map = memoryMap;
+  const minSpan = Math.min(TOTAL_MEMORY, map.width / map.dpr / 8);
+  let span = Math.max(minSpan, Math.min(TOTAL_MEMORY, end - start));
+  start = Math.max(0, Math.min(TOTAL_MEMORY - span, start));
+
+  map.viewStart = start;
+  map.viewEnd = start + span;
+
+  // Coalesce wheel/drag events into one redraw per frame
+  if (map.fullRedrawPending) return;
+  map.fullRedrawPending = true;
+  requestAnimationFrame(() => {
+    map.fullRedrawPending = false;
+    drawMapRange(map.viewStart, map.viewEnd);
+    updateMapRuler();
+  });
+}
+
+function onMapWheel(event) {
+  event.preventDefault();
+  const map = memoryMap;
+  const x = event.offsetX * map.dpr;
+  const anchor = mapAddress(x);
+  const factor = event.deltaY < 0 ? 0.8 : 1.25;
+  const span = (map.viewEnd - map.viewStart) * factor;
+  const start = anchor - (x / map.width) * span;
+  setMapView(start, start + span);
+}
+
+function onMapDragStart(event) {
+  const map = memoryMap;
+  const originX = event.clientX;
+  const originStart = map.viewStart;
+  const span = map.viewEnd - map.viewStart;
+
+  const onMove = e => {
+    const shift = (originX - e.clientX) * map.dpr / map.width * span;
+    setMapView(originStart + shift, originStart + shift + span);
+  };
+  const onUp = () => {
+    window.removeEventListener("mousemove", onMove);
+    window.removeEventListener("mouseup", onUp);
+  };
+  window.addEventListener("mousemove", onMove);
+  window.addEventListener("mouseup", onUp);
+}
+
+function onMapHover(event) {
+  const map = memoryMap;
+  if (map.count === 0) return;
+  const i = mapBlockAt(mapAddress(event.offsetX * map.dpr));
+  const name = map.tags[i] === 0 ? "FREE" : map.pids[i];
+  map.canvas.title = `${name}: ${map.sizes[i]} KB @ ${map.starts[i]} KB`;
+}
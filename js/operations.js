@@ -23,6 +23,8 @@ function clearQueue() {
 }
 
 function allocateProcess() {
+  if (refuseWhileBatchRunning()) return;
+
   const pid = document.getElementById("pid").value;
   const size = parseInt(document.getElementById("size").value);
   const algo = document.getElementById("algorithm").value;
@@ -36,11 +38,6 @@ function allocateProcess() {
   // add to queue
   addQueueEvent(pid, size, algo);
 
-  // ✅ Record state BEFORE allocation (for Play / Playback)
-  if (typeof recordStep === "function") {
-    recordStep();
-  }
-
   let success = false;
 
   // Allocation based on selected algorithm
@@ -66,8 +63,11 @@ function allocateProcess() {
       return;
   }
 
-  if (!success) {
+  if (success) {
+    markQueueStatus(pid, 'allocated', { size, algo });
+  } else {
     markQueueStatus(pid, 'failed', { reason: 'Not enough memory', size });
+    logTraceEvent("allocate_failed", ALGORITHM_KEYS[algo], pid, size, -1, calculateStats().externalFrag);
     alert("Allocation Failed: Not enough memory");
   }
 }
@@ -77,6 +77,8 @@ function allocateProcess() {
    DEALLOCATE PROCESS
 ========================= */
 function deallocateProcess() {
+  if (refuseWhileBatchRunning()) return;
+
   const pid = document.getElementById("pid").value;
 
   if (!pid) {
@@ -84,17 +86,22 @@ function deallocateProcess() {
     return;
   }
 
-  let found = false;
+  let freedIndexes = [];
 
-  memory.forEach(block => {
-    if (!block.free && block.pid === pid) {
-      block.free = true;
-      block.pid = null;
-      found = true;
-    }
-  });
+  if (useWasmEngine()) {
+    freedIndexes = wasmDeallocate(pid);
+  } else {
+    memory.forEach((block, i) => {
+      if (!block.free && block.pid === pid) {
+        block.free = true;
+        block.pid = null;
+        freedIndexes.push(i);
+      }
+    });
+  }
 
-  if (!found) {
+  if (freedIndexes.length === 0) {
+    logTraceEvent("deallocate_failed", null, pid, 0, -1, calculateStats().externalFrag);
     alert("Process not found in memory");
     return;
   }
@@ -102,63 +109,101 @@ function deallocateProcess() {
   // record deallocation in queue
   processQueue.unshift({ pid, size: null, algo: 'deallocate', status: 'deallocated', time: Date.now() });
 
+  const freedSize = freedIndexes.reduce((sum, i) => sum + memory[i].size, 0);
+
+  // Range the merge can touch: the freed block plus its free neighbours
+  let start = -1;
+  let removed = 0;
+  if (freedIndexes.length === 1) {
+    const index = freedIndexes[0];
+    start = index > 0 && memory[index - 1].free ? index - 1 : index;
+    removed = index - start + 1;
+    if (index + 1 < memory.length && memory[index + 1].free) removed++;
+  }
+
   mergeFreeBlocks();
   render();
 
   const stats = calculateStats();
-  updateChart(fragChart.data.labels.length + 1, stats.externalFrag);
+  updateChart(nextChartStep(), stats.externalFrag);
+  logTraceEvent("deallocate", null, pid, freedSize, freedIndexes[0], stats.externalFrag);
+
+  if (start >= 0) {
+    recordStep("deallocate", start, removed);
+  } else {
+    recordStep("deallocate");
+  }
 }
 
 /* =========================
    COMPACT MEMORY
 ========================= */
 function compactMemory() {
-  const usedBlocks = memory.filter(b => !b.free);
-  const freeSize = memory
-    .filter(b => b.free)
-    .reduce((sum, b) => sum + b.size, 0);
-
-  memory = [...usedBlocks];
-
-  if (freeSize > 0) {
-    memory.push({
-      size: freeSize,
-      free: true,
-      pid: null
-    });
+  if (refuseWhileBatchRunning()) return;
+
+  if (useWasmEngine()) {
+    wasmCompact();
+  } else {
+    const usedBlocks = memory.filter(b => !b.free);
+    const freeSize = memory
+      .filter(b => b.free)
+      .reduce((sum, b) => sum + b.size, 0);
+
+    memory = [...usedBlocks];
+
+    if (freeSize > 0) {
+      memory.push({
+        size: freeSize,
+        free: true,
+        pid: null
+      });
+    }
   }
 
   render();
 
   const stats = calculateStats();
-  updateChart(fragChart.data.labels.length + 1, stats.externalFrag);
+  updateChart(nextChartStep(), stats.externalFrag);
+  logTraceEvent("compact", null, null, stats.free, memory.length, stats.externalFrag);
+
+  recordStep("compact");
 }
 
 /* =========================
    RESET MEMORY
 ========================= */
 function resetMemory() {
+  if (refuseWhileBatchRunning()) return;
+
   memory = [{ size: TOTAL_MEMORY, free: true, pid: null }];
   lastIndex = 0;
+  engineMemoryReplaced();
+
+  if (typeof clearSteps === "function") {
+    clearSteps();
+  }
 
-  if (typeof steps !== "undefined") {
-    steps.length = 0;
-    stepIndex = 0;
+  if (typeof clearChart === "function") {
+    clearChart();
   }
 
-  if (typeof fragChart !== "undefined") {
-    fragChart.data.labels = [];
-    fragChart.data.datasets[0].data = [];
-    fragChart.update();
+  if (typeof clearTrace === "function") {
+    clearTrace();
   }
 
   render();
+  recordStep("reset");
 }
 
 /* =========================
    MERGE FREE BLOCKS
 ========================= */
 function mergeFreeBlocks() {
+  if (useWasmEngine()) {
+    wasmCoalesce();
+    return;
+  }
+
   for (let i = 0; i < memory.length - 1; i++) {
     if (memory[i].free && memory[i + 1].free) {
       memory[i].size += memory[i + 1].size;
@@ -172,14 +217,20 @@ function mergeFreeBlocks() {
    LOAD SAMPLE MEMORY
 ========================= */
 function loadSampleMemory() {
+  if (refuseWhileBatchRunning()) return;
+
   memory = JSON.parse(JSON.stringify(SAMPLE_MEMORY));
   lastIndex = 0;
+  engineMemoryReplaced();
+
+  if (typeof clearChart === "function") {
+    clearChart();
+  }
 
-  if (typeof fragChart !== "undefined") {
-    fragChart.data.labels = [];
-    fragChart.data.datasets[0].data = [];
-    fragChart.update();
+  if (typeof clearTrace === "function") {
+    clearTrace();
   }
 
   render();
+  recordStep("load");
 }
@@ -1,22 +1,120 @@
+/* ================================
+   STEP LOG (delta encoded)
+
+   Each step stores only the blocks an operation touched, as a splice
+   patch against the previous step:
+     { op, start, removed, blocks }  → replace `removed` blocks at `start`
+                                        with copies of `blocks`
+   Every KEYFRAME_INTERVAL steps (and whenever the caller cannot say
+   which blocks changed) a full copy is stored instead:
+     { op, keyframe }
+   Seeking restores the nearest keyframe and replays at most
+   KEYFRAME_INTERVAL - 1 patches.
+================================ */
+const KEYFRAME_INTERVAL = 256;
+
 let steps = [];
 let stepIndex = 0;
 let playing = false;
 let playInterval = null;
 
-function recordStep() {
-  steps.push(JSON.parse(JSON.stringify(memory)));
+// memory.length as of the last recorded step (-1 → next step is a keyframe)
+let recordedLength = -1;
+
+function cloneBlocks(blocks, from = 0, to = blocks.length) {
+  const copy = new Array(to - from);
+  for (let i = from; i < to; i++) {
+    copy[i - from] = { ...blocks[i] };
+  }
+  return copy;
+}
+
+/*
+ Record the current memory state.
+ start / removed describe the range the operation replaced in the
+ previously recorded state; omit them for whole-memory changes.
+*/
+function recordStep(op = "update", start, removed) {
+  const needsKeyframe =
+    start === undefined ||
+    recordedLength < 0 ||
+    steps.length % KEYFRAME_INTERVAL === 0;
+
+  if (needsKeyframe) {
+    steps.push({ op, keyframe: cloneBlocks(memory) });
+  } else {
+    const inserted = memory.length - recordedLength + removed;
+    steps.push({
+      op,
+      start,
+      removed,
+      blocks: cloneBlocks(memory, start, start + inserted)
+    });
+  }
+
+  recordedLength = memory.length;
+  updateStepSlider(steps.length - 1);
+}
+
+// Call when memory is replaced outside of recordStep (e.g. by playback)
+function invalidateRecordedState() {
+  recordedLength = -1;
+}
+
+function clearSteps() {
+  steps.length = 0;
+  stepIndex = 0;
+  recordedLength = -1;
+  updateStepSlider();
+}
+
+// Apply one step to `state` in place; returns the (possibly new) array
+function applyStep(state, step) {
+  if (step.keyframe) {
+    return cloneBlocks(step.keyframe);
+  }
+  const blocks = cloneBlocks(step.blocks);
+  state.splice(step.start, step.removed, ...blocks);
+  return state;
+}
+
+// Rebuild the memory state after step `index`
+function stateAtStep(index) {
+  let k = index;
+  while (!steps[k].keyframe) k--;
+
+  let state = cloneBlocks(steps[k].keyframe);
+  for (let i = k + 1; i <= index; i++) {
+    state = applyStep(state, steps[i]);
+  }
+  return state;
+}
+
+function seekSimulation(index) {
+  if (steps.length === 0) return;
+  if (refuseWhileBatchRunning()) {
+    updateStepSlider();  // Put the slider back
+    return;
+  }
+  pauseSimulation();
+
+  stepIndex = Math.max(0, Math.min(steps.length - 1, parseInt(index)));
+  memory = stateAtStep(stepIndex);
+  invalidateRecordedState();
+  engineMemoryReplaced();
+  render();
+  updateStepSlider();
 }
 
 function playSimulation() {
-  if (playing || steps.length === 0) return;
+  if (playing || steps.length === 0 || refuseWhileBatchRunning()) return;
 
   playing = true;
   stepIndex = 0;
+  invalidateRecordedState();
 
   // Reset graph
-  fragChart.data.labels = [];
-  fragChart.data.datasets[0].data = [];
-  fragChart.update();
+  clearChart();
 
   playInterval = setInterval(() => {
     if (stepIndex === steps.length) {
@@ -24,12 +122,14 @@ function playSimulation() {
       return;
     }
 
-    memory = JSON.parse(JSON.stringify(steps[stepIndex]));
+    memory = applyStep(memory, steps[stepIndex]);
+    engineMemoryReplaced();
     render();
 
     const stats = calculateStats();
     updateChart(stepIndex + 1, stats.externalFrag);
 
+    updateStepSlider();
     stepIndex++;
   }, 700);
 }
@@ -38,3 +138,15 @@ function pauseSimulation() {
   playing = false;
   clearInterval(playInterval);
 }
+
+function updateStepSlider(position = stepIndex) {
+  const slider = document.getElementById("stepSlider");
+  const label = document.getElementById("stepLabel");
+  if (!slider || !label) return;
+
+  slider.max = Math.max(0, steps.length - 1);
+  slider.value = Math.min(position, slider.max);
+  label.textContent = steps.length
+    ? `Step ${Number(slider.value) + 1} / ${steps.length}`
+    : "No steps recorded";
+}
@@ -0,0 +1,187 @@
+/* ================================
+   SIMULATION CORE (no DOM, no timers)
+
+   Pure functions over a blocks array, shared by the interactive
+   algorithms (algorithms.js) and the batch worker (simworker.js).
+   Mutating functions return the range they replaced as a patch
+   { start, removed, inserted } in the same shape the step log uses.
+================================ */
+
+/*
+ Index of the free block the strategy would use, or -1.
+ startIndex is the Next Fit pointer (ignored by the other strategies).
+*/
+function findFitIndex(blocks, algo, size, startIndex = 0) {
+  const n = blocks.length;
+
+  if (algo === "nextFit") {
+    let index = startIndex < n ? startIndex : 0;
+    for (let count = 0; count < n; count++) {
+      if (blocks[index].free && blocks[index].size >= size) return index;
+      index = (index + 1) % n;
+    }
+    return -1;
+  }
+
+  let found = -1;
+  for (let i = 0; i < n; i++) {
+    const b = blocks[i];
+    if (!b.free || b.size < size) continue;
+    if (algo === "firstFit") return i;
+    if (found === -1 ||
+        (algo === "bestFit" && b.size < blocks[found].size) ||
+        (algo === "worstFit" && b.size > blocks[found].size)) {
+      found = i;
+    }
+  }
+  return found;
+}
+
+/*
+ Candidate index of every strategy in a single scan:
+ { firstFit, nextFit, bestFit, worstFit }, -1 where nothing fits.
+ Next Fit is the first fit at or after startIndex, wrapping to the
+ overall first fit.
+*/
+function findAllFits(blocks, size, startIndex = 0) {
+  const fits = { firstFit: -1, nextFit: -1, bestFit: -1, worstFit: -1 };
+
+  for (let i = 0; i < blocks.length; i++) {
+    const b = blocks[i];
+    if (!b.free || b.size < size) continue;
+
+    if (fits.firstFit === -1) fits.firstFit = i;
+    if (fits.nextFit === -1 && i >= startIndex) fits.nextFit = i;
+    if (fits.bestFit === -1 || b.size < blocks[fits.bestFit].size) fits.bestFit = i;
+    if (fits.worstFit === -1 || b.size > blocks[fits.worstFit].size) fits.worstFit = i;
+  }
+
+  if (fits.nextFit === -1) fits.nextFit = fits.firstFit;
+  return fits;
+}
+
+// Allocate `size` KB from the free block at index, splitting off the rest
+function splitBlock(blocks, index, pid, size, allocatedBy = null) {
+  const remaining = blocks[index].size - size;
+  const replacement = [{ size, free: false, pid, allocatedBy }];
+
+  if (remaining > 0) {
+    replacement.push({ size: remaining, free: true, pid: null, allocatedBy: null });
+  }
+
+  blocks.splice(index, 1, ...replacement);
+  return { start: index, removed: 1, inserted: replacement.length };
+}
+
+// Free the block at index and merge it with free neighbours
+function freeBlockAt(blocks, index) {
+  let start = index;
+  let end = index + 1;
+  if (start > 0 && blocks[start - 1].free) start--;
+  if (end < blocks.length && blocks[end].free) end++;
+
+  let size = 0;
+  for (let i = start; i < end; i++) size += blocks[i].size;
+
+  blocks.splice(start, end - start, { size, free: true, pid: null, allocatedBy: null });
+  return { start, removed: end - start, inserted: 1 };
+}
+
+// Allocated / free totals and external fragmentation in one pass
+function blockStats(blocks) {
+  let used = 0;
+  let free = 0;
+  let active = 0;
+  let largestFree = 0;
+
+  for (let i = 0; i < blocks.length; i++) {
+    const b = blocks[i];
+    if (b.free) {
+      free += b.size;
+      if (b.size > largestFree) largestFree = b.size;
+    } else {
+      used += b.size;
+      active++;
+    }
+  }
+
+  return { used, free, active, largestFree, externalFrag: free - largestFree };
+}
+
+/*
+ Apply a list of operations to blocks without any animation.
+   { op: "allocate", pid, size, algo }  |  { op: "deallocate", pid }
+   |  { op: "compact" }
+ Returns the patches (with copies of the inserted blocks), a success
+ flag and block index (-1 on failure) per operation, the external
+ fragmentation after each one and the final stats. Pass recordPatches = false when only the outcome
+ matters (what-if runs).
+*/
+function applyBatch(blocks, ops, nextFitIndex = 0, recordPatches = true) {
+  const patches = [];
+  const results = new Uint8Array(ops.length);
+  const blockIndexes = new Int32Array(ops.length).fill(-1);
+  const fragmentation = new Float64Array(ops.length);
+  const where = new Map(); // pid → index, rebuilt lazily after shifts
+
+  const record = (op, patch) => {
+    where.clear();
+    if (!recordPatches) return;
+    patches.push({
+      op,
+      start: patch.start,
+      removed: patch.removed,
+      blocks: blocks.slice(patch.start, patch.start + patch.inserted)
+    });
+  };
+
+  const indexOfPid = pid => {
+    if (where.size === 0) {
+      blocks.forEach((b, i) => { if (!b.free) where.set(b.pid, i); });
+    }
+    return where.has(pid) ? where.get(pid) : -1;
+  };
+
+  ops.forEach((o, k) => {
+    if (o.op === "allocate") {
+      const index = findFitIndex(blocks, o.algo, o.size, nextFitIndex);
+      if (index !== -1) {
+        record("allocate", splitBlock(blocks, index, o.pid, o.size, o.algo));
+        if (o.algo === "nextFit") nextFitIndex = (index + 1) % blocks.length;
+        results[k] = 1;
+        blockIndexes[k] = index;
+      }
+    } else if (o.op === "deallocate") {
+      // Every block of the process, as deallocateProcess() frees them;
+      // last block first, so the lowest index is reported
+      let index;
+      while ((index = indexOfPid(o.pid)) !== -1) {
+        record("deallocate", freeBlockAt(blocks, index));
+        results[k] = 1;
+        blockIndexes[k] = index;
+      }
+      if (nextFitIndex >= blocks.length) nextFitIndex = 0;
+    } else if (o.op === "compact") {
+      const removed = blocks.length;
+      let write = 0;
+      let freeSize = 0;
+      for (let i = 0; i < removed; i++) {
+        if (blocks[i].free) freeSize += blocks[i].size;
+        else blocks[write++] = blocks[i];
+      }
+      blocks.length = write;
+      if (freeSize > 0) blocks.push({ size: freeSize, free: true, pid: null, allocatedBy: null });
+      record("compact", { start: 0, removed, inserted: blocks.length });
+      nextFitIndex = 0;
+      results[k] = 1;
+      blockIndexes[k] = blocks.length;
+    }
+
+    fragmentation[k] = blockStats(blocks).externalFrag;
+  });
+
+  return {
+    patches, results, blockIndexes, fragmentation, nextFitIndex,
+    stats: blockStats(blocks)
+  };
+}
@@ -0,0 +1,161 @@
+/* ================================
+   BATCH SIMULATION WORKER
+
+   Runs applyBatch() (simcore.js) off the main thread, or the same
+   operations in the C engine (mm_engine.wasm) when the page itself
+   runs on it (request.engine), so batches, what-if runs and trace
+   imports follow the engine's rules too.
+   Request:  { id, blocks, nextFitIndex, ops, recordPatches, engine }
+   Reply:    { id, patches, results, blockIndexes, fragmentation,
+               nextFitIndex, stats }
+   The patches are the compact state diffs the main thread applies to
+   its `memory` view and step log.
+================================ */
+importScripts("simcore.js", "engine.js");
+
+// The worker's own engine instance; resolves to null when unavailable
+let batchEngineLoad = null;
+
+function loadBatchEngine() {
+  if (batchEngineLoad === null) {
+    batchEngineLoad = (async () => {
+      try {
+        // Relative to js/simworker.js
+        const response = await fetch("../" + WASM_ENGINE_URL);
+        if (!response.ok) return null;
+
+        const { instance } = await WebAssembly.instantiate(
+          await response.arrayBuffer(),
+          { env: {}, wasi_snapshot_preview1: { proc_exit() {} } }
+        );
+        return instance.exports;
+      } catch (e) {
+        return null;
+      }
+    })();
+  }
+  return batchEngineLoad;
+}
+
+/*
+ applyBatch() with the engine choosing, splitting and freeing blocks.
+ Deallocation frees every block of the process and then coalesces, as
+ wasmDeallocate() + mergeFreeBlocks() do on the page. Patches are the
+ range where the engine's blocks differ from the previous state.
+*/
+function applyEngineBatch(engine, blocks, ops, nextFitIndex, recordPatches) {
+  const readBlock = i => {
+    const free = engine.engineBlockIsFree(i) === 1;
+    return {
+      size: fromEngineBytes(engine.engineBlockSize(i)),
+      free,
+      pid: free ? null : ownerNames[engine.engineBlockOwner(i)],
+      allocatedBy: free ? null : ENGINE_TAGS[engine.engineBlockAllocatedBy(i)]
+    };
+  };
+
+  const sameBlock = (b, i) =>
+    b.size === fromEngineBytes(engine.engineBlockSize(i)) &&
+    b.free === (engine.engineBlockIsFree(i) === 1) &&
+    b.pid === ownerNames[engine.engineBlockOwner(i)] &&
+    b.allocatedBy === ENGINE_TAGS[engine.engineBlockAllocatedBy(i)];
+
+  engine.engineClear(toEngineBytes(blocks.reduce((sum, b) => sum + b.size, 0)));
+  const loaded = blocks.every(b => {
+    const tag = ENGINE_TAGS.indexOf(b.allocatedBy);
+    return engine.engineAppendBlock(
+      toEngineBytes(b.size),
+      b.free ? 1 : 0,
+      b.free ? 0 : internPid(b.pid),
+      tag > 0 ? tag : ENGINE_SAMPLE_TAG
+    ) === 1;
+  });
+  if (!loaded) return applyBatch(blocks, ops, nextFitIndex, recordPatches);
+  engine.engineSetNextFitPointer(nextFitIndex);
+
+  const patches = [];
+  const results = new Uint8Array(ops.length);
+  const blockIndexes = new Int32Array(ops.length).fill(-1);
+  const fragmentation = new Float64Array(ops.length);
+  const view = [];
+  if (recordPatches) {
+    for (let i = 0; i < engine.engineBlockCount(); i++) view.push(readBlock(i));
+  }
+
+  const record = op => {
+    const count = engine.engineBlockCount();
+    const before = view.length;
+    let start = 0;
+    while (start < view.length && start < count && sameBlock(view[start], start)) start++;
+    let tail = 0;
+    while (tail < view.length - start && tail < count - start &&
+           sameBlock(view[view.length - 1 - tail], count - 1 - tail)) tail++;
+
+    const inserted = [];
+    for (let i = start; i < count - tail; i++) inserted.push(readBlock(i));
+    const removed = view.length - tail - start;
+    view.splice(start, removed, ...inserted);
+    patches.push(op === "compact"
+      ? { op, start: 0, removed: before, blocks: view.slice() }
+      : { op, start, removed, blocks: inserted });
+  };
+
+  ops.forEach((o, k) => {
+    if (o.op === "allocate") {
+      const index = engine.engineAllocate(
+        ENGINE_TAGS.indexOf(o.algo), internPid(o.pid), toEngineBytes(o.size));
+      results[k] = index !== -1 ? 1 : 0;
+      blockIndexes[k] = index;
+    } else if (o.op === "deallocate") {
+      if (ownerIds.has(o.pid)) {
+        const owner = ownerIds.get(o.pid);
+        let index;
+        while ((index = engine.engineDeallocate(owner)) !== -1) {
+          if (results[k] === 0) blockIndexes[k] = index;
+          results[k] = 1;
+        }
+        if (results[k] === 1) engine.engineCoalesce();
+      }
+    } else if (o.op === "compact") {
+      engine.engineCompact();
+      results[k] = 1;
+      blockIndexes[k] = engine.engineBlockCount();
+    }
+
+    // Failed operations leave the engine untouched
+    if (recordPatches && results[k] === 1) record(o.op);
+
+    engine.engineUpdateStats();
+    fragmentation[k] = fromEngineBytes(engine.engineFreeMemory()) -
+                       fromEngineBytes(engine.engineLargestFreeBlock());
+  });
+
+  engine.engineUpdateStats();
+  const free = fromEngineBytes(engine.engineFreeMemory());
+  const largestFree = fromEngineBytes(engine.engineLargestFreeBlock());
+
+  return {
+    patches, results, blockIndexes, fragmentation,
+    nextFitIndex: engine.engineNextFitPointer(),
+    stats: {
+      used: fromEngineBytes(engine.engineUsedMemory()),
+      free,
+      active: engine.engineActiveProcesses(),
+      largestFree,
+      externalFrag: free - largestFree
+    }
+  };
+}
+
+self.onmessage = async event => {
+  const { id, blocks, nextFitIndex, ops, recordPatches } = event.data;
+  const engine = event.data.engine ? await loadBatchEngine() : null;
+  const result = engine
+    ? applyEngineBatch(engine, blocks, ops, nextFitIndex, recordPatches)
+    : applyBatch(blocks, ops, nextFitIndex, recordPatches);
+
+  self.postMessage(
+    { id, ...result },
+    [result.results.buffer, result.blockIndexes.buffer, result.fragmentation.buffer]
+  );
+};
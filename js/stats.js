@@ -1,4 +1,6 @@
 function calculateStats() {
+  if (useWasmEngine()) return wasmStats();
+
   let used = 0;
   let free = 0;
   let active = 0;
@@ -0,0 +1,242 @@
+/* ================================
+   OPERATION TRACE: LOG, EXPORT, IMPORT
+
+   Every allocate / free / compact is appended to traceLog together
+   with the external fragmentation after it. The columns match the
+   native simulators' --events=FILE CSV (c code/event_log.h), plus a
+   trailing external_frag_kb column:
+
+     sequence,event,strategy,process_id,size_kb,block_index,external_frag_kb
+
+   Export streams the log in chunks (CSV or NDJSON) straight to disk
+   where the File System Access API exists, else into a Blob built
+   from the same chunks. Import reads a trace line by line and replays
+   its requests through the batch worker a chunk at a time, yielding
+   to the page between chunks.
+================================ */
+const TRACE_CSV_HEADER =
+  "sequence,event,strategy,process_id,size_kb,block_index,external_frag_kb";
+const TRACE_EXPORT_CHUNK = 4096;   // records per written chunk
+const TRACE_REPLAY_CHUNK = 2000;   // operations per replay batch
+
+// allocatedBy key ↔ event_log.h strategy name
+const TRACE_STRATEGIES = {
+  firstFit: "first_fit",
+  nextFit: "next_fit",
+  bestFit: "best_fit",
+  worstFit: "worst_fit"
+};
+const TRACE_ALGORITHMS = Object.fromEntries(
+  Object.entries(TRACE_STRATEGIES).map(([algo, name]) => [name, algo])
+);
+
+const traceLog = [];
+let traceReplaying = false;
+
+/*
+ event: allocate | allocate_failed | deallocate | deallocate_failed | compact
+ algo:  firstFit/nextFit/bestFit/worstFit, or null
+*/
+function logTraceEvent(event, algo, pid, size, blockIndex, externalFrag) {
+  traceLog.push({
+    event,
+    strategy: TRACE_STRATEGIES[algo] || "-",
+    pid: pid || "",
+    size: size || 0,
+    block: blockIndex,
+    frag: externalFrag
+  });
+}
+
+function clearTrace() {
+  traceLog.length = 0;
+}
+
+/* ================================
+   EXPORT
+================================ */
+function traceRecordToCSV(r, sequence) {
+  const pid = /[",\n]/.test(r.pid) ? `"${r.pid.replace(/"/g, '""')}"` : r.pid;
+  return `${sequence},${r.event},${r.strategy},${pid},${r.size},${r.block},${r.frag}`;
+}
+
+function traceRecordToJSON(r, sequence) {
+  return JSON.stringify({
+    sequence,
+    event: r.event,
+    strategy: r.strategy,
+    process_id: r.pid,
+    size_kb: r.size,
+    block_index: r.block,
+    external_frag_kb: r.frag
+  });
+}
+
+// Yields the export text in chunks of TRACE_EXPORT_CHUNK lines
+function* traceChunks(format) {
+  const toLine = format === "ndjson" ? traceRecordToJSON : traceRecordToCSV;
+  if (format !== "ndjson") yield TRACE_CSV_HEADER + "\n";
+
+  for (let from = 0; from < traceLog.length; from += TRACE_EXPORT_CHUNK) {
+    const to = Math.min(from + TRACE_EXPORT_CHUNK, traceLog.length);
+    const lines = new Array(to - from);
+    for (let k = from; k < to; k++) lines[k - from] = toLine(traceLog[k], k);
+    yield lines.join("\n") + "\n";
+  }
+}
+
+async function exportTrace(format) {
+  if (traceLog.length === 0) {
+    alert("No operations recorded yet");
+    return;
+  }
+
+  const name = `memory_trace.${format === "ndjson" ? "ndjson" : "csv"}`;
+
+  if (typeof window.showSaveFilePicker === "function") {
+    let writable;
+    try {
+      const handle = await window.showSaveFilePicker({ suggestedName: name });
+      writable = await handle.createWritable();
+    } catch (e) {
+      return; // picker cancelled
+    }
+    for (const chunk of traceChunks(format)) {
+      await writable.write(chunk);
+    }
+    await writable.close();
+    return;
+  }
+
+  const blob = new Blob([...traceChunks(format)], {
+    type: format === "ndjson" ? "application/x-ndjson" : "text/csv"
+  });
+  const link = document.createElement("a");
+  link.href = URL.createObjectURL(blob);
+  link.download = name;
+  link.click();
+  setTimeout(() => URL.revokeObjectURL(link.href), 0);
+}
+
+/* ================================
+   IMPORT
+================================ */
+
+// Split one CSV line, honouring quoted fields
+function splitCSVLine(line) {
+  const fields = [];
+  let field = "";
+  let quoted = false;
+
+  for (let i = 0; i < line.length; i++) {
+    const c = line[i];
+    if (quoted) {
+      if (c === '"' && line[i + 1] === '"') { field += '"'; i++; }
+      else if (c === '"') quoted = false;
+      else field += c;
+    } else if (c === '"') {
+      quoted = true;
+    } else if (c === ",") {
+      fields.push(field);
+      field = "";
+    } else {
+      field += c;
+    }
+  }
+  fields.push(field);
+  return fields;
+}
+
+/*
+ One trace line → a batch operation (simcore.js applyBatch), or null
+ for lines that carry no request (header, coalesce, blank).
+ Failed requests are replayed as requests: they may succeed here.
+*/
+function traceLineToOp(line, defaultAlgo) {
+  line = line.trim();
+  if (!line) return null;
+
+  let event, strategy, pid, size;
+  if (line[0] === "{") {
+    const r = JSON.parse(line);
+    ({ event, strategy, process_id: pid, size_kb: size } = r);
+  } else {
+    const f = splitCSVLine(line);
+    if (f[0] === "sequence") return null;
+    [, event, strategy, pid, size] = f;
+  }
+
+  switch (event) {
+    case "allocate":
+    case "allocate_failed":
+      return {
+        op: "allocate",
+        pid,
+        size: Number(size),
+        algo: TRACE_ALGORITHMS[strategy] || defaultAlgo
+      };
+    case "deallocate":
+    case "deallocate_failed":
+      return { op: "deallocate", pid };
+    case "compact":
+      return { op: "compact" };
+    default:
+      return null;
+  }
+}
+
+// Async iterator over the lines of a File, without reading it whole
+async function* fileLines(file) {
+  const reader = file.stream().pipeThrough(new TextDecoderStream()).getReader();
+  let rest = "";
+
+  for (;;) {
+    const { value, done } = await reader.read();
+    if (done) break;
+
+    const lines = (rest + value).split("\n");
+    rest = lines.pop();
+    yield* lines;
+  }
+  if (rest) yield rest;
+}
+
+function nextFrame() {
+  return new Promise(resolve => setTimeout(resolve, 0));
+}
+
+async function importTrace(file) {
+  if (!file || refuseBatchStart()) return;
+  pauseSimulation();
+
+  const status = document.getElementById("traceStatus");
+  const defaultAlgo = ALGORITHM_KEYS[document.getElementById("algorithm").value];
+  let ops = [];
+  let replayed = 0;
+  let line = 0;
+
+  const flush = async () => {
+    const result = await runBatch(ops);
+    applyBatchResult(result, ops);
+    replayed += ops.length;
+    ops = [];
+    status.textContent = `Replayed ${replayed} operations…`;
+    await nextFrame();
+  };
+
+  traceReplaying = true;
+  try {
+    for await (const text of fileLines(file)) {
+      line++;
+      const op = traceLineToOp(text, defaultAlgo);
+      if (op) ops.push(op);
+      if (ops.length === TRACE_REPLAY_CHUNK) await flush();
+    }
+    if (ops.length > 0) await flush();
+    status.textContent = `Replayed ${replayed} operations from ${file.name}`;
+  } catch (e) {
+    status.textContent = `Import stopped at line ${line}: ${e.message}`;
+  } finally {
+    traceReplaying = false;
+  }
+}
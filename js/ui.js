@@ -6,29 +6,8 @@ function render() {
 
 
 function renderMemory() {
-  const mem = document.getElementById("memory");
-  mem.innerHTML = "";
-
-  memory.forEach(b => {
-    const div = document.createElement("div");
-    
-    // Add class based on allocation type
-    if (b.free) {
-      div.className = "block free";
-    } else {
-      div.className = `block used allocated-${b.allocatedBy || 'sample'}`;
-    }
-
-    // HORIZONTAL GANTT CHART - Calculate width based on memory proportion
-    const widthPercent = (b.size / TOTAL_MEMORY) * 100;
-    div.style.width = `${widthPercent}%`;
-
-    div.innerHTML = b.free
-      ? `FREE<br>${b.size} KB`
-      : `${b.pid}<br>${b.size} KB`;
-
-    mem.appendChild(div);
-  });
+  // HORIZONTAL GANTT CHART - drawn on a canvas (see memorymap.js)
+  drawMemoryMap();
 }
 
 function renderStats() {
@@ -72,12 +51,7 @@ function renderStats() {
 
 
 function highlightBlock(index) {
-  const blocks = document.querySelectorAll(".block");
-  blocks.forEach(b => (b.style.outline = "none"));
-
-  if (blocks[index]) {
-    blocks[index].style.outline = "3px solid yellow";
-  }
+  highlightMapBlock(index);
 }
 
 // Algorithm Descriptions
@@ -113,6 +87,9 @@ function updateAlgorithmDescription() {
 // Initialize chart on page load
 document.addEventListener("DOMContentLoaded", () => {
   initChart();
+  initMemoryMap();
   render();
   updateAlgorithmDescription();
+  recordStep("init");
+  loadWasmEngine();
 });